@@ -22,6 +22,7 @@
 #include "brave/common/pref_names.h"
 #include "brave/components/brave_component_updater/browser/brave_on_demand_updater.h"
 #include "brave/components/brave_component_updater/browser/local_data_files_service.h"
+#include "brave/components/brave_shields/browser/ad_block_cosmetic_resources_service.h"
 #include "brave/components/brave_shields/browser/ad_block_custom_filters_service.h"
 #include "brave/components/brave_shields/browser/ad_block_regional_service_manager.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
@@ -225,6 +226,17 @@ BraveBrowserProcessImpl::ad_block_regional_service_manager() {
   return ad_block_regional_service_manager_.get();
 }
 
+brave_shields::AdBlockCosmeticResourcesService*
+BraveBrowserProcessImpl::ad_block_cosmetic_resources_service() {
+  if (!ad_block_cosmetic_resources_service_)
+    ad_block_cosmetic_resources_service_ =
+        std::make_unique<brave_shields::AdBlockCosmeticResourcesService>(
+            brave_component_updater_delegate()->GetTaskRunner(),
+            ad_block_service(), ad_block_regional_service_manager(),
+            ad_block_custom_filters_service());
+  return ad_block_cosmetic_resources_service_.get();
+}
+
 NTPBackgroundImagesService*
 BraveBrowserProcessImpl::ntp_background_images_service() {
   if (!base::FeatureList::IsEnabled(kBraveNTPBrandedWallpaper))
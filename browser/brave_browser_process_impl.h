@@ -36,6 +36,7 @@ class LocalDataFilesService;
 }  // namespace brave_component_updater
 
 namespace brave_shields {
+class AdBlockCosmeticResourcesService;
 class AdBlockService;
 class AdBlockCustomFiltersService;
 class AdBlockRegionalServiceManager;
@@ -77,6 +78,8 @@ class BraveBrowserProcessImpl : public BrowserProcessImpl {
   brave_shields::AdBlockCustomFiltersService* ad_block_custom_filters_service();
   brave_shields::AdBlockRegionalServiceManager*
   ad_block_regional_service_manager();
+  brave_shields::AdBlockCosmeticResourcesService*
+  ad_block_cosmetic_resources_service();
 #if BUILDFLAG(ENABLE_EXTENSIONS)
   brave_component_updater::ExtensionWhitelistService*
   extension_whitelist_service();
@@ -130,6 +133,8 @@ class BraveBrowserProcessImpl : public BrowserProcessImpl {
       ad_block_custom_filters_service_;
   std::unique_ptr<brave_shields::AdBlockRegionalServiceManager>
       ad_block_regional_service_manager_;
+  std::unique_ptr<brave_shields::AdBlockCosmeticResourcesService>
+      ad_block_cosmetic_resources_service_;
 #if BUILDFLAG(ENABLE_EXTENSIONS)
   std::unique_ptr<brave_component_updater::ExtensionWhitelistService>
       extension_whitelist_service_;
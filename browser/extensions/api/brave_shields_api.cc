@@ -9,6 +9,7 @@
 #include <string>
 #include <utility>
 
+#include "base/bind.h"
 #include "base/strings/string_number_conversions.h"
 #include "brave/browser/brave_browser_process_impl.h"
 #include "brave/browser/extensions/api/brave_action_api.h"
@@ -16,10 +17,10 @@
 #include "brave/common/extensions/api/brave_shields.h"
 #include "brave/common/extensions/extension_constants.h"
 #include "brave/components/brave_shields/browser/ad_block_base_service.h"
+#include "brave/components/brave_shields/browser/ad_block_cosmetic_resources_service.h"
 #include "brave/components/brave_shields/browser/ad_block_custom_filters_service.h"
 #include "brave/components/brave_shields/browser/ad_block_regional_service_manager.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
-#include "brave/components/brave_shields/browser/ad_block_service_helper.h"
 #include "brave/components/brave_shields/browser/brave_shields_p3a.h"
 #include "brave/components/brave_shields/browser/brave_shields_util.h"
 #include "brave/components/brave_shields/browser/brave_shields_web_contents_observer.h"
@@ -56,41 +57,24 @@ BraveShieldsHostnameCosmeticResourcesFunction::Run() {
       brave_shields::HostnameCosmeticResources::Params::Create(*args_));
   EXTENSION_FUNCTION_VALIDATE(params.get());
 
-  base::Optional<base::Value> resources = g_brave_browser_process->
-      ad_block_service()->HostnameCosmeticResources(params->hostname);
+  g_brave_browser_process->ad_block_cosmetic_resources_service()
+      ->GetHostnameCosmeticResources(
+          params->hostname,
+          base::BindOnce(&BraveShieldsHostnameCosmeticResourcesFunction::
+                             OnGetHostnameCosmeticResources,
+                         this));
+  return RespondLater();
+}
 
-  if (!resources || !resources->is_dict()) {
-    return RespondNow(Error(
+void BraveShieldsHostnameCosmeticResourcesFunction::
+    OnGetHostnameCosmeticResources(
+        scoped_refptr<base::RefCountedString> resources) {
+  if (!resources) {
+    Respond(Error(
         "Hostname-specific cosmetic resources could not be returned"));
+    return;
   }
-
-  base::Optional<base::Value> regional_resources = g_brave_browser_process->
-      ad_block_regional_service_manager()->
-          HostnameCosmeticResources(params->hostname);
-
-  if (regional_resources && regional_resources->is_dict()) {
-    ::brave_shields::MergeResourcesInto(
-            &*resources,
-            &*regional_resources,
-            false);
-  }
-
-  base::Optional<base::Value> custom_resources = g_brave_browser_process->
-      ad_block_custom_filters_service()->
-          HostnameCosmeticResources(params->hostname);
-
-  if (custom_resources && custom_resources->is_dict()) {
-    ::brave_shields::MergeResourcesInto(
-            &*resources,
-            &*custom_resources,
-            true);
-  }
-
-  auto result_list = std::make_unique<base::ListValue>();
-
-  result_list->Append(std::move(*resources));
-
-  return RespondNow(ArgumentList(std::move(result_list)));
+  Respond(OneArgument(std::make_unique<base::Value>(resources->data())));
 }
 
 ExtensionFunction::ResponseAction
@@ -99,41 +83,21 @@ BraveShieldsHiddenClassIdSelectorsFunction::Run() {
       brave_shields::HiddenClassIdSelectors::Params::Create(*args_));
   EXTENSION_FUNCTION_VALIDATE(params.get());
 
-  base::Optional<base::Value> hide_selectors = g_brave_browser_process->
-      ad_block_service()->HiddenClassIdSelectors(params->classes,
-                                                 params->ids,
-                                                 params->exceptions);
-
-  base::Optional<base::Value> regional_selectors = g_brave_browser_process->
-      ad_block_regional_service_manager()->
-        HiddenClassIdSelectors(params->classes,
-                               params->ids,
-                               params->exceptions);
-
-  if (hide_selectors && hide_selectors->is_list()) {
-    if (regional_selectors && regional_selectors->is_list()) {
-      for (auto i = regional_selectors->GetList().begin();
-              i < regional_selectors->GetList().end();
-              i++) {
-        hide_selectors->Append(std::move(*i));
-      }
-    }
-  } else {
-    hide_selectors = std::move(regional_selectors);
-  }
-
-  base::Optional<base::Value> custom_selectors = g_brave_browser_process->
-      ad_block_custom_filters_service()->
-          HiddenClassIdSelectors(params->classes,
-                                 params->ids,
-                                 params->exceptions);
-
-  auto result_list = std::make_unique<base::ListValue>();
-
-  result_list->Append(std::move(*hide_selectors));
-  result_list->Append(std::move(*custom_selectors));
+  g_brave_browser_process->ad_block_cosmetic_resources_service()
+      ->GetHiddenClassIdSelectors(
+          params->session_id, params->classes, params->ids,
+          params->exceptions,
+          base::BindOnce(&BraveShieldsHiddenClassIdSelectorsFunction::
+                             OnGetHiddenClassIdSelectors,
+                         this));
+  return RespondLater();
+}
 
-  return RespondNow(ArgumentList(std::move(result_list)));
+void BraveShieldsHiddenClassIdSelectorsFunction::OnGetHiddenClassIdSelectors(
+    ::brave_shields::AdBlockCosmeticResourcesService::HiddenSelectors
+        selectors) {
+  Respond(ArgumentList(brave_shields::HiddenClassIdSelectors::Results::Create(
+      selectors.hide_selectors, selectors.force_hide_selectors)));
 }
 
 
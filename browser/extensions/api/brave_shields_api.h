@@ -6,6 +6,8 @@
 #ifndef BRAVE_BROWSER_EXTENSIONS_API_BRAVE_SHIELDS_API_H_
 #define BRAVE_BROWSER_EXTENSIONS_API_BRAVE_SHIELDS_API_H_
 
+#include "base/memory/ref_counted_memory.h"
+#include "brave/components/brave_shields/browser/ad_block_cosmetic_resources_service.h"
 #include "extensions/browser/extension_function.h"
 
 namespace extensions {
@@ -19,6 +21,10 @@ class BraveShieldsHostnameCosmeticResourcesFunction : public ExtensionFunction {
   ~BraveShieldsHostnameCosmeticResourcesFunction() override {}
 
   ResponseAction Run() override;
+
+ private:
+  void OnGetHostnameCosmeticResources(
+      scoped_refptr<base::RefCountedString> resources);
 };
 
 class BraveShieldsHiddenClassIdSelectorsFunction : public ExtensionFunction {
@@ -29,6 +35,11 @@ class BraveShieldsHiddenClassIdSelectorsFunction : public ExtensionFunction {
   ~BraveShieldsHiddenClassIdSelectorsFunction() override {}
 
   ResponseAction Run() override;
+
+ private:
+  void OnGetHiddenClassIdSelectors(
+      ::brave_shields::AdBlockCosmeticResourcesService::HiddenSelectors
+          selectors);
 };
 
 class BraveShieldsAllowScriptsOnceFunction : public ExtensionFunction {
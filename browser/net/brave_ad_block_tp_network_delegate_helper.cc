@@ -9,47 +9,72 @@
 #include <string>
 
 #include "base/base64url.h"
+#include "base/metrics/histogram_macros.h"
 #include "base/strings/string_util.h"
+#include "base/time/time.h"
 #include "brave/browser/brave_browser_process_impl.h"
 #include "brave/browser/net/url_context.h"
 #include "brave/common/network_constants.h"
 #include "brave/common/shield_exceptions.h"
 #include "brave/components/brave_shields/browser/ad_block_custom_filters_service.h"
+#include "brave/components/brave_shields/browser/ad_block_matcher.h"
 #include "brave/components/brave_shields/browser/ad_block_regional_service_manager.h"
+#include "brave/components/brave_shields/browser/ad_block_request.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
+#include "brave/components/brave_shields/browser/brave_shields_settings_cache.h"
 #include "brave/components/brave_shields/browser/brave_shields_util.h"
 #include "brave/components/brave_shields/browser/brave_shields_web_contents_observer.h"
 #include "brave/components/brave_shields/common/brave_shield_constants.h"
 #include "brave/grit/brave_generated_resources.h"
+#include "chrome/browser/profiles/profile.h"
 #include "content/public/browser/browser_thread.h"
 #include "extensions/common/url_pattern.h"
+#include "services/network/public/cpp/resource_request.h"
 #include "ui/base/resource/resource_bundle.h"
 
 using content::ResourceType;
 
 namespace brave {
 
-void ShouldBlockAdOnTaskRunner(std::shared_ptr<BraveRequestInfo> ctx) {
-  bool did_match_exception = false;
-  std::string tab_host = ctx->tab_origin.host();
-  if (!g_brave_browser_process->ad_block_service()->ShouldStartRequest(
-          ctx->request_url, ctx->resource_type, tab_host,
-          &did_match_exception, &ctx->cancel_request_explicitly,
-          &ctx->mock_data_url)) {
-    ctx->blocked_by = kAdBlocked;
-  } else if (!did_match_exception &&
-             !g_brave_browser_process->ad_block_regional_service_manager()
-                  ->ShouldStartRequest(ctx->request_url, ctx->resource_type,
-                                       tab_host, &did_match_exception,
-                                       &ctx->cancel_request_explicitly,
-                                       &ctx->mock_data_url)) {
-    ctx->blocked_by = kAdBlocked;
-  } else if (!did_match_exception &&
-             !g_brave_browser_process->ad_block_custom_filters_service()
-                  ->ShouldStartRequest(ctx->request_url, ctx->resource_type,
-                                       tab_host, &did_match_exception,
-                                       &ctx->cancel_request_explicitly,
-                                       &ctx->mock_data_url)) {
+namespace {
+
+// HTTPS Everywhere may redirect a request before its stub response is sent,
+// so whether it is on is part of the key.
+std::string GetPrescreenKey(const GURL& request_url,
+                            content::ResourceType resource_type,
+                            const GURL& tab_origin,
+                            bool https_everywhere_enabled) {
+  std::string key = brave_shields::GetAdBlockDecisionKey(
+      request_url, resource_type, tab_origin.host());
+  key.push_back(https_everywhere_enabled ? '1' : '0');
+  return key;
+}
+
+}  // namespace
+
+// |update_pending_since| is when the request was queued if an engine was
+// waiting to be published then, and null otherwise.
+void ShouldBlockAdOnTaskRunner(std::shared_ptr<BraveRequestInfo> ctx,
+                               base::TimeTicks update_pending_since) {
+  if (!update_pending_since.is_null()) {
+    // How long matching waited behind an ad-block list update. Local
+    // diagnostics only.
+    UMA_HISTOGRAM_TIMES("Brave.AdBlock.EngineUpdateStallTime",
+                        base::TimeTicks::Now() - update_pending_since);
+  }
+  // Engines only change on this task runner, so this is the generation the
+  // decision below is made with.
+  ctx->ad_block_engine_generation =
+      brave_shields::AdBlockBaseService::CurrentEngineGeneration();
+  const brave_shields::AdBlockRequest request(
+      ctx->request_url, ctx->resource_type, ctx->tab_origin.host());
+  const brave_shields::AdBlockMatcher matcher(
+      g_brave_browser_process->ad_block_service(),
+      g_brave_browser_process->ad_block_regional_service_manager(),
+      g_brave_browser_process->ad_block_custom_filters_service());
+  if (!matcher.ShouldStartRequest(request, nullptr,
+                                  &ctx->cancel_request_explicitly,
+                                  &ctx->mock_data_url)) {
     ctx->blocked_by = kAdBlocked;
   }
 }
@@ -78,9 +103,14 @@ void OnBeforeURLRequestAdBlockTP(
   }
   DCHECK_NE(ctx->request_identifier, 0UL);
 
+  const base::TimeTicks update_pending_since =
+      brave_shields::AdBlockBaseService::IsEngineUpdatePending()
+          ? base::TimeTicks::Now()
+          : base::TimeTicks();
   g_brave_browser_process->ad_block_service()->GetTaskRunner()
       ->PostTaskAndReply(FROM_HERE,
-                         base::BindOnce(&ShouldBlockAdOnTaskRunner, ctx),
+                         base::BindOnce(&ShouldBlockAdOnTaskRunner, ctx,
+                                        update_pending_since),
                          base::BindOnce(&OnShouldBlockAdResult, next_callback,
                                         ctx));
 }
@@ -115,4 +145,59 @@ int OnBeforeURLRequest_AdBlockTPPreWork(
   return net::ERR_IO_PENDING;
 }
 
+bool PrescreenAdBlockedRequest(const network::ResourceRequest& request,
+                               content::BrowserContext* browser_context,
+                               int render_process_id,
+                               int frame_tree_node_id,
+                               std::string* mock_data_url) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  // Mirrors what BraveRequestInfo::FillCTX() and
+  // OnBeforeURLRequest_AdBlockTPPreWork() look at.
+  if (!request.url.SchemeIsHTTPOrHTTPS()) {
+    return false;
+  }
+  GURL tab_origin;
+  if (request.trusted_params) {
+    tab_origin =
+        request.trusted_params->network_isolation_key.GetTopFrameOrigin()
+            .value_or(url::Origin())
+            .GetURL();
+  }
+  // Subresource requests from renderers have no trusted params.
+  if (tab_origin.is_empty()) {
+    tab_origin = brave_shields::BraveShieldsWebContentsObserver::
+                     GetTabURLFromRenderFrameInfo(render_process_id,
+                                                  request.render_frame_id,
+                                                  frame_tree_node_id)
+                         .GetOrigin();
+  }
+  if (tab_origin.is_empty() || !tab_origin.has_host()) {
+    return false;
+  }
+  const brave_shields::ShieldsSettings& settings =
+      brave_shields::ShieldsSettingsCache::GetForProfile(
+          Profile::FromBrowserContext(browser_context))
+          ->Get(tab_origin);
+  if (!settings.shields_enabled || settings.allow_ads) {
+    return false;
+  }
+  return g_brave_browser_process->ad_block_service()->PrescreenRequest(
+      GetPrescreenKey(request.url,
+                      static_cast<content::ResourceType>(request.resource_type),
+                      tab_origin, settings.https_everywhere_enabled),
+      mock_data_url);
+}
+
+void RecordAdBlockedRequest(const BraveRequestInfo& ctx) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  if (ctx.blocked_by != kAdBlocked || ctx.cancel_request_explicitly ||
+      !ctx.ad_block_engine_generation) {
+    return;
+  }
+  g_brave_browser_process->ad_block_service()->RecordBlockedRequest(
+      GetPrescreenKey(ctx.request_url, ctx.resource_type, ctx.tab_origin,
+                      !ctx.allow_http_upgradable_resource),
+      ctx.ad_block_engine_generation, ctx.mock_data_url);
+}
+
 }  // namespace brave
@@ -7,15 +7,37 @@
 #define BRAVE_BROWSER_NET_BRAVE_AD_BLOCK_TP_NETWORK_DELEGATE_HELPER_H_
 
 #include <memory>
+#include <string>
 
 #include "brave/browser/net/url_context.h"
 
+namespace content {
+class BrowserContext;
+}
+
+namespace network {
+struct ResourceRequest;
+}
+
 namespace brave {
 
 int OnBeforeURLRequest_AdBlockTPPreWork(
     const ResponseCallback& next_callback,
     std::shared_ptr<BraveRequestInfo> ctx);
 
+// Returns true if |request| is known to end up blocked by ad-block with a stub
+// response, which |mock_data_url| receives. Answers from earlier identical
+// requests only, so that no request handler stage has to run for it.
+bool PrescreenAdBlockedRequest(const network::ResourceRequest& request,
+                               content::BrowserContext* browser_context,
+                               int render_process_id,
+                               int frame_tree_node_id,
+                               std::string* mock_data_url);
+
+// Remembers that |ctx| was answered with an ad-block stub response, see
+// PrescreenAdBlockedRequest().
+void RecordAdBlockedRequest(const BraveRequestInfo& ctx);
+
 }  // namespace brave
 
 #endif  // BRAVE_BROWSER_NET_BRAVE_AD_BLOCK_TP_NETWORK_DELEGATE_HELPER_H_
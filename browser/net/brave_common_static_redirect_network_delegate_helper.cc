@@ -11,9 +11,11 @@
 
 #include "base/command_line.h"
 #include "base/feature_list.h"
+#include "base/no_destructor.h"
 #include "brave/common/brave_features.h"
 #include "brave/common/brave_switches.h"
 #include "brave/common/network_constants.h"
+#include "brave/common/static_url_pattern_matcher.h"
 #include "components/component_updater/component_updater_url_constants.h"
 #include "extensions/buildflags/buildflags.h"
 #include "extensions/common/url_pattern.h"
@@ -24,27 +26,69 @@
 
 namespace brave {
 
-// Update server checks happen from the profile context for admin policy
-// installed extensions. Update server checks happen from the system context for
-// normal update operations.
-bool IsUpdaterURL(const GURL& gurl) {
-  static std::vector<URLPattern> updater_patterns(
-      {URLPattern(URLPattern::SCHEME_HTTPS,
-                  std::string(component_updater::kUpdaterJSONDefaultUrl) + "*"),
-       URLPattern(
-           URLPattern::SCHEME_HTTP,
-           std::string(component_updater::kUpdaterJSONFallbackUrl) + "*"),
+namespace {
+
+enum class CommonStaticRedirect {
+  kNone,
+  kUpdater,
+  kChromeCast,
+  kClients4,
+};
+
+struct CommonStaticRedirectRules {
+  std::vector<StaticURLPatternMatcher::Entry> entries;
+  std::vector<CommonStaticRedirect> redirects;
+
+  void Add(int valid_schemes,
+           const std::string& pattern,
+           StaticURLPatternMatcher::MatchType match_type,
+           CommonStaticRedirect redirect) {
+    entries.push_back({valid_schemes, pattern, match_type});
+    redirects.push_back(redirect);
+  }
+};
+
+CommonStaticRedirectRules CreateCommonStaticRedirectRules() {
+  using MatchType = StaticURLPatternMatcher::MatchType;
+  constexpr int kHttpOrHttps =
+      URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS;
+
+  // Evaluated in order, the first matching rule wins.
+  CommonStaticRedirectRules rules;
+  // Update server checks happen from the profile context for admin policy
+  // installed extensions. Update server checks happen from the system
+  // context for normal update operations.
+  rules.Add(URLPattern::SCHEME_HTTPS,
+            std::string(component_updater::kUpdaterJSONDefaultUrl) + "*",
+            MatchType::kURL, CommonStaticRedirect::kUpdater);
+  rules.Add(URLPattern::SCHEME_HTTP,
+            std::string(component_updater::kUpdaterJSONFallbackUrl) + "*",
+            MatchType::kURL, CommonStaticRedirect::kUpdater);
 #if BUILDFLAG(ENABLE_EXTENSIONS)
-       URLPattern(
-           URLPattern::SCHEME_HTTPS,
-           std::string(extension_urls::kChromeWebstoreUpdateURL) + "*")
+  rules.Add(URLPattern::SCHEME_HTTPS,
+            std::string(extension_urls::kChromeWebstoreUpdateURL) + "*",
+            MatchType::kURL, CommonStaticRedirect::kUpdater);
 #endif
-  });
-  return std::any_of(
-      updater_patterns.begin(), updater_patterns.end(),
-      [&gurl](URLPattern pattern) { return pattern.MatchesURL(gurl); });
+  rules.Add(kHttpOrHttps, kChromeCastPrefix, MatchType::kURL,
+            CommonStaticRedirect::kChromeCast);
+  rules.Add(kHttpOrHttps, kClients4Prefix, MatchType::kHost,
+            CommonStaticRedirect::kClients4);
+  return rules;
 }
 
+CommonStaticRedirect MatchCommonStaticRedirect(const GURL& url) {
+  static const base::NoDestructor<CommonStaticRedirectRules> rules(
+      CreateCommonStaticRedirectRules());
+  static const base::NoDestructor<StaticURLPatternMatcher> matcher(
+      rules->entries);
+  const int index = matcher->Match(url);
+  if (index == StaticURLPatternMatcher::kNoMatch)
+    return CommonStaticRedirect::kNone;
+  return rules->redirects[index];
+}
+
+}  // namespace
+
 int OnBeforeURLRequest_CommonStaticRedirectWork(
     const ResponseCallback& next_callback,
     std::shared_ptr<BraveRequestInfo> ctx) {
@@ -63,42 +107,39 @@ int OnBeforeURLRequest_CommonStaticRedirectWorkForGURL(
   DCHECK(new_url);
 
   GURL::Replacements replacements;
-  static URLPattern chromecast_pattern(
-      URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS, kChromeCastPrefix);
-  static URLPattern clients4_pattern(
-      URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS, kClients4Prefix);
-
-  if (IsUpdaterURL(request_url)) {
-    replacements.SetQueryStr(request_url.query_piece());
-    const base::CommandLine& command_line =
-        *base::CommandLine::ForCurrentProcess();
-    if (!command_line.HasSwitch(switches::kUseGoUpdateDev) &&
-        !base::FeatureList::IsEnabled(features::kUseDevUpdaterUrl)) {
-      *new_url = GURL(kBraveUpdatesExtensionsProdEndpoint)
-                            .ReplaceComponents(replacements);
-    } else {
-      *new_url = GURL(kBraveUpdatesExtensionsDevEndpoint)
-                            .ReplaceComponents(replacements);
+  switch (MatchCommonStaticRedirect(request_url)) {
+    case CommonStaticRedirect::kNone:
+      break;
+
+    case CommonStaticRedirect::kUpdater: {
+      replacements.SetQueryStr(request_url.query_piece());
+      const base::CommandLine& command_line =
+          *base::CommandLine::ForCurrentProcess();
+      if (!command_line.HasSwitch(switches::kUseGoUpdateDev) &&
+          !base::FeatureList::IsEnabled(features::kUseDevUpdaterUrl)) {
+        *new_url = GURL(kBraveUpdatesExtensionsProdEndpoint)
+                       .ReplaceComponents(replacements);
+      } else {
+        *new_url = GURL(kBraveUpdatesExtensionsDevEndpoint)
+                       .ReplaceComponents(replacements);
+      }
+      break;
     }
-    return net::OK;
-  }
 
-  if (chromecast_pattern.MatchesURL(request_url)) {
-    replacements.SetSchemeStr("https");
-    replacements.SetHostStr(kBraveRedirectorProxy);
-    *new_url = request_url.ReplaceComponents(replacements);
-    return net::OK;
-  }
+    case CommonStaticRedirect::kChromeCast:
+      replacements.SetSchemeStr("https");
+      replacements.SetHostStr(kBraveRedirectorProxy);
+      *new_url = request_url.ReplaceComponents(replacements);
+      break;
 
-  if (clients4_pattern.MatchesHost(request_url)) {
-    replacements.SetSchemeStr("https");
-    replacements.SetHostStr(kBraveClients4Proxy);
-    *new_url = request_url.ReplaceComponents(replacements);
-    return net::OK;
+    case CommonStaticRedirect::kClients4:
+      replacements.SetSchemeStr("https");
+      replacements.SetHostStr(kBraveClients4Proxy);
+      *new_url = request_url.ReplaceComponents(replacements);
+      break;
   }
 
   return net::OK;
 }
 
-
 }  // namespace brave
@@ -5,6 +5,7 @@
 
 #include "brave/browser/net/brave_proxying_url_loader_factory.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "base/bind.h"
@@ -12,16 +13,19 @@
 #include "base/metrics/histogram_macros.h"
 #include "base/strings/stringprintf.h"
 #include "base/task/post_task.h"
+#include "brave/browser/net/brave_ad_block_tp_network_delegate_helper.h"
 #include "brave/browser/net/brave_request_handler.h"
 #include "brave/components/brave_shields/browser/adblock_stub_response.h"
+#include "brave/components/brave_shields/browser/brave_shields_util.h"
+#include "brave/components/brave_shields/common/brave_shield_constants.h"
 #include "content/public/browser/browser_context.h"
 #include "content/public/browser/browser_task_traits.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/render_frame_host.h"
 #include "content/public/common/url_utils.h"
 #include "mojo/public/cpp/bindings/binding.h"
-#include "mojo/public/cpp/system/data_pipe_producer.h"
-#include "mojo/public/cpp/system/string_data_source.h"
+#include "mojo/public/cpp/bindings/remote.h"
+#include "mojo/public/cpp/system/data_pipe.h"
 #include "net/base/completion_repeating_callback.h"
 #include "net/cookies/site_for_cookies.h"
 #include "net/http/http_util.h"
@@ -30,23 +34,49 @@
 
 namespace {
 
-// Helper struct for crafting responses.
-struct WriteData {
-  base::WeakPtr<network::mojom::URLLoaderClient> client;
-  std::string data;
-  std::unique_ptr<mojo::DataPipeProducer> producer;
-};
-
-void OnWrite(std::unique_ptr<WriteData> write_data, MojoResult result) {
-  if (result != MOJO_RESULT_OK || !write_data->client) {
-    return;
+// Sends |response| and the whole of |data| to |client|, leaving only the
+// completion notification to the caller. Returns false if the body could not
+// be handed over.
+bool SendStubResponse(network::mojom::URLLoaderClient* client,
+                      network::mojom::URLResponseHeadPtr response,
+                      const scoped_refptr<base::RefCountedMemory>& data) {
+  const uint32_t size = data ? static_cast<uint32_t>(data->size()) : 0;
+
+  client->OnReceiveResponse(std::move(response));
+
+  // Create a data pipe that holds the whole response, so it can be written
+  // in one go straight from the shared stub data.
+  MojoCreateDataPipeOptions options;
+  options.struct_size = sizeof(MojoCreateDataPipeOptions);
+  options.flags = MOJO_CREATE_DATA_PIPE_FLAG_NONE;
+  options.element_num_bytes = 1;
+  options.capacity_num_bytes = std::max(size, 1u);
+  mojo::ScopedDataPipeProducerHandle producer;
+  mojo::ScopedDataPipeConsumerHandle consumer;
+  if (CreateDataPipe(&options, &producer, &consumer) != MOJO_RESULT_OK)
+    return false;
+
+  client->OnStartLoadingResponseBody(std::move(consumer));
+
+  if (size) {
+    uint32_t written = size;
+    if (producer->WriteData(data->front(), &written,
+                            MOJO_WRITE_DATA_FLAG_ALL_OR_NONE) !=
+        MOJO_RESULT_OK) {
+      return false;
+    }
   }
+  return true;
+}
 
+network::URLLoaderCompletionStatus GetStubCompletionStatus(
+    const scoped_refptr<base::RefCountedMemory>& data) {
+  const int64_t size = data ? data->size() : 0;
   network::URLLoaderCompletionStatus status(net::OK);
-  status.encoded_data_length = write_data->data.size();
-  status.encoded_body_length = write_data->data.size();
-  status.decoded_body_length = write_data->data.size();
-  write_data->client->OnComplete(status);
+  status.encoded_data_length = size;
+  status.encoded_body_length = size;
+  status.decoded_body_length = size;
+  return status;
 }
 
 }  // namespace
@@ -338,37 +368,18 @@ void BraveProxyingURLLoaderFactory::InProgressRequest::
       OnRequestError(network::URLLoaderCompletionStatus(net::ERR_ABORTED));
       return;
     }
+    brave::RecordAdBlockedRequest(*ctx_);
     auto response = network::mojom::URLResponseHead::New();
-    std::string response_data;
-    brave_shields::MakeStubResponse(ctx_->mock_data_url, request_, &response,
-                                    &response_data);
-
-    target_client_->OnReceiveResponse(std::move(response));
-
-    // Create a data pipe for transmitting the response.
-    mojo::ScopedDataPipeProducerHandle producer;
-    mojo::ScopedDataPipeConsumerHandle consumer;
-    if (CreateDataPipe(nullptr, &producer, &consumer) != MOJO_RESULT_OK) {
+    scoped_refptr<base::RefCountedMemory> response_data =
+        brave_shields::MakeStubResponse(ctx_->mock_data_url, request_,
+                                        &response);
+    if (!SendStubResponse(target_client_.get(), std::move(response),
+                          response_data)) {
       OnRequestError(
           network::URLLoaderCompletionStatus(net::ERR_INSUFFICIENT_RESOURCES));
       return;
     }
-
-    // Craft the response.
-    target_client_->OnStartLoadingResponseBody(std::move(consumer));
-
-    auto write_data = std::make_unique<WriteData>();
-    write_data->client = weak_factory_.GetWeakPtr();
-    write_data->data = response_data;
-    write_data->producer =
-        std::make_unique<mojo::DataPipeProducer>(std::move(producer));
-
-    base::StringPiece string_piece(write_data->data);
-    write_data->producer->Write(
-        std::make_unique<mojo::StringDataSource>(
-            string_piece, mojo::StringDataSource::AsyncWritingMode::
-                              STRING_STAYS_VALID_UNTIL_COMPLETION),
-        base::BindOnce(OnWrite, std::move(write_data)));
+    OnComplete(GetStubCompletionStatus(response_data));
     return;
   }
 
@@ -616,7 +627,10 @@ BraveProxyingURLLoaderFactory::BraveProxyingURLLoaderFactory(
                           base::Unretained(this)));
 }
 
-BraveProxyingURLLoaderFactory::~BraveProxyingURLLoaderFactory() = default;
+BraveProxyingURLLoaderFactory::~BraveProxyingURLLoaderFactory() {
+  UMA_HISTOGRAM_COUNTS_1000("Brave.ProxyingURLLoader.PrescreenedRequests",
+                            prescreened_requests_);
+}
 
 // static
 bool BraveProxyingURLLoaderFactory::MaybeProxyRequest(
@@ -646,6 +660,33 @@ void BraveProxyingURLLoaderFactory::CreateLoaderAndStart(
     const net::MutableNetworkTrafficAnnotationTag& traffic_annotation) {
   DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
 
+  // Requests that ad-block has already answered with a stub are answered
+  // again right here, without an InProgressRequest or the trips to the
+  // ad-block task runner that it would take.
+  std::string mock_data_url;
+  if (brave::PrescreenAdBlockedRequest(request, browser_context_,
+                                       render_process_id_,
+                                       frame_tree_node_id_, &mock_data_url)) {
+    ++prescreened_requests_;
+    brave_shields::DispatchBlockedEvent(request.url, request.render_frame_id,
+                                        render_process_id_,
+                                        frame_tree_node_id_,
+                                        brave_shields::kAds);
+    mojo::Remote<network::mojom::URLLoaderClient> target_client(
+        std::move(client));
+    auto response = network::mojom::URLResponseHead::New();
+    scoped_refptr<base::RefCountedMemory> response_data =
+        brave_shields::MakeStubResponse(mock_data_url, request, &response);
+    if (SendStubResponse(target_client.get(), std::move(response),
+                         response_data)) {
+      target_client->OnComplete(GetStubCompletionStatus(response_data));
+    } else {
+      target_client->OnComplete(
+          network::URLLoaderCompletionStatus(net::ERR_INSUFFICIENT_RESOURCES));
+    }
+    return;
+  }
+
   // The request ID doesn't really matter in the Network Service path. It just
   // needs to be unique per-BrowserContext so request handlers can make sense of
   // it. Note that |network_service_request_id_| by contrast is not necessarily
@@ -227,6 +227,10 @@ class BraveProxyingURLLoaderFactory
 
   DisconnectCallback disconnect_callback_;
 
+  // Number of requests answered from the ad-block pre-screen, each of which
+  // saved setting up an InProgressRequest.
+  int prescreened_requests_ = 0;
+
   base::WeakPtrFactory<BraveProxyingURLLoaderFactory> weak_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(BraveProxyingURLLoaderFactory);
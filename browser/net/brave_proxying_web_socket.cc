@@ -13,6 +13,7 @@
 #include "base/strings/stringprintf.h"
 #include "base/task/post_task.h"
 #include "brave/browser/net/brave_request_handler.h"
+#include "brave/browser/net/brave_websocket_filter.h"
 #include "brave/common/network_constants.h"
 #include "content/public/browser/browser_context.h"
 #include "content/public/browser/browser_task_traits.h"
@@ -31,8 +32,10 @@ BraveProxyingWebSocket::BraveProxyingWebSocket(
     content::BrowserContext* browser_context,
     scoped_refptr<RequestIDGenerator> request_id_generator,
     BraveRequestHandler* handler,
+    BraveWebSocketFilter* filter,
     DisconnectCallback on_disconnect)
     : request_handler_(handler),
+      filter_(filter),
       process_id_(process_id),
       frame_tree_node_id_(frame_tree_node_id),
       factory_(std::move(factory)),
@@ -89,13 +92,10 @@ void BraveProxyingWebSocket::Start() {
   brave::BraveRequestInfo::FillCTX(request_, process_id_,
                                    frame_tree_node_id_, request_id_,
                                    browser_context_, ctx_);
-  int result = request_handler_->OnBeforeURLRequest(
-      ctx_, continuation, &redirect_url_);
-  // TODO(bridiver) - need to handle general case for redirect_url
-
-  if (result == net::ERR_BLOCKED_BY_CLIENT ||
-      // handle adblock kEmptyDataURI
-      redirect_url_ == kEmptyDataURI) {
+  // The OnBeforeURLRequest stages of |request_handler_| only redirect, which
+  // a handshake cannot follow, or block, which is all |filter_| does.
+  int result = filter_->OnBeforeHandshake(ctx_, continuation);
+  if (result == net::ERR_BLOCKED_BY_CLIENT) {
     OnError(result);
     return;
   }
@@ -156,12 +156,8 @@ void BraveProxyingWebSocket::ContinueToHeadersReceived() {
   auto continuation = base::BindRepeating(
       &BraveProxyingWebSocket::OnHeadersReceivedComplete,
       weak_factory_.GetWeakPtr());
-  ctx_ = std::make_shared<brave::BraveRequestInfo>();
-  brave::BraveRequestInfo::FillCTX(request_, process_id_,
-                                   frame_tree_node_id_, request_id_,
-                                   browser_context_, ctx_);
   int result = request_handler_->OnHeadersReceived(
-      ctx_, continuation, response_.headers.get(),
+      ctx_, continuation, response_headers_.get(),
       &override_headers_, &redirect_url_);
 
   if (result == net::ERR_BLOCKED_BY_CLIENT ||
@@ -220,7 +216,7 @@ void BraveProxyingWebSocket::OnHeadersReceived(
   DCHECK(proxy_has_extra_headers());
 
   on_headers_received_callback_ = std::move(callback);
-  response_.headers = base::MakeRefCounted<net::HttpResponseHeaders>(headers);
+  response_headers_ = base::MakeRefCounted<net::HttpResponseHeaders>(headers);
 
   ContinueToHeadersReceived();
 }
@@ -266,10 +262,6 @@ void BraveProxyingWebSocket::OnBeforeSendHeadersCompleteFromProxy(
       &BraveProxyingWebSocket::OnBeforeSendHeadersComplete,
       weak_factory_.GetWeakPtr());
 
-  ctx_ = std::make_shared<brave::BraveRequestInfo>();
-  brave::BraveRequestInfo::FillCTX(request_, process_id_,
-                                   frame_tree_node_id_, request_id_,
-                                   browser_context_, ctx_);
   int result = request_handler_->OnBeforeStartTransaction(
       ctx_, continuation, &request_.headers);
 
@@ -346,8 +338,7 @@ void BraveProxyingWebSocket::OnHeadersReceivedCompleteFromProxy(
         .Run(net::OK, headers, base::nullopt);
 
   if (override_headers_) {
-    response_.headers = override_headers_;
-    override_headers_ = nullptr;
+    response_headers_ = std::move(override_headers_);
   }
 
   ResumeIncomingMethodCallProcessing();
@@ -359,7 +350,8 @@ void BraveProxyingWebSocket::OnHeadersReceivedComplete(int error_code) {
     return;
   }
 
-  std::string headers;
+  // Leave the headers alone unless a stage actually changed them.
+  base::Optional<std::string> headers;
   if (override_headers_)
     headers = override_headers_->raw_headers();
 
@@ -371,8 +363,7 @@ void BraveProxyingWebSocket::OnHeadersReceivedComplete(int error_code) {
             &BraveProxyingWebSocket::OnHeadersReceivedCompleteFromProxy,
             weak_factory_.GetWeakPtr()));
   } else {
-    OnHeadersReceivedCompleteFromProxy(
-        error_code, base::Optional<std::string>(headers), base::nullopt);
+    OnHeadersReceivedCompleteFromProxy(error_code, headers, base::nullopt);
   }
 }
 
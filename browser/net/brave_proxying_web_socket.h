@@ -22,14 +22,16 @@
 #include "mojo/public/cpp/bindings/pending_receiver.h"
 #include "mojo/public/cpp/bindings/receiver.h"
 #include "mojo/public/cpp/bindings/remote.h"
+#include "net/http/http_response_headers.h"
 #include "services/network/public/cpp/resource_request.h"
 #include "services/network/public/mojom/ip_endpoint.mojom.h"
 #include "services/network/public/mojom/network_context.mojom.h"
-#include "services/network/public/mojom/url_response_head.mojom.h"
 #include "services/network/public/mojom/websocket.mojom.h"
 #include "url/gurl.h"
 #include "url/origin.h"
 
+class BraveWebSocketFilter;
+
 namespace content {
 class BrowserContext;
 class RenderFrameHost;
@@ -55,6 +57,7 @@ class BraveProxyingWebSocket : public network::mojom::WebSocketHandshakeClient,
       content::BrowserContext* browser_context,
       scoped_refptr<RequestIDGenerator> request_id_generator,
       BraveRequestHandler* handler,
+      BraveWebSocketFilter* filter,
       DisconnectCallback on_disconnect);
   ~BraveProxyingWebSocket() override;
 
@@ -125,8 +128,10 @@ class BraveProxyingWebSocket : public network::mojom::WebSocketHandshakeClient,
                              const std::string& description);
 
   BraveRequestHandler* const request_handler_;
+  BraveWebSocketFilter* const filter_;
+  // Filled once in Start() and shared by all later stages, nothing they look
+  // at changes during the handshake.
   // TODO(iefremov): Get rid of shared_ptr, we should clearly own the pointer.
-  // TODO(iefremov): Init this only once.
   std::shared_ptr<brave::BraveRequestInfo> ctx_;
 
   const int process_id_;
@@ -144,7 +149,7 @@ class BraveProxyingWebSocket : public network::mojom::WebSocketHandshakeClient,
       receiver_as_header_client_;
 
   network::ResourceRequest request_;
-  network::mojom::URLResponseHead response_;
+  scoped_refptr<net::HttpResponseHeaders> response_headers_;
   scoped_refptr<net::HttpResponseHeaders> override_headers_;
   net::IPEndPoint remote_endpoint_;
 
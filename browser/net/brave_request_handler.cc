@@ -8,7 +8,9 @@
 #include <algorithm>
 #include <utility>
 
+#include "base/metrics/histogram.h"
 #include "base/metrics/histogram_macros.h"
+#include "base/strings/stringprintf.h"
 #include "base/task/post_task.h"
 #include "brave/browser/net/brave_ad_block_tp_network_delegate_helper.h"
 #include "brave/browser/net/brave_common_static_redirect_network_delegate_helper.h"
@@ -42,6 +44,47 @@
 #include "brave/browser/net/brave_translate_redirect_network_delegate_helper.h"
 #endif
 
+namespace {
+
+int RunBeforeStartTransaction(
+    int (*helper)(net::HttpRequestHeaders* headers,
+                  const brave::ResponseCallback& next_callback,
+                  std::shared_ptr<brave::BraveRequestInfo> ctx),
+    const brave::ResponseCallback& next_callback,
+    std::shared_ptr<brave::BraveRequestInfo> ctx) {
+  return helper(ctx->headers, next_callback, ctx);
+}
+
+int RunHeadersReceived(
+    int (*helper)(
+        const net::HttpResponseHeaders* original_response_headers,
+        scoped_refptr<net::HttpResponseHeaders>* override_response_headers,
+        GURL* allowed_unsafe_redirect_url,
+        const brave::ResponseCallback& next_callback,
+        std::shared_ptr<brave::BraveRequestInfo> ctx),
+    const brave::ResponseCallback& next_callback,
+    std::shared_ptr<brave::BraveRequestInfo> ctx) {
+  return helper(ctx->original_response_headers,
+                ctx->override_response_headers,
+                ctx->allowed_unsafe_redirect_url, next_callback, ctx);
+}
+
+}  // namespace
+
+BraveRequestHandler::Stage::Stage(
+    brave::BraveNetworkDelegateEventType event_type,
+    base::HistogramBase* histogram,
+    uint32_t required_traits,
+    brave::OnBeforeURLRequestCallback run)
+    : event_type(event_type),
+      histogram(histogram),
+      required_traits(required_traits),
+      run(std::move(run)) {}
+
+BraveRequestHandler::Stage::Stage(const Stage& other) = default;
+
+BraveRequestHandler::Stage::~Stage() = default;
+
 BraveRequestHandler::BraveRequestHandler() {
   DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
   SetupCallbacks();
@@ -52,47 +95,68 @@ BraveRequestHandler::BraveRequestHandler() {
 BraveRequestHandler::~BraveRequestHandler() = default;
 
 void BraveRequestHandler::SetupCallbacks() {
-  brave::OnBeforeURLRequestCallback callback =
-      base::Bind(brave::OnBeforeURLRequest_SiteHacksWork);
-  before_url_request_callbacks_.push_back(callback);
+  AddStage(brave::kOnBeforeRequest, "SiteHacks", 0,
+           base::BindRepeating(brave::OnBeforeURLRequest_SiteHacksWork));
 
-  callback = base::Bind(brave::OnBeforeURLRequest_AdBlockTPPreWork);
-  before_url_request_callbacks_.push_back(callback);
+  AddStage(brave::kOnBeforeRequest, "AdBlockTP", 0,
+           base::BindRepeating(brave::OnBeforeURLRequest_AdBlockTPPreWork));
 
-  callback = base::Bind(brave::OnBeforeURLRequest_HttpsePreFileWork);
-  before_url_request_callbacks_.push_back(callback);
+  // HTTPS Everywhere has nothing to do for other schemes.
+  AddStage(brave::kOnBeforeRequest, "Httpse",
+           kHasTabOrigin | kShieldsUp | kUpgradable,
+           base::BindRepeating(brave::OnBeforeURLRequest_HttpsePreFileWork));
 
-  callback = base::Bind(brave::OnBeforeURLRequest_CommonStaticRedirectWork);
-  before_url_request_callbacks_.push_back(callback);
+  AddStage(
+      brave::kOnBeforeRequest, "CommonStaticRedirect", 0,
+      base::BindRepeating(brave::OnBeforeURLRequest_CommonStaticRedirectWork));
 
 #if BUILDFLAG(BRAVE_REWARDS_ENABLED)
-  callback = base::Bind(brave_rewards::OnBeforeURLRequest);
-  before_url_request_callbacks_.push_back(callback);
+  // Rewards only looks at the posted data of media requests.
+  AddStage(brave::kOnBeforeRequest, "Rewards", kHasUploadData,
+           base::BindRepeating(brave_rewards::OnBeforeURLRequest));
 #endif
 
 #if BUILDFLAG(ENABLE_BRAVE_TRANSLATE_GO)
-  callback =
-      base::BindRepeating(brave::OnBeforeURLRequest_TranslateRedirectWork);
-  before_url_request_callbacks_.push_back(callback);
+  AddStage(
+      brave::kOnBeforeRequest, "TranslateRedirect", 0,
+      base::BindRepeating(brave::OnBeforeURLRequest_TranslateRedirectWork));
 #endif
 
-  brave::OnBeforeStartTransactionCallback start_transaction_callback =
-      base::Bind(brave::OnBeforeStartTransaction_SiteHacksWork);
-  before_start_transaction_callbacks_.push_back(start_transaction_callback);
+  AddStage(brave::kOnBeforeStartTransaction, "SiteHacks", 0,
+           base::BindRepeating(&RunBeforeStartTransaction,
+                               &brave::OnBeforeStartTransaction_SiteHacksWork));
 
 #if BUILDFLAG(ENABLE_BRAVE_REFERRALS)
-  start_transaction_callback =
-      base::Bind(brave::OnBeforeStartTransaction_ReferralsWork);
-  before_start_transaction_callbacks_.push_back(start_transaction_callback);
+  AddStage(brave::kOnBeforeStartTransaction, "Referrals", 0,
+           base::BindRepeating(&RunBeforeStartTransaction,
+                               &brave::OnBeforeStartTransaction_ReferralsWork));
 #endif
 
 #if BUILDFLAG(ENABLE_BRAVE_WEBTORRENT)
-  brave::OnHeadersReceivedCallback headers_received_callback =
-      base::Bind(webtorrent::OnHeadersReceived_TorrentRedirectWork);
-  headers_received_callbacks_.push_back(headers_received_callback);
+  AddStage(
+      brave::kOnHeadersReceived, "TorrentRedirect", 0,
+      base::BindRepeating(&RunHeadersReceived,
+                          &webtorrent::OnHeadersReceived_TorrentRedirectWork));
 #endif
 }
 
+void BraveRequestHandler::AddStage(
+    brave::BraveNetworkDelegateEventType event_type,
+    const char* name,
+    uint32_t required_traits,
+    brave::OnBeforeURLRequestCallback run) {
+  const char* event_name = "OnHeadersReceived";
+  if (event_type == brave::kOnBeforeRequest)
+    event_name = "OnBeforeURLRequest";
+  else if (event_type == brave::kOnBeforeStartTransaction)
+    event_name = "OnBeforeStartTransaction";
+  base::HistogramBase* histogram = base::Histogram::FactoryMicrosecondsTimeGet(
+      base::StringPrintf("Brave.RequestHandler.%s.%s", event_name, name),
+      base::TimeDelta::FromMicroseconds(1), base::TimeDelta::FromSeconds(10),
+      50, base::HistogramBase::kUmaTargetedHistogramFlag);
+  stages_.emplace_back(event_type, histogram, required_traits, std::move(run));
+}
+
 void BraveRequestHandler::InitPrefChangeRegistrar() {
   DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
 #if BUILDFLAG(ENABLE_BRAVE_REFERRALS)
@@ -125,30 +189,26 @@ int BraveRequestHandler::OnBeforeURLRequest(
     std::shared_ptr<brave::BraveRequestInfo> ctx,
     net::CompletionOnceCallback callback,
     GURL* new_url) {
-  if (before_url_request_callbacks_.empty()) {
+  if (!HasStagesFor(brave::kOnBeforeRequest)) {
     return net::OK;
   }
   SCOPED_UMA_HISTOGRAM_TIMER("Brave.OnBeforeURLRequest_Handler");
   ctx->new_url = new_url;
   ctx->event_type = brave::kOnBeforeRequest;
-  callbacks_[ctx->request_identifier] = std::move(callback);
-  RunNextCallback(ctx);
-  return net::ERR_IO_PENDING;
+  return StartStages(ctx, std::move(callback));
 }
 
 int BraveRequestHandler::OnBeforeStartTransaction(
     std::shared_ptr<brave::BraveRequestInfo> ctx,
     net::CompletionOnceCallback callback,
     net::HttpRequestHeaders* headers) {
-  if (before_start_transaction_callbacks_.empty()) {
+  if (!HasStagesFor(brave::kOnBeforeStartTransaction)) {
     return net::OK;
   }
   ctx->event_type = brave::kOnBeforeStartTransaction;
   ctx->headers = headers;
   ctx->referral_headers_list = referral_headers_list_.get();
-  callbacks_[ctx->request_identifier] = std::move(callback);
-  RunNextCallback(ctx);
-  return net::ERR_IO_PENDING;
+  return StartStages(ctx, std::move(callback));
 }
 
 int BraveRequestHandler::OnHeadersReceived(
@@ -163,18 +223,15 @@ int BraveRequestHandler::OnHeadersReceived(
         original_response_headers, override_response_headers);
   }
 
-  if (headers_received_callbacks_.empty()) {
+  if (!HasStagesFor(brave::kOnHeadersReceived)) {
     return net::OK;
   }
 
-  callbacks_[ctx->request_identifier] = std::move(callback);
   ctx->event_type = brave::kOnHeadersReceived;
   ctx->original_response_headers = original_response_headers;
   ctx->override_response_headers = override_response_headers;
   ctx->allowed_unsafe_redirect_url = allowed_unsafe_redirect_url;
-
-  RunNextCallback(ctx);
-  return net::ERR_IO_PENDING;
+  return StartStages(ctx, std::move(callback));
 }
 
 void BraveRequestHandler::OnURLRequestDestroyed(
@@ -182,6 +239,7 @@ void BraveRequestHandler::OnURLRequestDestroyed(
   if (base::Contains(callbacks_, ctx->request_identifier)) {
     callbacks_.erase(ctx->request_identifier);
   }
+  brave::OnURLRequestDestroyed_HttpseWork(ctx);
 }
 
 void BraveRequestHandler::RunCallbackForRequestIdentifier(
@@ -193,10 +251,85 @@ void BraveRequestHandler::RunCallbackForRequestIdentifier(
   // of URLLoader callbacks.
   base::PostTask(FROM_HERE, {content::BrowserThread::UI},
                  base::BindOnce(std::move(it->second), rv));
+  callbacks_.erase(it);
+}
+
+bool BraveRequestHandler::HasStagesFor(
+    brave::BraveNetworkDelegateEventType event_type) const {
+  return std::any_of(
+      stages_.begin(), stages_.end(),
+      [event_type](const Stage& stage) {
+        return stage.event_type == event_type;
+      });
+}
+
+// static
+uint32_t BraveRequestHandler::GetRequestTraits(
+    const brave::BraveRequestInfo& ctx) {
+  uint32_t traits = 0;
+  if (!ctx.tab_origin.is_empty())
+    traits |= kHasTabOrigin;
+  if (ctx.allow_brave_shields)
+    traits |= kShieldsUp;
+  if (ctx.request_url.SchemeIsHTTPOrHTTPS() &&
+      !ctx.allow_http_upgradable_resource)
+    traits |= kUpgradable;
+  if (ctx.GetUploadDataSize())
+    traits |= kHasUploadData;
+  return traits;
+}
+
+int BraveRequestHandler::StartStages(
+    std::shared_ptr<brave::BraveRequestInfo> ctx,
+    net::CompletionOnceCallback callback) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  ctx->request_traits = GetRequestTraits(*ctx);
+  ctx->next_url_request_index = 0;
+
+  int rv = RunStages(ctx);
+  if (rv != net::ERR_IO_PENDING) {
+    rv = FinishStages(ctx.get(), rv);
+    // Callers only handle net::OK synchronously, report anything else
+    // through |callback| as before.
+    if (rv == net::OK)
+      return rv;
+  }
+
+  callbacks_[ctx->request_identifier] = std::move(callback);
+  if (rv != net::ERR_IO_PENDING)
+    RunCallbackForRequestIdentifier(ctx->request_identifier, rv);
+  return net::ERR_IO_PENDING;
+}
+
+int BraveRequestHandler::RunStages(
+    std::shared_ptr<brave::BraveRequestInfo> ctx) {
+  // Shared by all helpers run from here, it is only needed by the
+  // asynchronous ones but they are not known upfront.
+  brave::ResponseCallback next_callback;
+  while (ctx->next_url_request_index < stages_.size()) {
+    const Stage& stage = stages_[ctx->next_url_request_index++];
+    if (stage.event_type != ctx->event_type ||
+        (ctx->request_traits & stage.required_traits) !=
+            stage.required_traits) {
+      continue;
+    }
+    if (next_callback.is_null()) {
+      next_callback = base::BindRepeating(&BraveRequestHandler::RunNextCallback,
+                                          weak_factory_.GetWeakPtr(), ctx);
+    }
+    ctx->stage_start_time = base::TimeTicks::Now();
+    int rv = stage.run.Run(next_callback, ctx);
+    if (rv == net::ERR_IO_PENDING) {
+      return rv;
+    }
+    RecordStageTime(ctx.get());
+    if (rv != net::OK) {
+      return rv;
+    }
+  }
+  return net::OK;
 }
 
-// TODO(iefremov): Merge all callback containers into one and run only one loop
-// instead of many (issues/5574).
 void BraveRequestHandler::RunNextCallback(
     std::shared_ptr<brave::BraveRequestInfo> ctx) {
   DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
@@ -205,81 +338,38 @@ void BraveRequestHandler::RunNextCallback(
     return;
   }
 
-  // Continue processing callbacks until we hit one that returns PENDING
-  int rv = net::OK;
+  // The helper that went asynchronous is done now.
+  RecordStageTime(ctx.get());
 
-  if (ctx->event_type == brave::kOnBeforeRequest) {
-    while (before_url_request_callbacks_.size() !=
-           ctx->next_url_request_index) {
-      brave::OnBeforeURLRequestCallback callback =
-          before_url_request_callbacks_[ctx->next_url_request_index++];
-      brave::ResponseCallback next_callback = base::Bind(
-          &BraveRequestHandler::RunNextCallback,
-          weak_factory_.GetWeakPtr(),
-          ctx);
-      rv = callback.Run(next_callback, ctx);
-      if (rv == net::ERR_IO_PENDING) {
-        return;
-      }
-      if (rv != net::OK) {
-        break;
-      }
-    }
-  } else if (ctx->event_type == brave::kOnBeforeStartTransaction) {
-    while (before_start_transaction_callbacks_.size() !=
-           ctx->next_url_request_index) {
-      brave::OnBeforeStartTransactionCallback callback =
-          before_start_transaction_callbacks_[ctx->next_url_request_index++];
-      brave::ResponseCallback next_callback = base::Bind(
-          &BraveRequestHandler::RunNextCallback,
-          weak_factory_.GetWeakPtr(),
-          ctx);
-      rv = callback.Run(ctx->headers, next_callback, ctx);
-      if (rv == net::ERR_IO_PENDING) {
-        return;
-      }
-      if (rv != net::OK) {
-        break;
-      }
-    }
-  } else if (ctx->event_type == brave::kOnHeadersReceived) {
-    while (headers_received_callbacks_.size() != ctx->next_url_request_index) {
-      brave::OnHeadersReceivedCallback callback =
-          headers_received_callbacks_[ctx->next_url_request_index++];
-      brave::ResponseCallback next_callback = base::Bind(
-          &BraveRequestHandler::RunNextCallback,
-          weak_factory_.GetWeakPtr(),
-          ctx);
-      rv = callback.Run(ctx->original_response_headers,
-                        ctx->override_response_headers,
-                        ctx->allowed_unsafe_redirect_url, next_callback, ctx);
-      if (rv == net::ERR_IO_PENDING) {
-        return;
-      }
-      if (rv != net::OK) {
-        break;
-      }
-    }
+  int rv = RunStages(ctx);
+  if (rv == net::ERR_IO_PENDING) {
+    return;
   }
+  RunCallbackForRequestIdentifier(ctx->request_identifier,
+                                  FinishStages(ctx.get(), rv));
+}
 
+int BraveRequestHandler::FinishStages(brave::BraveRequestInfo* ctx, int rv) {
   if (rv != net::OK) {
-    RunCallbackForRequestIdentifier(ctx->request_identifier, rv);
-    return;
+    return rv;
   }
 
   if (ctx->event_type == brave::kOnBeforeRequest) {
     if (!ctx->new_url_spec.empty() &&
-        (ctx->new_url_spec != ctx->request_url.spec()) &&
-        IsRequestIdentifierValid(ctx->request_identifier)) {
+        (ctx->new_url_spec != ctx->request_url.spec())) {
       *ctx->new_url = GURL(ctx->new_url_spec);
     }
-    if (ctx->blocked_by == brave::kAdBlocked) {
-      if (ctx->cancel_request_explicitly) {
-        RunCallbackForRequestIdentifier(ctx->request_identifier,
-                                        net::ERR_ABORTED);
-        return;
-      }
+    if (ctx->blocked_by == brave::kAdBlocked &&
+        ctx->cancel_request_explicitly) {
+      return net::ERR_ABORTED;
     }
   }
-  RunCallbackForRequestIdentifier(ctx->request_identifier, rv);
+  return rv;
+}
+
+void BraveRequestHandler::RecordStageTime(brave::BraveRequestInfo* ctx) {
+  DCHECK_GT(ctx->next_url_request_index, 0u);
+  stages_[ctx->next_url_request_index - 1].histogram
+      ->AddTimeMicrosecondsGranularity(base::TimeTicks::Now() -
+                                       ctx->stage_start_time);
 }
@@ -6,11 +6,14 @@
 #ifndef BRAVE_BROWSER_NET_BRAVE_REQUEST_HANDLER_H_
 #define BRAVE_BROWSER_NET_BRAVE_REQUEST_HANDLER_H_
 
+#include <stdint.h>
+
 #include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "base/metrics/histogram_base.h"
 #include "brave/browser/net/url_context.h"
 #include "content/public/browser/browser_thread.h"
 #include "net/base/completion_once_callback.h"
@@ -46,18 +49,66 @@ class BraveRequestHandler {
   void RunCallbackForRequestIdentifier(uint64_t request_identifier, int rv);
 
  private:
+  // Properties of a request that decide which helpers can have any effect on
+  // it. Computed once per event before any helper runs.
+  enum RequestTraits : uint32_t {
+    kHasTabOrigin = 1 << 0,
+    kShieldsUp = 1 << 1,
+    // An http(s) URL that HTTPS Everywhere may rewrite.
+    kUpgradable = 1 << 2,
+    kHasUploadData = 1 << 3,
+  };
+
+  // A network delegate helper registered for one event type.
+  struct Stage {
+    Stage(brave::BraveNetworkDelegateEventType event_type,
+          base::HistogramBase* histogram,
+          uint32_t required_traits,
+          brave::OnBeforeURLRequestCallback run);
+    Stage(const Stage& other);
+    ~Stage();
+
+    brave::BraveNetworkDelegateEventType event_type;
+    // Time from invoking the helper until it let the request continue. Only
+    // kept locally, see chrome://histograms.
+    base::HistogramBase* histogram;
+    // The helper is skipped unless the request has all of these traits.
+    uint32_t required_traits;
+    // Helpers for other events are adapted to this signature at setup, they
+    // find their extra arguments in the request info.
+    brave::OnBeforeURLRequestCallback run;
+  };
+
   void SetupCallbacks();
+  void AddStage(brave::BraveNetworkDelegateEventType event_type,
+                const char* name,
+                uint32_t required_traits,
+                brave::OnBeforeURLRequestCallback run);
   void InitPrefChangeRegistrar();
   void OnReferralHeadersChanged();
   void OnPreferenceChanged(const std::string& pref_name);
   void UpdateAdBlockFromPref(const std::string& pref_name);
 
+  bool HasStagesFor(brave::BraveNetworkDelegateEventType event_type) const;
+  static uint32_t GetRequestTraits(const brave::BraveRequestInfo& ctx);
+
+  // Starts running the helpers for |ctx->event_type|. Returns the result if
+  // they all completed synchronously, otherwise keeps |callback| and returns
+  // net::ERR_IO_PENDING.
+  int StartStages(std::shared_ptr<brave::BraveRequestInfo> ctx,
+                  net::CompletionOnceCallback callback);
+  // Runs helpers from |ctx->next_url_request_index| on until one of them
+  // is asynchronous or fails. Returns net::ERR_IO_PENDING in the former case
+  // and the final result otherwise.
+  int RunStages(std::shared_ptr<brave::BraveRequestInfo> ctx);
+  // Resumes the helpers after an asynchronous one completed.
   void RunNextCallback(std::shared_ptr<brave::BraveRequestInfo> ctx);
+  // Applies the outcome of the OnBeforeURLRequest helpers to the request.
+  int FinishStages(brave::BraveRequestInfo* ctx, int rv);
+  void RecordStageTime(brave::BraveRequestInfo* ctx);
 
-  std::vector<brave::OnBeforeURLRequestCallback> before_url_request_callbacks_;
-  std::vector<brave::OnBeforeStartTransactionCallback>
-      before_start_transaction_callbacks_;
-  std::vector<brave::OnHeadersReceivedCallback> headers_received_callbacks_;
+  // The helpers of all event types, in the order they run.
+  std::vector<Stage> stages_;
 
   // TODO(iefremov): actually, we don't have to keep the list here, since
   // it is global for the whole browser and could live a singletonce in the
@@ -8,13 +8,86 @@
 #include <memory>
 #include <vector>
 
+#include "base/no_destructor.h"
 #include "brave/browser/translate/buildflags/buildflags.h"
 #include "brave/common/network_constants.h"
+#include "brave/common/static_url_pattern_matcher.h"
 #include "brave/common/translate_network_constants.h"
 #include "extensions/common/url_pattern.h"
 
 namespace brave {
 
+namespace {
+
+enum class StaticRedirect {
+  kNone,
+  kGeoLocation,
+  kSafeBrowsing,
+  kSafeBrowsingFileCheck,
+  kCRXDownload,
+  kAutofill,
+  kCRLSet,
+  kRedirectorProxy,
+#if BUILDFLAG(ENABLE_BRAVE_TRANSLATE_GO)
+  kTranslate,
+  kTranslateLanguage,
+#endif
+};
+
+constexpr int kHttpOrHttps = URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS;
+
+using MatchType = StaticURLPatternMatcher::MatchType;
+
+struct StaticRedirectRule {
+  int valid_schemes;
+  const char* pattern;
+  MatchType match_type;
+  StaticRedirect redirect;
+};
+
+// Evaluated in order, the first matching rule wins.
+const StaticRedirectRule kStaticRedirectRules[] = {
+    {URLPattern::SCHEME_HTTPS, kGeoLocationsPattern, MatchType::kURL,
+     StaticRedirect::kGeoLocation},
+    {URLPattern::SCHEME_HTTPS, kSafeBrowsingPrefix, MatchType::kHost,
+     StaticRedirect::kSafeBrowsing},
+    {URLPattern::SCHEME_HTTPS, kSafeBrowsingFileCheckPrefix, MatchType::kHost,
+     StaticRedirect::kSafeBrowsingFileCheck},
+    {kHttpOrHttps, kCRXDownloadPrefix, MatchType::kURL,
+     StaticRedirect::kCRXDownload},
+    {URLPattern::SCHEME_HTTPS, kAutofillPrefix, MatchType::kURL,
+     StaticRedirect::kAutofill},
+    {kHttpOrHttps, kCRLSetPrefix1, MatchType::kURL, StaticRedirect::kCRLSet},
+    {kHttpOrHttps, kCRLSetPrefix2, MatchType::kURL, StaticRedirect::kCRLSet},
+    {kHttpOrHttps, kCRLSetPrefix3, MatchType::kURL, StaticRedirect::kCRLSet},
+    {kHttpOrHttps, kCRLSetPrefix4, MatchType::kURL, StaticRedirect::kCRLSet},
+    {kHttpOrHttps, "*://*.gvt1.com/*", MatchType::kURL,
+     StaticRedirect::kRedirectorProxy},
+    {kHttpOrHttps, "*://dl.google.com/*", MatchType::kURL,
+     StaticRedirect::kRedirectorProxy},
+#if BUILDFLAG(ENABLE_BRAVE_TRANSLATE_GO)
+    {URLPattern::SCHEME_HTTPS, kTranslateElementJSPattern, MatchType::kURL,
+     StaticRedirect::kTranslate},
+    {URLPattern::SCHEME_HTTPS, kTranslateLanguagePattern, MatchType::kURL,
+     StaticRedirect::kTranslateLanguage},
+#endif
+};
+
+StaticRedirect MatchStaticRedirect(const GURL& url) {
+  static const base::NoDestructor<StaticURLPatternMatcher> matcher([] {
+    std::vector<StaticURLPatternMatcher::Entry> entries;
+    for (const auto& rule : kStaticRedirectRules)
+      entries.push_back({rule.valid_schemes, rule.pattern, rule.match_type});
+    return entries;
+  }());
+  const int index = matcher->Match(url);
+  if (index == StaticURLPatternMatcher::kNoMatch)
+    return StaticRedirect::kNone;
+  return kStaticRedirectRules[index].redirect;
+}
+
+}  // namespace
+
 int OnBeforeURLRequest_StaticRedirectWork(
     const ResponseCallback& next_callback,
     std::shared_ptr<BraveRequestInfo> ctx) {
@@ -31,129 +104,66 @@ int OnBeforeURLRequest_StaticRedirectWorkForGURL(
     const GURL& request_url,
     GURL* new_url) {
   GURL::Replacements replacements;
-  static URLPattern geo_pattern(URLPattern::SCHEME_HTTPS, kGeoLocationsPattern);
-  static URLPattern safeBrowsing_pattern(URLPattern::SCHEME_HTTPS,
-                                         kSafeBrowsingPrefix);
-  static URLPattern safebrowsingfilecheck_pattern(URLPattern::SCHEME_HTTPS,
-                                         kSafeBrowsingFileCheckPrefix);
-  static URLPattern crlSet_pattern1(
-      URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS, kCRLSetPrefix1);
-  static URLPattern crlSet_pattern2(
-      URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS, kCRLSetPrefix2);
-  static URLPattern crlSet_pattern3(
-      URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS, kCRLSetPrefix3);
-  static URLPattern crlSet_pattern4(
-      URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS, kCRLSetPrefix4);
-  static URLPattern crxDownload_pattern(
-      URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS, kCRXDownloadPrefix);
-  static URLPattern autofill_pattern(
-      URLPattern::SCHEME_HTTPS, kAutofillPrefix);
-  static URLPattern gvt1_pattern(
-      URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS, "*://*.gvt1.com/*");
-  static URLPattern googleDl_pattern(
-      URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS,
-      "*://dl.google.com/*");
+  switch (MatchStaticRedirect(request_url)) {
+    case StaticRedirect::kNone:
+      break;
+
+    case StaticRedirect::kGeoLocation:
+      *new_url = GURL(GOOGLEAPIS_ENDPOINT GOOGLEAPIS_API_KEY);
+      break;
+
+    case StaticRedirect::kSafeBrowsing:
+      replacements.SetHostStr(SAFEBROWSING_ENDPOINT);
+      *new_url = request_url.ReplaceComponents(replacements);
+      break;
+
+    case StaticRedirect::kSafeBrowsingFileCheck:
+      // TODO(@fmarier): Re-enable download protection once we have
+      // truncated the list of metadata that it sends to the server
+      // (brave/brave-browser#6267).
+      //
+      // replacements.SetHostStr(kBraveSafeBrowsingFileCheckProxy);
+      // *new_url = request_url.ReplaceComponents(replacements);
+      break;
+
+    case StaticRedirect::kCRXDownload:
+      replacements.SetSchemeStr("https");
+      replacements.SetHostStr("crxdownload.brave.com");
+      *new_url = request_url.ReplaceComponents(replacements);
+      break;
+
+    case StaticRedirect::kAutofill:
+      replacements.SetSchemeStr("https");
+      replacements.SetHostStr(kBraveStaticProxy);
+      *new_url = request_url.ReplaceComponents(replacements);
+      break;
+
+    case StaticRedirect::kCRLSet:
+      replacements.SetSchemeStr("https");
+      replacements.SetHostStr("crlsets.brave.com");
+      *new_url = request_url.ReplaceComponents(replacements);
+      break;
+
+    case StaticRedirect::kRedirectorProxy:
+      replacements.SetSchemeStr("https");
+      replacements.SetHostStr(kBraveRedirectorProxy);
+      *new_url = request_url.ReplaceComponents(replacements);
+      break;
 
 #if BUILDFLAG(ENABLE_BRAVE_TRANSLATE_GO)
-  static URLPattern translate_pattern(URLPattern::SCHEME_HTTPS,
-      kTranslateElementJSPattern);
-  static URLPattern translate_language_pattern(URLPattern::SCHEME_HTTPS,
-      kTranslateLanguagePattern);
+    case StaticRedirect::kTranslate:
+      replacements.SetQueryStr(request_url.query_piece());
+      replacements.SetPathStr(request_url.path_piece());
+      *new_url = GURL(kBraveTranslateEndpoint).ReplaceComponents(replacements);
+      break;
+
+    case StaticRedirect::kTranslateLanguage:
+      *new_url = GURL(kBraveTranslateLanguageEndpoint);
+      break;
 #endif
-  if (geo_pattern.MatchesURL(request_url)) {
-    *new_url = GURL(GOOGLEAPIS_ENDPOINT GOOGLEAPIS_API_KEY);
-    return net::OK;
-  }
-
-  if (safeBrowsing_pattern.MatchesHost(request_url)) {
-    replacements.SetHostStr(SAFEBROWSING_ENDPOINT);
-    *new_url = request_url.ReplaceComponents(replacements);
-    return net::OK;
-  }
-
-  if (safebrowsingfilecheck_pattern.MatchesHost(request_url)) {
-    // TODO(@fmarier): Re-enable download protection once we have
-    // truncated the list of metadata that it sends to the server
-    // (brave/brave-browser#6267).
-    //
-    // replacements.SetHostStr(kBraveSafeBrowsingFileCheckProxy);
-    // *new_url = request_url.ReplaceComponents(replacements);
-    return net::OK;
-  }
-
-  if (crxDownload_pattern.MatchesURL(request_url)) {
-    replacements.SetSchemeStr("https");
-    replacements.SetHostStr("crxdownload.brave.com");
-    *new_url = request_url.ReplaceComponents(replacements);
-    return net::OK;
-  }
-
-  if (autofill_pattern.MatchesURL(request_url)) {
-    replacements.SetSchemeStr("https");
-    replacements.SetHostStr(kBraveStaticProxy);
-    *new_url = request_url.ReplaceComponents(replacements);
-    return net::OK;
-  }
-
-  if (crlSet_pattern1.MatchesURL(request_url)) {
-    replacements.SetSchemeStr("https");
-    replacements.SetHostStr("crlsets.brave.com");
-    *new_url = request_url.ReplaceComponents(replacements);
-    return net::OK;
   }
 
-  if (crlSet_pattern2.MatchesURL(request_url)) {
-    replacements.SetSchemeStr("https");
-    replacements.SetHostStr("crlsets.brave.com");
-    *new_url = request_url.ReplaceComponents(replacements);
-    return net::OK;
-  }
-
-  if (crlSet_pattern3.MatchesURL(request_url)) {
-    replacements.SetSchemeStr("https");
-    replacements.SetHostStr("crlsets.brave.com");
-    *new_url = request_url.ReplaceComponents(replacements);
-    return net::OK;
-  }
-
-  if (crlSet_pattern4.MatchesURL(request_url)) {
-    replacements.SetSchemeStr("https");
-    replacements.SetHostStr("crlsets.brave.com");
-    *new_url = request_url.ReplaceComponents(replacements);
-    return net::OK;
-  }
-
-  if (gvt1_pattern.MatchesURL(request_url)) {
-    replacements.SetSchemeStr("https");
-    replacements.SetHostStr(kBraveRedirectorProxy);
-    *new_url = request_url.ReplaceComponents(replacements);
-    return net::OK;
-  }
-
-  if (googleDl_pattern.MatchesURL(request_url)) {
-    replacements.SetSchemeStr("https");
-    replacements.SetHostStr(kBraveRedirectorProxy);
-    *new_url = request_url.ReplaceComponents(replacements);
-    return net::OK;
-  }
-
-#if BUILDFLAG(ENABLE_BRAVE_TRANSLATE_GO)
-  if (translate_pattern.MatchesURL(request_url)) {
-    replacements.SetQueryStr(request_url.query_piece());
-    replacements.SetPathStr(request_url.path_piece());
-    *new_url =
-      GURL(kBraveTranslateEndpoint).ReplaceComponents(replacements);
-    return net::OK;
-  }
-
-  if (translate_language_pattern.MatchesURL(request_url)) {
-    *new_url = GURL(kBraveTranslateLanguageEndpoint);
-    return net::OK;
-  }
-#endif
-
   return net::OK;
 }
 
-
 }  // namespace brave
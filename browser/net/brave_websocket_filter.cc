@@ -0,0 +1,109 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/browser/net/brave_websocket_filter.h"
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/metrics/histogram_macros.h"
+#include "brave/browser/net/url_context.h"
+#include "brave/common/shield_exceptions.h"
+#include "brave/components/brave_shields/browser/ad_block_base_service.h"
+#include "brave/components/brave_shields/browser/ad_block_matcher.h"
+#include "brave/components/brave_shields/browser/ad_block_request.h"
+#include "brave/components/brave_shields/browser/brave_shields_util.h"
+#include "brave/components/brave_shields/common/brave_shield_constants.h"
+#include "content/public/browser/browser_thread.h"
+#include "net/base/net_errors.h"
+
+namespace {
+
+void ShouldBlockWebSocketOnTaskRunner(
+    brave_shields::AdBlockBaseService* ad_block_service,
+    brave_shields::AdBlockRegionalServiceManager* regional_service_manager,
+    brave_shields::AdBlockBaseService* custom_filters_service,
+    std::shared_ptr<brave::BraveRequestInfo> ctx) {
+  ctx->ad_block_engine_generation =
+      brave_shields::AdBlockBaseService::CurrentEngineGeneration();
+  const brave_shields::AdBlockRequest request(
+      ctx->request_url, brave_shields::WebSocketResourceTypeString(),
+      ctx->tab_origin.host());
+  const brave_shields::AdBlockMatcher matcher(
+      ad_block_service, regional_service_manager, custom_filters_service);
+  // There is no stub response for a socket, a blocked handshake just fails.
+  if (!matcher.ShouldStartRequest(request, nullptr, nullptr, nullptr))
+    ctx->blocked_by = brave::kAdBlocked;
+}
+
+// Reports a blocked handshake to Shields the same way a blocked request is.
+int GetHandshakeResult(const brave::BraveRequestInfo& ctx, bool blocked) {
+  if (!blocked)
+    return net::OK;
+  brave_shields::DispatchBlockedEvent(
+      ctx.request_url, ctx.render_frame_id, ctx.render_process_id,
+      ctx.frame_tree_node_id, brave_shields::kAds);
+  return net::ERR_BLOCKED_BY_CLIENT;
+}
+
+}  // namespace
+
+BraveWebSocketFilter::BraveWebSocketFilter(
+    brave_shields::AdBlockBaseService* ad_block_service,
+    brave_shields::AdBlockRegionalServiceManager* regional_service_manager,
+    brave_shields::AdBlockBaseService* custom_filters_service)
+    : ad_block_service_(ad_block_service),
+      regional_service_manager_(regional_service_manager),
+      custom_filters_service_(custom_filters_service),
+      decisions_(kMaxDecisions) {}
+
+BraveWebSocketFilter::~BraveWebSocketFilter() = default;
+
+int BraveWebSocketFilter::OnBeforeHandshake(
+    std::shared_ptr<brave::BraveRequestInfo> ctx,
+    net::CompletionOnceCallback callback) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  // See OnBeforeURLRequest_AdBlockTPPreWork().
+  if (IsBlockedResource(ctx->request_url))
+    return net::ERR_BLOCKED_BY_CLIENT;
+
+  if (ctx->tab_origin.is_empty() || !ctx->tab_origin.has_host() ||
+      !ctx->allow_brave_shields || ctx->allow_ads) {
+    return net::OK;
+  }
+
+  const std::string key = brave_shields::GetAdBlockDecisionKey(
+      ctx->request_url, brave_shields::WebSocketResourceTypeString(),
+      ctx->tab_origin.host());
+  auto it = decisions_.Get(key);
+  const bool cached =
+      it != decisions_.end() &&
+      it->second.engine_generation ==
+          brave_shields::AdBlockBaseService::CurrentEngineGeneration();
+  UMA_HISTOGRAM_BOOLEAN("Brave.WebSocketFilter.DecisionCached", cached);
+  if (cached)
+    return GetHandshakeResult(*ctx, it->second.blocked);
+
+  ad_block_service_->GetTaskRunner()->PostTaskAndReply(
+      FROM_HERE,
+      base::BindOnce(&ShouldBlockWebSocketOnTaskRunner,
+                     base::Unretained(ad_block_service_),
+                     base::Unretained(regional_service_manager_),
+                     base::Unretained(custom_filters_service_), ctx),
+      base::BindOnce(&BraveWebSocketFilter::OnShouldBlockResult,
+                     weak_factory_.GetWeakPtr(), key, ctx,
+                     std::move(callback)));
+  return net::ERR_IO_PENDING;
+}
+
+void BraveWebSocketFilter::OnShouldBlockResult(
+    const std::string& key,
+    std::shared_ptr<brave::BraveRequestInfo> ctx,
+    net::CompletionOnceCallback callback) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  const bool blocked = ctx->blocked_by == brave::kAdBlocked;
+  decisions_.Put(key, Decision{ctx->ad_block_engine_generation, blocked});
+  std::move(callback).Run(GetHandshakeResult(*ctx, blocked));
+}
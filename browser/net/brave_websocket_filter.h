@@ -0,0 +1,76 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_BROWSER_NET_BRAVE_WEBSOCKET_FILTER_H_
+#define BRAVE_BROWSER_NET_BRAVE_WEBSOCKET_FILTER_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+#include "base/containers/mru_cache.h"
+#include "base/macros.h"
+#include "base/memory/weak_ptr.h"
+#include "net/base/completion_once_callback.h"
+
+namespace brave {
+struct BraveRequestInfo;
+}
+
+namespace brave_shields {
+class AdBlockBaseService;
+class AdBlockRegionalServiceManager;
+}
+
+// Ad-block stage for WebSocket handshakes, used by BraveProxyingWebSocket in
+// place of the generic OnBeforeURLRequest stages. Handshakes are matched as
+// "websocket" requests, a type the request handler pipeline has no
+// content::ResourceType for. Decisions are remembered per tab host and socket
+// URL until an ad-block engine changes, so pages that open many sockets only
+// go to the ad-block task runner once per distinct socket. One per profile,
+// owned by ResourceContextData. Must be used on the UI thread.
+class BraveWebSocketFilter {
+ public:
+  static constexpr size_t kMaxDecisions = 256;
+
+  // The services must outlive the ad-block task runner tasks posted by this
+  // filter. |regional_service_manager| and |custom_filters_service| can be
+  // null.
+  BraveWebSocketFilter(
+      brave_shields::AdBlockBaseService* ad_block_service,
+      brave_shields::AdBlockRegionalServiceManager* regional_service_manager,
+      brave_shields::AdBlockBaseService* custom_filters_service);
+  ~BraveWebSocketFilter();
+
+  // Decides whether the handshake described by |ctx| may start. Returns
+  // net::OK or net::ERR_BLOCKED_BY_CLIENT if that is known right away.
+  // Otherwise returns net::ERR_IO_PENDING and runs |callback| with one of
+  // those once ad-block has been consulted.
+  int OnBeforeHandshake(std::shared_ptr<brave::BraveRequestInfo> ctx,
+                        net::CompletionOnceCallback callback);
+
+ private:
+  struct Decision {
+    uint64_t engine_generation;
+    bool blocked;
+  };
+
+  void OnShouldBlockResult(const std::string& key,
+                           std::shared_ptr<brave::BraveRequestInfo> ctx,
+                           net::CompletionOnceCallback callback);
+
+  brave_shields::AdBlockBaseService* ad_block_service_;  // NOT OWNED
+  // NOT OWNED
+  brave_shields::AdBlockRegionalServiceManager* regional_service_manager_;
+  brave_shields::AdBlockBaseService* custom_filters_service_;  // NOT OWNED
+  base::HashingMRUCache<std::string, Decision> decisions_;
+
+  base::WeakPtrFactory<BraveWebSocketFilter> weak_factory_{this};
+
+  DISALLOW_COPY_AND_ASSIGN(BraveWebSocketFilter);
+};
+
+#endif  // BRAVE_BROWSER_NET_BRAVE_WEBSOCKET_FILTER_H_
@@ -0,0 +1,197 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/browser/net/brave_websocket_filter.h"
+
+#include <memory>
+#include <string>
+
+#include "base/bind.h"
+#include "base/task/post_task.h"
+#include "base/test/metrics/histogram_tester.h"
+#include "brave/browser/net/url_context.h"
+#include "brave/components/brave_shields/browser/ad_block_base_service.h"
+#include "content/public/test/browser_task_environment.h"
+#include "net/base/net_errors.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace {
+
+const char kBlockedSocketURL[] = "wss://ads.example.com/socket";
+const char kAllowedSocketURL[] = "wss://chat.example.com/socket";
+
+class TestComponentDelegate : public BraveComponent::Delegate {
+ public:
+  TestComponentDelegate()
+      : task_runner_(base::CreateSequencedTaskRunner({base::ThreadPool()})) {}
+  ~TestComponentDelegate() override = default;
+
+  void Register(const std::string& component_name,
+                const std::string& component_base64_public_key,
+                base::OnceClosure registered_callback,
+                BraveComponent::ReadyCallback ready_callback) override {}
+  bool Unregister(const std::string& component_id) override { return true; }
+  void OnDemandUpdate(const std::string& component_id) override {}
+  scoped_refptr<base::SequencedTaskRunner> GetTaskRunner() override {
+    return task_runner_;
+  }
+
+ private:
+  scoped_refptr<base::SequencedTaskRunner> task_runner_;
+};
+
+class TestAdBlockService : public brave_shields::AdBlockBaseService {
+ public:
+  explicit TestAdBlockService(BraveComponent::Delegate* delegate)
+      : AdBlockBaseService(delegate) {}
+
+  using AdBlockBaseService::ResetForTest;
+};
+
+}  // namespace
+
+class BraveWebSocketFilterTest : public testing::Test {
+ public:
+  BraveWebSocketFilterTest()
+      : ad_block_service_(&delegate_),
+        filter_(&ad_block_service_, nullptr, nullptr) {}
+  ~BraveWebSocketFilterTest() override {}
+
+ protected:
+  void SetUp() override {
+    ResetAdBlockService("||ads.example.com^$websocket");
+  }
+
+  // Replaces the ad-block engine on the ad-block task runner.
+  void ResetAdBlockService(const std::string& rules) {
+    delegate_.GetTaskRunner()->PostTask(
+        FROM_HERE, base::BindOnce(&TestAdBlockService::ResetForTest,
+                                  base::Unretained(&ad_block_service_), rules,
+                                  ""));
+    task_environment_.RunUntilIdle();
+  }
+
+  std::shared_ptr<brave::BraveRequestInfo> MakeContext(const GURL& url) {
+    auto ctx = std::make_shared<brave::BraveRequestInfo>(url);
+    ctx->tab_origin = GURL("https://example.com/");
+    return ctx;
+  }
+
+  // Runs the handshake described by |ctx| through the filter and returns its
+  // result. |answered_right_away| tells whether the filter answered without
+  // consulting ad-block.
+  int OnBeforeHandshake(std::shared_ptr<brave::BraveRequestInfo> ctx,
+                        bool* answered_right_away) {
+    int result = net::ERR_IO_PENDING;
+    const int rv = filter_.OnBeforeHandshake(
+        ctx, base::BindOnce([](int* result, int rv) { *result = rv; },
+                            &result));
+    *answered_right_away = rv != net::ERR_IO_PENDING;
+    if (*answered_right_away)
+      return rv;
+    task_environment_.RunUntilIdle();
+    return result;
+  }
+
+  int OnBeforeHandshake(const GURL& url, bool* answered_right_away) {
+    return OnBeforeHandshake(MakeContext(url), answered_right_away);
+  }
+
+  content::BrowserTaskEnvironment task_environment_;
+  TestComponentDelegate delegate_;
+  TestAdBlockService ad_block_service_;
+  BraveWebSocketFilter filter_;
+};
+
+TEST_F(BraveWebSocketFilterTest, BlocksMatchingSockets) {
+  bool answered_right_away = true;
+  EXPECT_EQ(net::ERR_BLOCKED_BY_CLIENT,
+            OnBeforeHandshake(GURL(kBlockedSocketURL), &answered_right_away));
+  EXPECT_FALSE(answered_right_away);
+
+  EXPECT_EQ(net::OK,
+            OnBeforeHandshake(GURL(kAllowedSocketURL), &answered_right_away));
+  EXPECT_FALSE(answered_right_away);
+}
+
+TEST_F(BraveWebSocketFilterTest, ReusesDecisionsForSameEngines) {
+  base::HistogramTester histogram_tester;
+  bool answered_right_away = true;
+  EXPECT_EQ(net::ERR_BLOCKED_BY_CLIENT,
+            OnBeforeHandshake(GURL(kBlockedSocketURL), &answered_right_away));
+  EXPECT_FALSE(answered_right_away);
+  EXPECT_EQ(net::OK,
+            OnBeforeHandshake(GURL(kAllowedSocketURL), &answered_right_away));
+  EXPECT_FALSE(answered_right_away);
+
+  EXPECT_EQ(net::ERR_BLOCKED_BY_CLIENT,
+            OnBeforeHandshake(GURL(kBlockedSocketURL), &answered_right_away));
+  EXPECT_TRUE(answered_right_away);
+  EXPECT_EQ(net::OK,
+            OnBeforeHandshake(GURL(kAllowedSocketURL), &answered_right_away));
+  EXPECT_TRUE(answered_right_away);
+
+  histogram_tester.ExpectBucketCount("Brave.WebSocketFilter.DecisionCached",
+                                     false, 2);
+  histogram_tester.ExpectBucketCount("Brave.WebSocketFilter.DecisionCached",
+                                     true, 2);
+}
+
+TEST_F(BraveWebSocketFilterTest, DecisionsAreKeptPerTabHost) {
+  bool answered_right_away = true;
+  OnBeforeHandshake(GURL(kBlockedSocketURL), &answered_right_away);
+  ASSERT_FALSE(answered_right_away);
+
+  auto ctx = MakeContext(GURL(kBlockedSocketURL));
+  ctx->tab_origin = GURL("https://other.example.com/");
+  EXPECT_EQ(net::ERR_BLOCKED_BY_CLIENT,
+            OnBeforeHandshake(ctx, &answered_right_away));
+  EXPECT_FALSE(answered_right_away);
+}
+
+TEST_F(BraveWebSocketFilterTest, DropsDecisionsWhenEngineChanges) {
+  bool answered_right_away = true;
+  EXPECT_EQ(net::ERR_BLOCKED_BY_CLIENT,
+            OnBeforeHandshake(GURL(kBlockedSocketURL), &answered_right_away));
+  ASSERT_FALSE(answered_right_away);
+
+  ResetAdBlockService("||chat.example.com^$websocket");
+  EXPECT_EQ(net::OK,
+            OnBeforeHandshake(GURL(kBlockedSocketURL), &answered_right_away));
+  EXPECT_FALSE(answered_right_away);
+  EXPECT_EQ(net::ERR_BLOCKED_BY_CLIENT,
+            OnBeforeHandshake(GURL(kAllowedSocketURL), &answered_right_away));
+  EXPECT_FALSE(answered_right_away);
+}
+
+TEST_F(BraveWebSocketFilterTest, DropsDecisionsWhenAnyEngineChanges) {
+  bool answered_right_away = true;
+  OnBeforeHandshake(GURL(kBlockedSocketURL), &answered_right_away);
+  ASSERT_FALSE(answered_right_away);
+  OnBeforeHandshake(GURL(kBlockedSocketURL), &answered_right_away);
+  ASSERT_TRUE(answered_right_away);
+
+  // Generations are shared by all ad-block services, so a change to any
+  // regional list or the custom filters invalidates the decision as well.
+  brave_shields::AdBlockBaseService::NextEngineGeneration();
+  EXPECT_EQ(net::ERR_BLOCKED_BY_CLIENT,
+            OnBeforeHandshake(GURL(kBlockedSocketURL), &answered_right_away));
+  EXPECT_FALSE(answered_right_away);
+}
+
+TEST_F(BraveWebSocketFilterTest, SkipsAdBlockWhenShieldsDownOrAdsAllowed) {
+  bool answered_right_away = false;
+  auto ctx = MakeContext(GURL(kBlockedSocketURL));
+  ctx->allow_brave_shields = false;
+  EXPECT_EQ(net::OK, OnBeforeHandshake(ctx, &answered_right_away));
+  EXPECT_TRUE(answered_right_away);
+
+  answered_right_away = false;
+  ctx = MakeContext(GURL(kBlockedSocketURL));
+  ctx->allow_ads = true;
+  EXPECT_EQ(net::OK, OnBeforeHandshake(ctx, &answered_right_away));
+  EXPECT_TRUE(answered_right_away);
+}
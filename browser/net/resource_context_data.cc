@@ -8,9 +8,14 @@
 #include <string>
 #include <utility>
 
+#include "brave/browser/brave_browser_process_impl.h"
 #include "brave/browser/net/brave_proxying_url_loader_factory.h"
 #include "brave/browser/net/brave_proxying_web_socket.h"
 #include "brave/browser/net/brave_request_handler.h"
+#include "brave/browser/net/brave_websocket_filter.h"
+#include "brave/components/brave_shields/browser/ad_block_custom_filters_service.h"
+#include "brave/components/brave_shields/browser/ad_block_regional_service_manager.h"
+#include "brave/components/brave_shields/browser/ad_block_service.h"
 #include "content/public/browser/browser_context.h"
 #include "net/cookies/site_for_cookies.h"
 
@@ -83,6 +88,13 @@ BraveProxyingWebSocket* ResourceContextData::StartProxyingWebSocket(
     self->request_handler_.reset(new BraveRequestHandler);
   }
 
+  if (!self->websocket_filter_) {
+    self->websocket_filter_ = std::make_unique<BraveWebSocketFilter>(
+        g_brave_browser_process->ad_block_service(),
+        g_brave_browser_process->ad_block_regional_service_manager(),
+        g_brave_browser_process->ad_block_custom_filters_service());
+  }
+
   network::ResourceRequest request;
   request.url = url;
   // TODO(iefremov): site_for_cookies is not enough, we should find a way
@@ -98,6 +110,7 @@ BraveProxyingWebSocket* ResourceContextData::StartProxyingWebSocket(
       std::move(factory), request, std::move(handshake_client),
       render_process_id, frame_tree_node_id, browser_context,
       self->request_id_generator_, self->request_handler_.get(),
+      self->websocket_filter_.get(),
       base::BindOnce(&ResourceContextData::RemoveProxyWebSocket,
                      self->weak_factory_.GetWeakPtr()));
 
@@ -23,6 +23,7 @@
 class BraveProxyingURLLoaderFactory;
 class BraveProxyingWebSocket;
 class BraveRequestHandler;
+class BraveWebSocketFilter;
 
 namespace content {
 class BrowserContext;
@@ -82,6 +83,7 @@ class ResourceContextData : public base::SupportsUserData::Data {
   ResourceContextData();
 
   std::unique_ptr<BraveRequestHandler> request_handler_;
+  std::unique_ptr<BraveWebSocketFilter> websocket_filter_;
   scoped_refptr<RequestIDGenerator> request_id_generator_;
 
   std::set<std::unique_ptr<BraveProxyingURLLoaderFactory>,
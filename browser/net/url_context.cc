@@ -8,40 +8,50 @@
 #include <memory>
 #include <string>
 
-#include "brave/components/brave_shields/browser/brave_shields_util.h"
+#include "brave/components/brave_shields/browser/brave_shields_settings_cache.h"
 #include "brave/components/brave_shields/browser/brave_shields_web_contents_observer.h"
 #include "brave/components/brave_webtorrent/browser/buildflags/buildflags.h"
 #include "brave/components/brave_webtorrent/browser/webtorrent_util.h"
 #include "chrome/browser/profiles/profile.h"
 #include "content/public/browser/browser_thread.h"
+#include "services/network/public/cpp/resource_request.h"
+#include "services/network/public/cpp/resource_request_body.h"
 
 namespace brave {
 
-namespace {
+BraveRequestInfo::BraveRequestInfo() = default;
+
+BraveRequestInfo::BraveRequestInfo(const GURL& url) : request_url(url) {}
+
+BraveRequestInfo::~BraveRequestInfo() = default;
 
-std::string GetUploadData(const network::ResourceRequest& request) {
+size_t BraveRequestInfo::GetUploadDataSize() const {
+  if (!request_body) {
+    return 0;
+  }
+  size_t size = 0;
+  for (const network::DataElement& element : *request_body->elements()) {
+    if (element.type() == network::mojom::DataElementType::kBytes) {
+      size += element.length();
+    }
+  }
+  return size;
+}
+
+std::string BraveRequestInfo::GetUploadData() const {
   std::string upload_data;
-  if (!request.request_body) {
-    return {};
+  if (!request_body) {
+    return upload_data;
   }
-  const auto* elements = request.request_body->elements();
-  for (const network::DataElement& element : *elements) {
+  upload_data.reserve(GetUploadDataSize());
+  for (const network::DataElement& element : *request_body->elements()) {
     if (element.type() == network::mojom::DataElementType::kBytes) {
       upload_data.append(element.bytes(), element.length());
     }
   }
-
   return upload_data;
 }
 
-}  // namespace
-
-BraveRequestInfo::BraveRequestInfo() = default;
-
-BraveRequestInfo::BraveRequestInfo(const GURL& url) : request_url(url) {}
-
-BraveRequestInfo::~BraveRequestInfo() = default;
-
 // static
 void BraveRequestInfo::FillCTX(const network::ResourceRequest& request,
                                int render_process_id,
@@ -92,16 +102,15 @@ void BraveRequestInfo::FillCTX(const network::ResourceRequest& request,
                               .GetOrigin();
   }
 
-  Profile* profile = Profile::FromBrowserContext(browser_context);
-  ctx->allow_brave_shields =
-      brave_shields::GetBraveShieldsEnabled(profile, ctx->tab_origin);
-  ctx->allow_ads = brave_shields::GetAdControlType(profile, ctx->tab_origin) ==
-                   brave_shields::ControlType::ALLOW;
-  ctx->allow_http_upgradable_resource =
-      !brave_shields::GetHTTPSEverywhereEnabled(profile, ctx->tab_origin);
-  ctx->allow_referrers =
-      brave_shields::AllowReferrers(profile, ctx->tab_origin);
-  ctx->upload_data = GetUploadData(request);
+  const brave_shields::ShieldsSettings& settings =
+      brave_shields::ShieldsSettingsCache::GetForProfile(
+          Profile::FromBrowserContext(browser_context))
+          ->Get(ctx->tab_origin);
+  ctx->allow_brave_shields = settings.shields_enabled;
+  ctx->allow_ads = settings.allow_ads;
+  ctx->allow_http_upgradable_resource = !settings.https_everywhere_enabled;
+  ctx->allow_referrers = settings.allow_referrers;
+  ctx->request_body = request.request_body;
 }
 
 }  // namespace brave
@@ -10,6 +10,8 @@
 #include <set>
 #include <string>
 
+#include "base/memory/scoped_refptr.h"
+#include "base/time/time.h"
 #include "content/public/common/resource_type.h"
 #include "net/url_request/url_request.h"
 #include "url/gurl.h"
@@ -22,6 +24,7 @@ class BrowserContext;
 
 namespace network {
 struct ResourceRequest;
+class ResourceRequestBody;
 }
 
 namespace brave {
@@ -91,6 +94,9 @@ struct BraveRequestInfo {
   BlockedBy blocked_by = kNotBlocked;
   bool cancel_request_explicitly = false;
   std::string mock_data_url;
+  // AdBlockBaseService::CurrentEngineGeneration() when ad-block decided on
+  // the request, 0 if it didn't.
+  uint64_t ad_block_engine_generation = 0;
 
   // Default to invalid type for resource_type, so delegate helpers
   // can properly detect that the info couldn't be obtained.
@@ -100,7 +106,13 @@ struct BraveRequestInfo {
       static_cast<content::ResourceType>(-1);
   content::ResourceType resource_type = kInvalidResourceType;
 
-  std::string upload_data;
+  // The body is only referenced here, most requests never need a copy of it.
+  scoped_refptr<network::ResourceRequestBody> request_body;
+
+  // Returns the size of the in-memory parts of |request_body|.
+  size_t GetUploadDataSize() const;
+  // Copies the in-memory parts of |request_body|.
+  std::string GetUploadData() const;
 
   static void FillCTX(const network::ResourceRequest& request,
                       int render_process_id,
@@ -115,6 +127,10 @@ struct BraveRequestInfo {
   friend class ::BraveRequestHandler;
 
   GURL* new_url = nullptr;
+  // BraveRequestHandler::RequestTraits of this request.
+  uint32_t request_traits = 0;
+  // When the currently running network delegate helper was invoked.
+  base::TimeTicks stage_start_time;
 
   DISALLOW_COPY_AND_ASSIGN(BraveRequestInfo);
 };
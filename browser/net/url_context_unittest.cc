@@ -0,0 +1,52 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/browser/net/url_context.h"
+
+#include <memory>
+#include <string>
+
+#include "base/files/file_path.h"
+#include "base/time/time.h"
+#include "services/network/public/cpp/resource_request_body.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+TEST(BraveRequestInfoTest, NoUploadData) {
+  auto ctx = std::make_shared<brave::BraveRequestInfo>(
+      GURL("https://brave.com/"));
+
+  EXPECT_EQ(0UL, ctx->GetUploadDataSize());
+  EXPECT_EQ("", ctx->GetUploadData());
+}
+
+TEST(BraveRequestInfoTest, UploadDataSkipsNonBytesElements) {
+  auto ctx = std::make_shared<brave::BraveRequestInfo>(
+      GURL("https://brave.com/"));
+  ctx->request_body = base::MakeRefCounted<network::ResourceRequestBody>();
+  const std::string first_bytes = "first";
+  const std::string second_bytes = "second";
+  ctx->request_body->AppendBytes(first_bytes.data(),
+                                 static_cast<int>(first_bytes.size()));
+  ctx->request_body->AppendFileRange(
+      base::FilePath(FILE_PATH_LITERAL("upload.txt")), 0, 1024, base::Time());
+  ctx->request_body->AppendBytes(second_bytes.data(),
+                                 static_cast<int>(second_bytes.size()));
+
+  EXPECT_EQ(first_bytes.size() + second_bytes.size(),
+            ctx->GetUploadDataSize());
+  EXPECT_EQ("firstsecond", ctx->GetUploadData());
+}
+
+TEST(BraveRequestInfoTest, UploadDataWithoutBytesElements) {
+  auto ctx = std::make_shared<brave::BraveRequestInfo>(
+      GURL("https://brave.com/"));
+  ctx->request_body = base::MakeRefCounted<network::ResourceRequestBody>();
+  ctx->request_body->AppendFileRange(
+      base::FilePath(FILE_PATH_LITERAL("upload.txt")), 0, 1024, base::Time());
+
+  EXPECT_EQ(0UL, ctx->GetUploadDataSize());
+  EXPECT_EQ("", ctx->GetUploadData());
+}
@@ -11,6 +11,7 @@
 #include "brave/components/brave_adblock/resources/grit/brave_adblock_generated_map.h"
 #include "brave/components/brave_shields/browser/ad_block_custom_filters_service.h"
 #include "brave/components/brave_shields/browser/ad_block_regional_service_manager.h"
+#include "brave/components/brave_shields/browser/ad_block_service.h"
 #include "chrome/browser/profiles/profile.h"
 #include "components/grit/brave_components_resources.h"
 #include "components/prefs/pref_change_registrar.h"
@@ -33,6 +34,7 @@ class AdblockDOMHandler : public content::WebUIMessageHandler {
  private:
   void HandleEnableFilterList(const base::ListValue* args);
   void HandleGetCustomFilters(const base::ListValue* args);
+  void HandleGetDecisionCacheStats(const base::ListValue* args);
   void HandleGetRegionalLists(const base::ListValue* args);
   void HandleUpdateCustomFilters(const base::ListValue* args);
 
@@ -52,6 +54,10 @@ void AdblockDOMHandler::RegisterMessages() {
       "brave_adblock.getCustomFilters",
       base::BindRepeating(&AdblockDOMHandler::HandleGetCustomFilters,
                           base::Unretained(this)));
+  web_ui()->RegisterMessageCallback(
+      "brave_adblock.getDecisionCacheStats",
+      base::BindRepeating(&AdblockDOMHandler::HandleGetDecisionCacheStats,
+                          base::Unretained(this)));
   web_ui()->RegisterMessageCallback(
       "brave_adblock.getRegionalLists",
       base::BindRepeating(&AdblockDOMHandler::HandleGetRegionalLists,
@@ -85,6 +91,32 @@ void AdblockDOMHandler::HandleGetCustomFilters(const base::ListValue* args) {
                                          base::Value(custom_filters));
 }
 
+void AdblockDOMHandler::HandleGetDecisionCacheStats(
+    const base::ListValue* args) {
+  DCHECK_EQ(args->GetSize(), 0U);
+  if (!web_ui()->CanCallJavascript())
+    return;
+  const brave_shields::AdBlockDecisionCache::Stats default_stats =
+      g_brave_browser_process->ad_block_service()->GetDecisionCacheStats();
+  const brave_shields::AdBlockDecisionCache::Stats regional_stats =
+      g_brave_browser_process->ad_block_regional_service_manager()
+          ->GetDecisionCacheStats();
+  const brave_shields::AdBlockDecisionCache::Stats custom_stats =
+      g_brave_browser_process->ad_block_custom_filters_service()
+          ->GetDecisionCacheStats();
+  // base::Value has no 64-bit integers, doubles are exact well past any
+  // count reachable here.
+  base::Value stats(base::Value::Type::DICTIONARY);
+  stats.SetDoubleKey("hits", static_cast<double>(default_stats.hits +
+                                                  regional_stats.hits +
+                                                  custom_stats.hits));
+  stats.SetDoubleKey("misses", static_cast<double>(default_stats.misses +
+                                                    regional_stats.misses +
+                                                    custom_stats.misses));
+  web_ui()->CallJavascriptFunctionUnsafe(
+      "brave_adblock.onGetDecisionCacheStats", stats);
+}
+
 void AdblockDOMHandler::HandleGetRegionalLists(const base::ListValue* args) {
   DCHECK_EQ(args->GetSize(), 0U);
   if (!web_ui()->CanCallJavascript())
@@ -5,83 +5,103 @@
 
 #include "brave/common/shield_exceptions.h"
 
-#include <algorithm>
-#include <map>
+#include <memory>
 #include <vector>
 
+#include "base/no_destructor.h"
+#include "brave/common/static_url_pattern_matcher.h"
 #include "extensions/common/url_pattern.h"
 #include "url/gurl.h"
 
 namespace brave {
 
+namespace {
+
+using MatchType = StaticURLPatternMatcher::MatchType;
+
+struct FingerprintingException {
+  StaticURLPatternMatcher::Entry first_party;
+  std::vector<StaticURLPatternMatcher::Entry> subresources;
+};
+
+}  // namespace
+
 bool IsUAWhitelisted(const GURL& gurl) {
-  static std::vector<URLPattern> whitelist_patterns({
-    URLPattern(URLPattern::SCHEME_ALL, "https://*.adobe.com/*"),
-    URLPattern(URLPattern::SCHEME_ALL, "https://*.duckduckgo.com/*"),
-    URLPattern(URLPattern::SCHEME_ALL, "https://*.brave.com/*"),
-    // For Widevine
-    URLPattern(URLPattern::SCHEME_ALL, "https://*.netflix.com/*")
-  });
-  return std::any_of(whitelist_patterns.begin(), whitelist_patterns.end(),
-      [&gurl](URLPattern pattern){
-        return pattern.MatchesURL(gurl);
-      });
+  static const base::NoDestructor<StaticURLPatternMatcher> whitelist(
+      std::vector<StaticURLPatternMatcher::Entry>{
+          {URLPattern::SCHEME_ALL, "https://*.adobe.com/*", MatchType::kURL},
+          {URLPattern::SCHEME_ALL, "https://*.duckduckgo.com/*",
+           MatchType::kURL},
+          {URLPattern::SCHEME_ALL, "https://*.brave.com/*", MatchType::kURL},
+          // For Widevine
+          {URLPattern::SCHEME_ALL, "https://*.netflix.com/*",
+           MatchType::kURL}});
+  return whitelist->Match(gurl) != StaticURLPatternMatcher::kNoMatch;
 }
 
 bool IsBlockedResource(const GURL& gurl) {
-  static std::vector<URLPattern> blocked_patterns({
-      URLPattern(URLPattern::SCHEME_ALL, "https://pdfjs.robwu.nl/*")
-  });
-  return std::any_of(blocked_patterns.begin(), blocked_patterns.end(),
-                     [&gurl](URLPattern pattern){
-                       return pattern.MatchesURL(gurl);
-                     });
+  static const base::NoDestructor<StaticURLPatternMatcher> blocked(
+      std::vector<StaticURLPatternMatcher::Entry>{
+          {URLPattern::SCHEME_ALL, "https://pdfjs.robwu.nl/*",
+           MatchType::kURL}});
+  return blocked->Match(gurl) != StaticURLPatternMatcher::kNoMatch;
 }
 
 bool IsWhitelistedFingerprintingException(const GURL& firstPartyOrigin,
     const GURL& subresourceUrl) {
   // Always allow embeds from public.tableau.com while fingerprinting
   // protections are being reworked to need less exceptions.
-  static const std::vector<URLPattern> embed_exceptions = {
-    URLPattern(URLPattern::SCHEME_ALL, "https://public.tableau.com/*"),
-    URLPattern(URLPattern::SCHEME_ALL, "https://www.arcgis.com/*"),
-  };
-  for (const auto exception : embed_exceptions) {
-    if (exception.MatchesURL(subresourceUrl)) {
-      return true;
-    }
+  static const base::NoDestructor<StaticURLPatternMatcher> embed_exceptions(
+      std::vector<StaticURLPatternMatcher::Entry>{
+          {URLPattern::SCHEME_ALL, "https://public.tableau.com/*",
+           MatchType::kURL},
+          {URLPattern::SCHEME_ALL, "https://www.arcgis.com/*",
+           MatchType::kURL}});
+  if (embed_exceptions->Match(subresourceUrl) !=
+      StaticURLPatternMatcher::kNoMatch) {
+    return true;
   }
 
-  static std::map<URLPattern, std::vector<URLPattern> > whitelist_patterns = {
-    {
-      URLPattern(URLPattern::SCHEME_ALL, "https://uphold.com/"),
-      std::vector<URLPattern>({
-        URLPattern(URLPattern::SCHEME_ALL, "https://uphold.netverify.com/*"),
-        URLPattern(URLPattern::SCHEME_ALL, "https://*.veriff.me/*"),
-      })
-    },
-    {
-      URLPattern(URLPattern::SCHEME_ALL, "https://sandbox.uphold.com/"),
-      std::vector<URLPattern>({
-        URLPattern(URLPattern::SCHEME_ALL, "https://*.netverify.com/*"),
-        URLPattern(URLPattern::SCHEME_ALL, "https://*.veriff.me/*"),
-      })
-    },
-    {
-      URLPattern(URLPattern::SCHEME_ALL, "https://*.1password.com/*"),
-      std::vector<URLPattern>({URLPattern(URLPattern::SCHEME_ALL,
-            "https://map.1passwordservices.com/*")})
-    }
-  };
-  for (const auto whitelist : whitelist_patterns) {
-      if (whitelist.first.MatchesURL(firstPartyOrigin)) {
-          return std::any_of(whitelist.second.begin(), whitelist.second.end(),
-            [&subresourceUrl](const URLPattern& pattern) {
-              return pattern.MatchesURL(subresourceUrl);
-          });
-      }
-  }
-  return false;
+  static const base::NoDestructor<std::vector<FingerprintingException>>
+      exceptions(std::vector<FingerprintingException>{
+          {{URLPattern::SCHEME_ALL, "https://uphold.com/", MatchType::kURL},
+           {{URLPattern::SCHEME_ALL, "https://uphold.netverify.com/*",
+             MatchType::kURL},
+            {URLPattern::SCHEME_ALL, "https://*.veriff.me/*",
+             MatchType::kURL}}},
+          {{URLPattern::SCHEME_ALL, "https://sandbox.uphold.com/",
+            MatchType::kURL},
+           {{URLPattern::SCHEME_ALL, "https://*.netverify.com/*",
+             MatchType::kURL},
+            {URLPattern::SCHEME_ALL, "https://*.veriff.me/*",
+             MatchType::kURL}}},
+          {{URLPattern::SCHEME_ALL, "https://*.1password.com/*",
+            MatchType::kURL},
+           {{URLPattern::SCHEME_ALL, "https://map.1passwordservices.com/*",
+             MatchType::kURL}}}});
+  static const base::NoDestructor<StaticURLPatternMatcher> first_parties([] {
+    std::vector<StaticURLPatternMatcher::Entry> entries;
+    for (const auto& exception : *exceptions)
+      entries.push_back(exception.first_party);
+    return entries;
+  }());
+  static const base::NoDestructor<
+      std::vector<std::unique_ptr<StaticURLPatternMatcher>>>
+      subresources([] {
+        std::vector<std::unique_ptr<StaticURLPatternMatcher>> matchers;
+        for (const auto& exception : *exceptions) {
+          matchers.push_back(std::make_unique<StaticURLPatternMatcher>(
+              exception.subresources));
+        }
+        return matchers;
+      }());
+
+  // The first parties don't overlap, at most one entry applies.
+  const int index = first_parties->Match(firstPartyOrigin);
+  if (index == StaticURLPatternMatcher::kNoMatch)
+    return false;
+  return (*subresources)[index]->Match(subresourceUrl) !=
+         StaticURLPatternMatcher::kNoMatch;
 }
 
 }  // namespace brave
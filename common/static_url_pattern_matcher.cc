@@ -0,0 +1,86 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/common/static_url_pattern_matcher.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/logging.h"
+#include "base/strings/string_piece.h"
+#include "url/gurl.h"
+
+namespace brave {
+
+namespace {
+
+void AppendIndexes(
+    const std::unordered_map<std::string, std::vector<size_t>>& map,
+    base::StringPiece host,
+    std::vector<size_t>* indexes) {
+  auto it = map.find(host.as_string());
+  if (it != map.end())
+    indexes->insert(indexes->end(), it->second.begin(), it->second.end());
+}
+
+}  // namespace
+
+StaticURLPatternMatcher::StaticURLPatternMatcher(
+    const std::vector<Entry>& entries) {
+  patterns_.reserve(entries.size());
+  match_types_.reserve(entries.size());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    URLPattern pattern(entries[i].valid_schemes);
+    const URLPattern::ParseResult result = pattern.Parse(entries[i].pattern);
+    DCHECK_EQ(URLPattern::ParseResult::kSuccess, result)
+        << entries[i].pattern;
+
+    if (pattern.host().empty())
+      any_host_patterns_.push_back(i);
+    else if (pattern.match_subdomains())
+      domain_patterns_[pattern.host()].push_back(i);
+    else
+      host_patterns_[pattern.host()].push_back(i);
+
+    patterns_.push_back(std::move(pattern));
+    match_types_.push_back(entries[i].match_type);
+  }
+}
+
+StaticURLPatternMatcher::~StaticURLPatternMatcher() = default;
+
+int StaticURLPatternMatcher::Match(const GURL& url) const {
+  // URLPattern ignores a trailing dot in the host, so does the lookup.
+  base::StringPiece host = url.host_piece();
+  if (!host.empty() && host.back() == '.')
+    host.remove_suffix(1);
+
+  std::vector<size_t> candidates(any_host_patterns_);
+  AppendIndexes(host_patterns_, host, &candidates);
+  // The host itself and every parent domain.
+  for (base::StringPiece domain = host;
+       !domain.empty() && !domain_patterns_.empty();) {
+    AppendIndexes(domain_patterns_, domain, &candidates);
+    const size_t dot = domain.find('.');
+    if (dot == base::StringPiece::npos)
+      break;
+    domain.remove_prefix(dot + 1);
+  }
+  std::sort(candidates.begin(), candidates.end());
+
+  for (size_t index : candidates) {
+    if (Matches(index, url))
+      return static_cast<int>(index);
+  }
+  return kNoMatch;
+}
+
+bool StaticURLPatternMatcher::Matches(size_t index, const GURL& url) const {
+  if (match_types_[index] == MatchType::kHost)
+    return patterns_[index].MatchesHost(url);
+  return patterns_[index].MatchesURL(url);
+}
+
+}  // namespace brave
@@ -0,0 +1,66 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMMON_STATIC_URL_PATTERN_MATCHER_H_
+#define BRAVE_COMMON_STATIC_URL_PATTERN_MATCHER_H_
+
+#include <stddef.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/macros.h"
+#include "extensions/common/url_pattern.h"
+
+class GURL;
+
+namespace brave {
+
+// Matches URLs against a fixed list of URLPatterns with a single host
+// lookup instead of testing every pattern in turn. Patterns are indexed by
+// host, so only the few sharing a host (or a parent domain, for *.host
+// patterns) with the URL are actually evaluated, in the order they were
+// added. The result is the same as calling MatchesURL (or MatchesHost) on
+// each pattern and stopping at the first one that matches.
+class StaticURLPatternMatcher {
+ public:
+  static constexpr int kNoMatch = -1;
+
+  // Either the whole URL is tested, or only its host as URLPattern's
+  // MatchesHost does.
+  enum class MatchType { kURL, kHost };
+
+  struct Entry {
+    int valid_schemes;
+    std::string pattern;
+    MatchType match_type;
+  };
+
+  explicit StaticURLPatternMatcher(const std::vector<Entry>& entries);
+  ~StaticURLPatternMatcher();
+
+  // Returns the index in |entries| of the first pattern matching |url|, or
+  // kNoMatch.
+  int Match(const GURL& url) const;
+
+ private:
+  bool Matches(size_t index, const GURL& url) const;
+
+  std::vector<URLPattern> patterns_;
+  std::vector<MatchType> match_types_;
+  // Patterns for exactly one host, and patterns also matching subdomains,
+  // keyed by host. Indexes in each list are ascending.
+  std::unordered_map<std::string, std::vector<size_t>> host_patterns_;
+  std::unordered_map<std::string, std::vector<size_t>> domain_patterns_;
+  // Patterns without a host that have to be evaluated for every URL.
+  std::vector<size_t> any_host_patterns_;
+
+  DISALLOW_COPY_AND_ASSIGN(StaticURLPatternMatcher);
+};
+
+}  // namespace brave
+
+#endif  // BRAVE_COMMON_STATIC_URL_PATTERN_MATCHER_H_
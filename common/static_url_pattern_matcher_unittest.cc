@@ -0,0 +1,106 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/common/static_url_pattern_matcher.h"
+
+#include <vector>
+
+#include "brave/common/network_constants.h"
+#include "extensions/common/url_pattern.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace brave {
+
+namespace {
+
+using MatchType = StaticURLPatternMatcher::MatchType;
+
+constexpr int kHttpOrHttps = URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS;
+
+// What the matcher replaces: test every pattern in order.
+int MatchLinearly(const std::vector<StaticURLPatternMatcher::Entry>& entries,
+                  const GURL& url) {
+  for (size_t i = 0; i < entries.size(); ++i) {
+    URLPattern pattern(entries[i].valid_schemes, entries[i].pattern);
+    const bool matches = entries[i].match_type == MatchType::kHost
+                             ? pattern.MatchesHost(url)
+                             : pattern.MatchesURL(url);
+    if (matches)
+      return static_cast<int>(i);
+  }
+  return StaticURLPatternMatcher::kNoMatch;
+}
+
+}  // namespace
+
+TEST(StaticURLPatternMatcherTest, ParityWithURLPattern) {
+  const std::vector<StaticURLPatternMatcher::Entry> entries = {
+      {URLPattern::SCHEME_HTTPS, kGeoLocationsPattern, MatchType::kURL},
+      {URLPattern::SCHEME_HTTPS, kSafeBrowsingPrefix, MatchType::kHost},
+      {kHttpOrHttps, kCRXDownloadPrefix, MatchType::kURL},
+      {URLPattern::SCHEME_HTTPS, kAutofillPrefix, MatchType::kURL},
+      {kHttpOrHttps, kCRLSetPrefix1, MatchType::kURL},
+      {kHttpOrHttps, kCRLSetPrefix2, MatchType::kURL},
+      {kHttpOrHttps, kCRLSetPrefix3, MatchType::kURL},
+      {kHttpOrHttps, kCRLSetPrefix4, MatchType::kURL},
+      {kHttpOrHttps, "*://*.gvt1.com/*", MatchType::kURL},
+      {kHttpOrHttps, "*://dl.google.com/*", MatchType::kURL},
+      {kHttpOrHttps, kClients4Prefix, MatchType::kHost},
+      {URLPattern::SCHEME_ALL, "https://*.brave.com/*", MatchType::kURL},
+      {URLPattern::SCHEME_ALL, "https://uphold.com/", MatchType::kURL},
+      {URLPattern::SCHEME_HTTP, "http://*/catch-all/*", MatchType::kURL},
+  };
+  const StaticURLPatternMatcher matcher(entries);
+
+  const char* const kURLs[] = {
+      "https://www.googleapis.com/geolocation/v1/geolocate?key=2_3_5_7",
+      "http://www.googleapis.com/geolocation/v1/geolocate",
+      "https://safebrowsing.googleapis.com/v4/threatListUpdates",
+      "http://safebrowsing.googleapis.com/anything",
+      "https://clients2.googleusercontent.com/crx/blobs/abc/extension.crx",
+      "https://www.gstatic.com/autofill/hash",
+      "https://www.gstatic.com/other",
+      "https://dl.google.com/release2/chrome_component/crl-set.crx3",
+      "https://r2---sn-8xgp1vo-qxoe.gvt1.com/edgedl/release2/crl-set.crx3",
+      "https://redirector.gvt1.com/edgedl/release2/chrome_component/x.crx3",
+      "http://gvt1.com/",
+      "https://gvt1.com.evil.com/",
+      "https://dl.google.com./trailing/dot",
+      "https://clients4.google.com/chrome-sync/dev",
+      "ftp://clients4.google.com/",
+      "https://brave.com/",
+      "https://www.brave.com/path",
+      "https://notbrave.com/",
+      "http://www.brave.com/",
+      "https://uphold.com/",
+      "https://uphold.com/other",
+      "http://127.0.0.1/catch-all/x",
+      "http://example.com/catch-all/",
+      "https://example.com/catch-all/",
+      "file:///etc/passwd",
+      "about:blank",
+      "",
+  };
+  for (const char* url : kURLs) {
+    EXPECT_EQ(MatchLinearly(entries, GURL(url)), matcher.Match(GURL(url)))
+        << url;
+  }
+}
+
+TEST(StaticURLPatternMatcherTest, FirstMatchingEntryWins) {
+  const StaticURLPatternMatcher matcher({
+      {URLPattern::SCHEME_HTTPS, "https://*.example.com/*", MatchType::kURL},
+      {URLPattern::SCHEME_HTTPS, "https://www.example.com/*", MatchType::kURL},
+      {URLPattern::SCHEME_HTTPS, "https://*/*", MatchType::kURL},
+  });
+  EXPECT_EQ(0, matcher.Match(GURL("https://www.example.com/")));
+  EXPECT_EQ(0, matcher.Match(GURL("https://example.com/")));
+  EXPECT_EQ(2, matcher.Match(GURL("https://brave.com/")));
+  EXPECT_EQ(StaticURLPatternMatcher::kNoMatch,
+            matcher.Match(GURL("http://brave.com/")));
+}
+
+}  // namespace brave
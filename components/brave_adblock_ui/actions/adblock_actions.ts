@@ -15,6 +15,9 @@ export const enableFilterList = (uuid: string, enabled: boolean) =>
 
 export const getCustomFilters = () => action(types.ADBLOCK_GET_CUSTOM_FILTERS)
 
+export const getDecisionCacheStats = () =>
+  action(types.ADBLOCK_GET_DECISION_CACHE_STATS)
+
 export const getRegionalLists = () => action(types.ADBLOCK_GET_REGIONAL_LISTS)
 
 export const onGetCustomFilters = (customFilters: string) =>
@@ -22,6 +25,11 @@ export const onGetCustomFilters = (customFilters: string) =>
     customFilters
   })
 
+export const onGetDecisionCacheStats = (decisionCacheStats: AdBlock.DecisionCacheStats) =>
+  action(types.ADBLOCK_ON_GET_DECISION_CACHE_STATS, {
+    decisionCacheStats
+  })
+
 export const onGetRegionalLists = (regionalLists: AdBlock.FilterList[]) =>
   action(types.ADBLOCK_ON_GET_REGIONAL_LISTS, {
     regionalLists
@@ -22,6 +22,11 @@ window.cr.define('brave_adblock', function () {
     actions.getCustomFilters()
   }
 
+  function getDecisionCacheStats () {
+    const actions = bindActionCreators(adblockActions, store.dispatch.bind(store))
+    actions.getDecisionCacheStats()
+  }
+
   function getRegionalLists () {
     const actions = bindActionCreators(adblockActions, store.dispatch.bind(store))
     actions.getRegionalLists()
@@ -30,6 +35,7 @@ window.cr.define('brave_adblock', function () {
   function initialize () {
     getCustomFilters()
     getRegionalLists()
+    getDecisionCacheStats()
     render(
       <Provider store={store}>
         <App />
@@ -43,6 +49,11 @@ window.cr.define('brave_adblock', function () {
     actions.onGetCustomFilters(customFilters)
   }
 
+  function onGetDecisionCacheStats (decisionCacheStats: AdBlock.DecisionCacheStats) {
+    const actions = bindActionCreators(adblockActions, store.dispatch.bind(store))
+    actions.onGetDecisionCacheStats(decisionCacheStats)
+  }
+
   function onGetRegionalLists (regionalLists: AdBlock.FilterList[]) {
     const actions = bindActionCreators(adblockActions, store.dispatch.bind(store))
     actions.onGetRegionalLists(regionalLists)
@@ -56,6 +67,7 @@ window.cr.define('brave_adblock', function () {
   return {
     initialize,
     onGetCustomFilters,
+    onGetDecisionCacheStats,
     onGetRegionalLists,
     statsUpdated
   }
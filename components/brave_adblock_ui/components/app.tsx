@@ -9,6 +9,7 @@ import { connect } from 'react-redux'
 // Components
 import { AdBlockItemList } from './adBlockItemList'
 import { CustomFilters } from './customFilters'
+import { DecisionCacheStat } from './decisionCacheStat'
 import { NumBlockedStat } from './numBlockedStat'
 
 // Utils
@@ -33,6 +34,7 @@ export class AdblockPage extends React.Component<Props, {}> {
     return (
       <div id='adblockPage'>
         <NumBlockedStat adsBlockedStat={adblockData.stats.adsBlockedStat || 0} />
+        <DecisionCacheStat decisionCacheStats={adblockData.stats.decisionCacheStats} />
         <AdBlockItemList
           actions={actions}
           resources={adblockData.settings.regionalLists}
@@ -0,0 +1,22 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+import * as React from 'react'
+
+interface Props {
+  decisionCacheStats?: AdBlock.DecisionCacheStats
+}
+
+const getHitRate = (stats?: AdBlock.DecisionCacheStats) => {
+  if (!stats || stats.hits + stats.misses === 0) {
+    return 0
+  }
+  return Math.round(100 * stats.hits / (stats.hits + stats.misses))
+}
+
+export const DecisionCacheStat = (props: Props) => (
+  <div>
+    <span i18n-content='decisionCacheHitRate'/> {getHitRate(props.decisionCacheStats)}%
+  </div>
+)
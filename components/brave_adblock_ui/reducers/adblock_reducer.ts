@@ -37,17 +37,24 @@ const adblockReducer: Reducer<AdBlock.State | undefined> = (state: AdBlock.State
     case types.ADBLOCK_GET_CUSTOM_FILTERS:
       chrome.send('brave_adblock.getCustomFilters')
       break
+    case types.ADBLOCK_GET_DECISION_CACHE_STATS:
+      chrome.send('brave_adblock.getDecisionCacheStats')
+      break
     case types.ADBLOCK_GET_REGIONAL_LISTS:
       chrome.send('brave_adblock.getRegionalLists')
       break
     case types.ADBLOCK_ON_GET_CUSTOM_FILTERS:
       state = { ...state, settings: { ...state.settings, customFilters: action.payload.customFilters } }
       break
+    case types.ADBLOCK_ON_GET_DECISION_CACHE_STATS:
+      state = { ...state, stats: { ...state.stats, decisionCacheStats: action.payload.decisionCacheStats } }
+      break
     case types.ADBLOCK_ON_GET_REGIONAL_LISTS:
       state = { ...state, settings: { ...state.settings, regionalLists: action.payload.regionalLists } }
       break
     case types.ADBLOCK_STATS_UPDATED:
       state = storage.getLoadTimeData(state)
+      chrome.send('brave_adblock.getDecisionCacheStats')
       break
     case types.ADBLOCK_UPDATE_CUSTOM_FILTERS:
       state = { ...state, settings: { ...state.settings, customFilters: action.payload.customFilters } }
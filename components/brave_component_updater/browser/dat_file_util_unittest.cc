@@ -0,0 +1,76 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_component_updater/browser/dat_file_util.h"
+
+#include <memory>
+#include <string>
+
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace brave_component_updater {
+
+namespace {
+
+class FakeDATClient {
+ public:
+  bool deserialize(char* data, size_t data_size) {
+    data_.assign(data, data_size);
+    return data_ != "corrupted";
+  }
+
+  const std::string& data() const { return data_; }
+
+ private:
+  std::string data_;
+};
+
+class DATFileUtilTest : public testing::Test {
+ public:
+  DATFileUtilTest() {}
+  ~DATFileUtilTest() override {}
+
+  void SetUp() override { ASSERT_TRUE(temp_dir_.CreateUniqueTempDir()); }
+
+ protected:
+  base::FilePath WriteDATFile(const std::string& contents) {
+    base::FilePath path = temp_dir_.GetPath().AppendASCII("test.dat");
+    EXPECT_EQ(static_cast<int>(contents.size()),
+              base::WriteFile(path, contents.data(), contents.size()));
+    return path;
+  }
+
+  base::ScopedTempDir temp_dir_;
+};
+
+}  // namespace
+
+TEST_F(DATFileUtilTest, LoadMappedDATFileData) {
+  auto client =
+      LoadMappedDATFileData<FakeDATClient>(WriteDATFile("serialized"));
+  ASSERT_TRUE(client);
+  EXPECT_EQ("serialized", client->data());
+}
+
+TEST_F(DATFileUtilTest, LoadMappedDATFileDataMatchesBufferedLoad) {
+  const base::FilePath path = WriteDATFile(std::string(64 * 1024, 'x'));
+  auto mapped = LoadMappedDATFileData<FakeDATClient>(path);
+  auto buffered = LoadDATFileData<FakeDATClient>(path);
+  ASSERT_TRUE(mapped);
+  ASSERT_TRUE(buffered.first);
+  EXPECT_EQ(buffered.first->data(), mapped->data());
+}
+
+TEST_F(DATFileUtilTest, LoadMappedDATFileDataFailures) {
+  EXPECT_FALSE(LoadMappedDATFileData<FakeDATClient>(
+      temp_dir_.GetPath().AppendASCII("missing.dat")));
+  EXPECT_FALSE(LoadMappedDATFileData<FakeDATClient>(WriteDATFile("")));
+  EXPECT_FALSE(
+      LoadMappedDATFileData<FakeDATClient>(WriteDATFile("corrupted")));
+}
+
+}  // namespace brave_component_updater
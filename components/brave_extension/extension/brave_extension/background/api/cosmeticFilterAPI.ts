@@ -17,9 +17,10 @@ const informTabOfCosmeticRulesToConsider = (tabId: number, selectors: string[])
   }
 }
 
-// Fires when content-script calls hiddenClassIdSelectors
-export const injectClassIdStylesheet = (tabId: number, classes: string[], ids: string[], exceptions: string[]) => {
-  chrome.braveShields.hiddenClassIdSelectors(classes, ids, exceptions, (selectors, forceHideSelectors) => {
+// Fires when content-script calls hiddenClassIdSelectors. Only classes and ids
+// new to |sessionId| are evaluated and only selectors new to it are returned.
+export const injectClassIdStylesheet = (tabId: number, sessionId: string, classes: string[], ids: string[], exceptions: string[]) => {
+  chrome.braveShields.hiddenClassIdSelectors(`${tabId}:${sessionId}`, classes, ids, exceptions, (selectors, forceHideSelectors) => {
     informTabOfCosmeticRulesToConsider(tabId, selectors)
 
     if (forceHideSelectors.length > 0) {
@@ -36,12 +37,14 @@ export const injectClassIdStylesheet = (tabId: number, classes: string[], ids: s
 
 // Fires on content-script loaded
 export const applyAdblockCosmeticFilters = (tabId: number, hostname: string) => {
-  chrome.braveShields.hostnameCosmeticResources(hostname, async (resources) => {
+  chrome.braveShields.hostnameCosmeticResources(hostname, async (resourcesJSON) => {
     if (chrome.runtime.lastError) {
       console.warn('Unable to get cosmetic filter data for the current host', chrome.runtime.lastError)
       return
     }
 
+    const resources: chrome.braveShields.HostnameSpecificResources = JSON.parse(resourcesJSON)
+
     informTabOfCosmeticRulesToConsider(tabId, resources.hide_selectors)
 
     let styledStylesheet = ''
@@ -59,7 +59,7 @@ chrome.runtime.onMessage.addListener((msg, sender, sendResponse) => {
       if (tabId === undefined) {
         break
       }
-      shieldsPanelActions.generateClassIdStylesheet(tabId, msg.classes, msg.ids)
+      shieldsPanelActions.generateClassIdStylesheet(tabId, msg.sessionId, msg.classes, msg.ids)
       break
     }
     case 'contentScriptsLoaded': {
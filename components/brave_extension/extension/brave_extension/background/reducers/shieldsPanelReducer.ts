@@ -365,7 +365,7 @@ export default function shieldsPanelReducer (
 
       // setTimeout is used to prevent injectClassIdStylesheet from calling
       // another Redux function immediately
-      setTimeout(() => injectClassIdStylesheet(action.tabId, action.classes, action.ids, exceptions), 0)
+      setTimeout(() => injectClassIdStylesheet(action.tabId, action.sessionId, action.classes, action.ids, exceptions), 0)
       break
     }
     case shieldsPanelTypes.COSMETIC_FILTER_RULE_EXCEPTIONS: {
@@ -29,6 +29,10 @@ const minAdTextWords = 5
 const queriedIds = new Set<string>()
 const queriedClasses = new Set<string>()
 
+// Lets the browser remember which classes and ids this document already
+// sent, so that only new ones are sent and only new selectors come back.
+const cosmeticSessionId = Math.random().toString(36).slice(2) + Date.now().toString(36)
+
 // Each of these get setup once the mutation observer starts running.
 let notYetQueriedClasses: string[]
 let notYetQueriedIds: string[]
@@ -105,6 +109,7 @@ const fetchNewClassIdRules = function () {
   }
   chrome.runtime.sendMessage({
     type: 'hiddenClassIdSelectors',
+    sessionId: cosmeticSessionId,
     classes: notYetQueriedClasses || [],
     ids: notYetQueriedIds || []
   })
@@ -8,6 +8,7 @@
 #include <memory>
 #include <string>
 
+#include "base/metrics/histogram_macros.h"
 #include "base/task/post_task.h"
 #include "brave/components/brave_rewards/browser/rewards_service.h"
 #include "brave/browser/brave_rewards/rewards_service_factory.h"
@@ -76,16 +77,24 @@ int OnBeforeURLRequest(
   std::shared_ptr<brave::BraveRequestInfo> ctx) {
   DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
 
-  if (IsMediaLink(ctx->request_url, ctx->tab_origin, ctx->referrer)) {
-    if (!ctx->upload_data.empty()) {
-      DispatchOnUI(ctx->upload_data,
-                   ctx->request_url,
-                   ctx->tab_url,
-                   ctx->referrer.spec(),
-                   ctx->render_process_id,
-                   ctx->render_frame_id,
-                   ctx->frame_tree_node_id);
+  if (!IsMediaLink(ctx->request_url, ctx->tab_origin, ctx->referrer)) {
+    const size_t upload_data_size = ctx->GetUploadDataSize();
+    if (upload_data_size > 0) {
+      UMA_HISTOGRAM_COUNTS_10M("Brave.Rewards.UploadDataBytesNotCopied",
+                               upload_data_size);
     }
+    return net::OK;
+  }
+
+  const std::string upload_data = ctx->GetUploadData();
+  if (!upload_data.empty()) {
+    DispatchOnUI(upload_data,
+                 ctx->request_url,
+                 ctx->tab_url,
+                 ctx->referrer.spec(),
+                 ctx->render_process_id,
+                 ctx->render_frame_id,
+                 ctx->frame_tree_node_id);
   }
 
   return net::OK;
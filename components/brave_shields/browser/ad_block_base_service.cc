@@ -6,6 +6,7 @@
 #include "brave/components/brave_shields/browser/ad_block_base_service.h"
 
 #include <algorithm>
+#include <atomic>
 #include <string>
 #include <utility>
 #include <vector>
@@ -15,106 +16,150 @@
 #include "base/json/json_reader.h"
 #include "base/macros.h"
 #include "base/memory/ptr_util.h"
+#include "base/memory/ref_counted.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/synchronization/lock.h"
 #include "base/task/post_task.h"
 #include "brave/browser/net/url_context.h"
 #include "brave/common/pref_names.h"
 #include "brave/components/brave_component_updater/browser/dat_file_util.h"
+#include "brave/components/brave_shields/browser/ad_block_request.h"
 #include "brave/components/brave_shields/common/brave_shield_constants.h"
 #include "brave/vendor/adblock_rust_ffi/src/wrapper.hpp"
 #include "components/prefs/pref_service.h"
 #include "content/public/browser/browser_task_traits.h"
 #include "content/public/browser/browser_thread.h"
-#include "net/base/registry_controlled_domains/registry_controlled_domain.h"
-#include "url/origin.h"
 
 using brave_component_updater::BraveComponent;
 using content::BrowserThread;
-using namespace net::registry_controlled_domains;  // NOLINT
 
 namespace {
 
-std::string ResourceTypeToString(content::ResourceType resource_type) {
-  std::string filter_option = "";
-  switch (resource_type) {
-    // top level page
-    case content::ResourceType::kMainFrame:
-      filter_option = "main_frame";
-      break;
-    // frame or iframe
-    case content::ResourceType::kSubFrame:
-      filter_option = "sub_frame";
-      break;
-    // a CSS stylesheet
-    case content::ResourceType::kStylesheet:
-      filter_option = "stylesheet";
-      break;
-    // an external script
-    case content::ResourceType::kScript:
-      filter_option = "script";
-      break;
-    // an image (jpg/gif/png/etc)
-    case content::ResourceType::kFavicon:
-    case content::ResourceType::kImage:
-      filter_option = "image";
-      break;
-    // a font
-    case content::ResourceType::kFontResource:
-      filter_option = "font";
-      break;
-    // an "other" subresource.
-    case content::ResourceType::kSubResource:
-      filter_option = "other";
-      break;
-    // an object (or embed) tag for a plugin.
-    case content::ResourceType::kObject:
-      filter_option = "object";
-      break;
-    // a media resource.
-    case content::ResourceType::kMedia:
-      filter_option = "media";
-      break;
-    // a XMLHttpRequest
-    case content::ResourceType::kXhr:
-      filter_option = "xhr";
-      break;
-    // a ping request for <a ping>/sendBeacon.
-    case content::ResourceType::kPing:
-      filter_option = "ping";
-      break;
-    // the main resource of a dedicated worker.
-    case content::ResourceType::kWorker:
-    // the main resource of a shared worker.
-    case content::ResourceType::kSharedWorker:
-    // an explicitly requested prefetch
-    case content::ResourceType::kPrefetch:
-    // the main resource of a service worker.
-    case content::ResourceType::kServiceWorker:
-    // a report of Content Security Policy violations.
-    case content::ResourceType::kCspReport:
-    // a resource that a plugin requested.
-    case content::ResourceType::kPluginResource:
-    default:
-      break;
+// Loads the engine from |dat_file_path| unless |ad_block_client| is given,
+// then moves it from |previous_tags| to |tags| and installs |resources|.
+// Runs on a worker so none of this blocks request matching.
+std::unique_ptr<adblock::Engine> CreateAdBlockClient(
+    const base::FilePath& dat_file_path,
+    std::unique_ptr<adblock::Engine> ad_block_client,
+    const std::vector<std::string>& previous_tags,
+    const std::vector<std::string>& tags,
+    const std::string& resources) {
+  if (!ad_block_client) {
+    ad_block_client =
+        brave_component_updater::LoadMappedDATFileData<adblock::Engine>(
+            dat_file_path);
+    if (!ad_block_client)
+      return nullptr;
   }
-  return filter_option;
+  for (const auto& tag : previous_tags)
+    ad_block_client->removeTag(tag);
+  for (const auto& tag : tags)
+    ad_block_client->addTag(tag);
+  ad_block_client->addResources(resources);
+  return ad_block_client;
+}
+
+// Builds the engine on a worker like above and hands it to |reply| on the UI
+// thread, which owns the services.
+void CreateAdBlockClientAndReply(
+    const base::FilePath& dat_file_path,
+    std::unique_ptr<adblock::Engine> ad_block_client,
+    const std::vector<std::string>& previous_tags,
+    const std::vector<std::string>& tags,
+    const std::string& resources,
+    base::OnceCallback<void(std::unique_ptr<adblock::Engine>)> reply) {
+  std::unique_ptr<adblock::Engine> built_ad_block_client =
+      CreateAdBlockClient(dat_file_path, std::move(ad_block_client),
+                          previous_tags, tags, resources);
+  base::PostTask(FROM_HERE, {BrowserThread::UI},
+                 base::BindOnce(std::move(reply),
+                                std::move(built_ad_block_client)));
+}
+
+std::atomic<uint64_t>& GetEngineGeneration() {
+  static std::atomic<uint64_t> generation(0);
+  return generation;
+}
+
+std::atomic<int>& GetPendingEngineUpdates() {
+  static std::atomic<int> pending_updates(0);
+  return pending_updates;
 }
 
 }  // namespace
 
 namespace brave_shields {
 
+// Services are destroyed on the UI thread while tasks for them can still be
+// queued on the ad-block task runner. Such tasks run under |lock_| and only
+// while the handle is valid, and Invalidate() takes the same lock, so a task
+// either runs before the service goes away or not at all.
+class AdBlockBaseService::TaskRunnerHandle
+    : public base::RefCountedThreadSafe<TaskRunnerHandle> {
+ public:
+  TaskRunnerHandle() : valid_(true) {}
+
+  void Invalidate() {
+    base::AutoLock lock(lock_);
+    valid_ = false;
+  }
+
+  void RunIfValid(base::OnceClosure task) {
+    base::AutoLock lock(lock_);
+    if (valid_)
+      std::move(task).Run();
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<TaskRunnerHandle>;
+  ~TaskRunnerHandle() = default;
+
+  base::Lock lock_;
+  bool valid_;
+
+  DISALLOW_COPY_AND_ASSIGN(TaskRunnerHandle);
+};
+
 AdBlockBaseService::AdBlockBaseService(BraveComponent::Delegate* delegate)
     : BaseBraveShieldsService(delegate),
       ad_block_client_(new adblock::Engine()),
+      config_generation_(0),
+      engine_generation_(NextEngineGeneration()),
+      task_runner_handle_(base::MakeRefCounted<TaskRunnerHandle>()),
       weak_factory_(this) {}
 
 AdBlockBaseService::~AdBlockBaseService() {
   Cleanup();
+  GetTaskRunner()->DeleteSoon(FROM_HERE, ad_block_client_.release());
+}
+
+// static
+uint64_t AdBlockBaseService::NextEngineGeneration() {
+  return ++GetEngineGeneration();
+}
+
+// static
+uint64_t AdBlockBaseService::CurrentEngineGeneration() {
+  return GetEngineGeneration().load();
+}
+
+// static
+bool AdBlockBaseService::IsEngineUpdatePending() {
+  return GetPendingEngineUpdates().load() > 0;
 }
 
 void AdBlockBaseService::Cleanup() {
-  GetTaskRunner()->DeleteSoon(FROM_HERE, ad_block_client_.release());
+  // Engines still being built or published are dropped. The current engine
+  // is left alone, matching tasks may still be queued for it on the task
+  // runner. A fresh handle serves the service if it is started again.
+  weak_factory_.InvalidateWeakPtrs();
+  task_runner_handle_->Invalidate();
+  task_runner_handle_ = base::MakeRefCounted<TaskRunnerHandle>();
+}
+
+void AdBlockBaseService::ReleaseAdBlockClient() {
+  DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
+  ad_block_client_.reset();
 }
 
 bool AdBlockBaseService::ShouldStartRequest(const GURL& url,
@@ -123,37 +168,44 @@ bool AdBlockBaseService::ShouldStartRequest(const GURL& url,
                                             bool* did_match_exception,
                                             bool* cancel_request_explicitly,
                                             std::string* mock_data_url) {
+  return ShouldStartRequest(AdBlockRequest(url, resource_type, tab_host),
+                            did_match_exception, cancel_request_explicitly,
+                            mock_data_url);
+}
+
+bool AdBlockBaseService::ShouldStartRequest(const AdBlockRequest& request,
+                                            bool* did_match_exception,
+                                            bool* cancel_request_explicitly,
+                                            std::string* mock_data_url) {
   DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
 
-  // Determine third-party here so the library doesn't need to figure it out.
-  // CreateFromNormalizedTuple is needed because SameDomainOrHost needs
-  // a URL or origin and not a string to a host name.
-  bool is_third_party = !SameDomainOrHost(
-      url,
-      url::Origin::CreateFromNormalizedTuple("https", tab_host.c_str(), 80),
-      INCLUDE_PRIVATE_REGISTRIES);
-  bool explicit_cancel;
-  bool saved_from_exception;
-  if (ad_block_client_->matches(
-          url.spec(), url.host(), tab_host, is_third_party,
-          ResourceTypeToString(resource_type), &explicit_cancel,
-          &saved_from_exception, mock_data_url)) {
+  AdBlockDecision decision;
+  if (!decision_cache_.Get(request, &decision)) {
+    decision.matched = ad_block_client_->matches(
+        request.url_spec, request.host, request.tab_host,
+        request.is_third_party, request.resource_type,
+        &decision.explicit_cancel, &decision.saved_from_exception,
+        &decision.mock_data_url);
+    decision_cache_.Put(request, decision);
+  }
+
+  if (mock_data_url && !decision.mock_data_url.empty()) {
+    *mock_data_url = decision.mock_data_url;
+  }
+
+  if (decision.matched) {
     if (cancel_request_explicitly) {
-      *cancel_request_explicitly = explicit_cancel;
+      *cancel_request_explicitly = decision.explicit_cancel;
     }
     // We'd only possibly match an exception filter if we're returning true.
     if (did_match_exception) {
       *did_match_exception = false;
     }
-    // LOG(ERROR) << "AdBlockBaseService::ShouldStartRequest(), host: "
-    //  << tab_host
-    //  << ", resource type: " << resource_type
-    //  << ", url.spec(): " << url.spec();
     return false;
   }
 
   if (did_match_exception) {
-    *did_match_exception = saved_from_exception;
+    *did_match_exception = decision.saved_from_exception;
   }
 
   return true;
@@ -167,6 +219,8 @@ void AdBlockBaseService::EnableTag(const std::string& tag, bool enabled) {
     return;
   }
 
+  config_generation_++;
+  OnEngineChanged();
   if (enabled) {
     ad_block_client_->addTag(tag);
     tags_.push_back(tag);
@@ -188,6 +242,8 @@ void AdBlockBaseService::AddResources(const std::string& resources) {
     return;
   }
 
+  config_generation_++;
+  OnEngineChanged();
   ad_block_client_->addResources(resources);
   resources_ = resources;
 }
@@ -196,8 +252,13 @@ bool AdBlockBaseService::TagExists(const std::string& tag) {
   return std::find(tags_.begin(), tags_.end(), tag) != tags_.end();
 }
 
+AdBlockDecisionCache::Stats AdBlockBaseService::GetDecisionCacheStats() const {
+  return decision_cache_.GetStats();
+}
+
 base::Optional<base::Value> AdBlockBaseService::HostnameCosmeticResources(
         const std::string& hostname) {
+  DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
   return base::JSONReader::Read(
           this->ad_block_client_->hostnameCosmeticResources(hostname));
 }
@@ -206,6 +267,7 @@ base::Optional<base::Value> AdBlockBaseService::HiddenClassIdSelectors(
         const std::vector<std::string>& classes,
         const std::vector<std::string>& ids,
         const std::vector<std::string>& exceptions) {
+  DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
   return base::JSONReader::Read(
           this->ad_block_client_->hiddenClassIdSelectors(classes,
                                                          ids,
@@ -213,35 +275,95 @@ base::Optional<base::Value> AdBlockBaseService::HiddenClassIdSelectors(
 }
 
 void AdBlockBaseService::GetDATFileData(const base::FilePath& dat_file_path) {
-  base::PostTaskAndReplyWithResult(
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  GetTaskRunner()->PostTask(
+      FROM_HERE,
+      base::BindOnce(
+          &TaskRunnerHandle::RunIfValid, task_runner_handle_,
+          base::BindOnce(&AdBlockBaseService::BuildAdBlockClient,
+                         base::Unretained(this), weak_factory_.GetWeakPtr(),
+                         dat_file_path, nullptr,
+                         std::vector<std::string>())));
+}
+
+void AdBlockBaseService::BuildAdBlockClient(
+    base::WeakPtr<AdBlockBaseService> weak_this,
+    const base::FilePath& dat_file_path,
+    std::unique_ptr<adblock::Engine> ad_block_client,
+    const std::vector<std::string>& previous_tags) {
+  DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
+  // The service can be destroyed on the UI thread while the engine is being
+  // built, so the reply goes there and only continues if it is still alive.
+  base::PostTask(
       FROM_HERE, {base::ThreadPool(), base::MayBlock()},
-      base::BindOnce(&brave_component_updater::LoadDATFileData<adblock::Engine>,
-                     dat_file_path),
-      base::BindOnce(&AdBlockBaseService::OnGetDATFileData,
-                     weak_factory_.GetWeakPtr()));
+      base::BindOnce(
+          &CreateAdBlockClientAndReply, dat_file_path,
+          std::move(ad_block_client), previous_tags, tags_, resources_,
+          base::BindOnce(&AdBlockBaseService::OnAdBlockClientBuilt,
+                         weak_this, dat_file_path, config_generation_,
+                         tags_)));
 }
 
-void AdBlockBaseService::OnGetDATFileData(GetDATFileDataResult result) {
-  if (result.second.empty()) {
-    LOG(ERROR) << "Could not obtain ad block data";
+void AdBlockBaseService::OnAdBlockClientBuilt(
+    const base::FilePath& dat_file_path,
+    uint64_t config_generation,
+    const std::vector<std::string>& tags,
+    std::unique_ptr<adblock::Engine> ad_block_client) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  if (!ad_block_client) {
+    LOG(ERROR) << "Could not load ad block data";
     return;
   }
-  if (!result.first.get()) {
-    LOG(ERROR) << "Failed to deserialize ad block data";
+  // Counted until the task runs, so that matching queued behind it can be
+  // told apart from matching on an idle task runner.
+  GetPendingEngineUpdates()++;
+  GetTaskRunner()->PostTask(
+      FROM_HERE,
+      base::BindOnce(
+          [](scoped_refptr<TaskRunnerHandle> handle, base::OnceClosure task) {
+            GetPendingEngineUpdates()--;
+            handle->RunIfValid(std::move(task));
+          },
+          task_runner_handle_,
+          base::BindOnce(&AdBlockBaseService::PublishAdBlockClient,
+                         base::Unretained(this), weak_factory_.GetWeakPtr(),
+                         dat_file_path, config_generation, tags,
+                         std::move(ad_block_client))));
+}
+
+void AdBlockBaseService::PublishAdBlockClient(
+    base::WeakPtr<AdBlockBaseService> weak_this,
+    const base::FilePath& dat_file_path,
+    uint64_t config_generation,
+    const std::vector<std::string>& tags,
+    std::unique_ptr<adblock::Engine> ad_block_client) {
+  DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
+  if (config_generation != config_generation_) {
+    // Tags or resources changed while the engine was being built, bring it
+    // up to date on a worker again before publishing it.
+    BuildAdBlockClient(weak_this, dat_file_path, std::move(ad_block_client),
+                       tags);
     return;
   }
-  GetTaskRunner()->PostTask(
-      FROM_HERE, base::BindOnce(&AdBlockBaseService::UpdateAdBlockClient,
-                                base::Unretained(this),
-                                std::move(result.first)));
+  UpdateAdBlockClient(std::move(ad_block_client));
 }
 
 void AdBlockBaseService::UpdateAdBlockClient(
     std::unique_ptr<adblock::Engine> ad_block_client) {
   DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
-  ad_block_client_ = std::move(ad_block_client);
-  AddKnownTagsToAdBlockInstance();
-  AddKnownResourcesToAdBlockInstance();
+  ad_block_client_.swap(ad_block_client);
+  OnEngineChanged();
+  // Tearing down a large engine is not free either, so retire the old one
+  // on a worker.
+  base::PostTask(
+      FROM_HERE, {base::ThreadPool(), base::TaskPriority::BEST_EFFORT},
+      base::BindOnce([](std::unique_ptr<adblock::Engine>) {},
+                     std::move(ad_block_client)));
+}
+
+void AdBlockBaseService::OnEngineChanged() {
+  decision_cache_.Clear();
+  engine_generation_ = NextEngineGeneration();
 }
 
 void AdBlockBaseService::AddKnownTagsToAdBlockInstance() {
@@ -263,6 +385,7 @@ void AdBlockBaseService::ResetForTest(const std::string& rules,
   // filter rules to an existing instance. At which point the hack below
   // will dissapear.
   ad_block_client_.reset(new adblock::Engine(rules));
+  OnEngineChanged();
   AddKnownTagsToAdBlockInstance();
   if (!resources.empty()) {
     resources_ = resources;
@@ -14,9 +14,11 @@
 #include <vector>
 
 #include "base/files/file_path.h"
+#include "base/memory/scoped_refptr.h"
 #include "base/memory/weak_ptr.h"
 #include "base/sequence_checker.h"
 #include "base/values.h"
+#include "brave/components/brave_shields/browser/ad_block_decision_cache.h"
 #include "brave/components/brave_shields/browser/base_brave_shields_service.h"
 #include "brave/components/brave_component_updater/browser/dat_file_util.h"
 #include "content/public/common/resource_type.h"
@@ -30,25 +32,49 @@ class Engine;
 
 namespace brave_shields {
 
+struct AdBlockRequest;
+
 // The base class of the brave shields service in charge of ad-block
 // checking and init.
 class AdBlockBaseService : public BaseBraveShieldsService {
  public:
-  using GetDATFileDataResult =
-      brave_component_updater::LoadDATFileDataResult<adblock::Engine>;
-
   explicit AdBlockBaseService(BraveComponent::Delegate* delegate);
   ~AdBlockBaseService() override;
 
   bool ShouldStartRequest(const GURL &url, content::ResourceType resource_type,
     const std::string& tab_host, bool* did_match_exception,
     bool* cancel_request_explicitly, std::string* mock_data_url) override;
+  // Same as above for request features that were already computed, so that
+  // several engines can be queried without recomputing them.
+  bool ShouldStartRequest(const AdBlockRequest& request,
+                          bool* did_match_exception,
+                          bool* cancel_request_explicitly,
+                          std::string* mock_data_url);
   void AddResources(const std::string& resources);
   void EnableTag(const std::string& tag, bool enabled);
   bool TagExists(const std::string& tag);
-
+  // Can be called from any thread.
+  AdBlockDecisionCache::Stats GetDecisionCacheStats() const;
+  // Changes whenever the engine, its tags or its resources do. Values are
+  // unique across all ad-block services and only ever increase. Must be
+  // read on the ad-block task runner.
+  uint64_t engine_generation() const { return engine_generation_; }
+  static uint64_t NextEngineGeneration();
+  // The latest generation handed out to any service. Changes whenever any
+  // engine or the set of enabled regional lists does. Can be called from any
+  // thread.
+  static uint64_t CurrentEngineGeneration();
+  // Whether a built engine is waiting to be published on the ad-block task
+  // runner by any service. Can be called from any thread.
+  static bool IsEngineUpdatePending();
+  // Drops the engine of a service that no longer matches requests. Must be
+  // called on the ad-block task runner.
+  void ReleaseAdBlockClient();
+
+  // Must be called on the ad-block task runner.
   base::Optional<base::Value> HostnameCosmeticResources(
           const std::string& hostname);
+  // Must be called on the ad-block task runner.
   base::Optional<base::Value> HiddenClassIdSelectors(
           const std::vector<std::string>& classes,
           const std::vector<std::string>& ids,
@@ -56,6 +82,7 @@ class AdBlockBaseService : public BaseBraveShieldsService {
 
  protected:
   friend class ::AdBlockServiceTest;
+  friend class AdBlockCosmeticResourcesServiceTest;
   bool Init() override;
   void Cleanup() override;
 
@@ -63,17 +90,49 @@ class AdBlockBaseService : public BaseBraveShieldsService {
   void AddKnownTagsToAdBlockInstance();
   void AddKnownResourcesToAdBlockInstance();
   void ResetForTest(const std::string& rules, const std::string& resources);
+  // Replaces the engine used for matching. Must be called on the ad-block
+  // task runner.
+  void UpdateAdBlockClient(
+      std::unique_ptr<adblock::Engine> ad_block_client);
 
   std::unique_ptr<adblock::Engine> ad_block_client_;
 
  private:
-  void UpdateAdBlockClient(
-      std::unique_ptr<adblock::Engine> ad_block_client);
-  void OnGetDATFileData(GetDATFileDataResult result);
+  class TaskRunnerHandle;
+
+  // Builds an engine with the current tags and resources on a worker and
+  // publishes it once done. Runs on the ad-block task runner. |weak_this| is
+  // only dereferenced on the UI thread.
+  void BuildAdBlockClient(base::WeakPtr<AdBlockBaseService> weak_this,
+                          const base::FilePath& dat_file_path,
+                          std::unique_ptr<adblock::Engine> ad_block_client,
+                          const std::vector<std::string>& previous_tags);
+  // Runs on the UI thread.
+  void OnAdBlockClientBuilt(const base::FilePath& dat_file_path,
+                            uint64_t config_generation,
+                            const std::vector<std::string>& tags,
+                            std::unique_ptr<adblock::Engine> ad_block_client);
+  // Runs on the ad-block task runner.
+  void PublishAdBlockClient(base::WeakPtr<AdBlockBaseService> weak_this,
+                            const base::FilePath& dat_file_path,
+                            uint64_t config_generation,
+                            const std::vector<std::string>& tags,
+                            std::unique_ptr<adblock::Engine> ad_block_client);
   void OnPreferenceChanges(const std::string& pref_name);
+  // Drops state derived from the previous engine configuration.
+  void OnEngineChanged();
 
   std::vector<std::string> tags_;
   std::string resources_;
+  // Bumped whenever |tags_| or |resources_| change.
+  uint64_t config_generation_;
+  // Decisions of |ad_block_client_| with the current tags and resources.
+  AdBlockDecisionCache decision_cache_;
+  uint64_t engine_generation_;
+  // Tasks posted from the UI thread reach the service on the ad-block task
+  // runner through this, as the service can be destroyed before they run.
+  scoped_refptr<TaskRunnerHandle> task_runner_handle_;
+  // Only used on the UI thread.
   base::WeakPtrFactory<AdBlockBaseService> weak_factory_;
   DISALLOW_COPY_AND_ASSIGN(AdBlockBaseService);
 };
@@ -0,0 +1,190 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_cosmetic_resources_service.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/json/json_writer.h"
+#include "base/optional.h"
+#include "base/task_runner_util.h"
+#include "base/values.h"
+#include "brave/components/brave_shields/browser/ad_block_base_service.h"
+#include "brave/components/brave_shields/browser/ad_block_regional_service_manager.h"
+#include "brave/components/brave_shields/browser/ad_block_selector_session.h"
+#include "brave/components/brave_shields/browser/ad_block_service_helper.h"
+
+namespace brave_shields {
+
+namespace {
+
+// Pages tend to be made of frames from a handful of hosts, so this covers
+// the hosts of many open tabs.
+constexpr size_t kMaxCachedHostnames = 128;
+
+// A session per frame, an evicted session only costs that frame a repeated
+// evaluation of its classes and ids.
+constexpr size_t kMaxSelectorSessions = 256;
+
+}  // namespace
+
+AdBlockCosmeticResourcesService::CachedResources::CachedResources()
+    : engine_generation(0) {}
+
+AdBlockCosmeticResourcesService::CachedResources::CachedResources(
+    const CachedResources& other) = default;
+
+AdBlockCosmeticResourcesService::CachedResources::~CachedResources() =
+    default;
+
+AdBlockCosmeticResourcesService::HiddenSelectors::HiddenSelectors() = default;
+
+AdBlockCosmeticResourcesService::HiddenSelectors::HiddenSelectors(
+    HiddenSelectors&& other) = default;
+
+AdBlockCosmeticResourcesService::HiddenSelectors::~HiddenSelectors() =
+    default;
+
+AdBlockCosmeticResourcesService::AdBlockCosmeticResourcesService(
+    scoped_refptr<base::SequencedTaskRunner> task_runner,
+    AdBlockBaseService* default_service,
+    AdBlockRegionalServiceManager* regional_service_manager,
+    AdBlockBaseService* custom_filters_service)
+    : task_runner_(std::move(task_runner)),
+      default_service_(default_service),
+      regional_service_manager_(regional_service_manager),
+      custom_filters_service_(custom_filters_service),
+      cache_(kMaxCachedHostnames),
+      selector_sessions_(kMaxSelectorSessions) {}
+
+AdBlockCosmeticResourcesService::~AdBlockCosmeticResourcesService() = default;
+
+void AdBlockCosmeticResourcesService::GetHostnameCosmeticResources(
+    const std::string& hostname,
+    ResourcesCallback callback) {
+  base::PostTaskAndReplyWithResult(
+      task_runner_.get(), FROM_HERE,
+      base::BindOnce(
+          &AdBlockCosmeticResourcesService::GetResourcesOnTaskRunner,
+          base::Unretained(this), hostname),
+      std::move(callback));
+}
+
+scoped_refptr<base::RefCountedString>
+AdBlockCosmeticResourcesService::GetResourcesOnTaskRunner(
+    const std::string& hostname) {
+  DCHECK(task_runner_->RunsTasksInCurrentSequence());
+  const uint64_t engine_generation = GetEngineGeneration();
+  auto it = cache_.Get(hostname);
+  if (it != cache_.end() &&
+      it->second.engine_generation == engine_generation) {
+    return it->second.json;
+  }
+
+  CachedResources resources;
+  resources.engine_generation = engine_generation;
+  resources.json = ComputeResources(hostname);
+  if (resources.json)
+    cache_.Put(hostname, resources);
+  return resources.json;
+}
+
+scoped_refptr<base::RefCountedString>
+AdBlockCosmeticResourcesService::ComputeResources(
+    const std::string& hostname) {
+  base::Optional<base::Value> resources =
+      default_service_->HostnameCosmeticResources(hostname);
+  if (!resources || !resources->is_dict())
+    return nullptr;
+
+  base::Optional<base::Value> regional_resources =
+      regional_service_manager_->HostnameCosmeticResources(hostname);
+  if (regional_resources && regional_resources->is_dict())
+    MergeResourcesInto(&*resources, &*regional_resources, false);
+
+  base::Optional<base::Value> custom_resources =
+      custom_filters_service_->HostnameCosmeticResources(hostname);
+  if (custom_resources && custom_resources->is_dict())
+    MergeResourcesInto(&*resources, &*custom_resources, true);
+
+  auto json = base::MakeRefCounted<base::RefCountedString>();
+  if (!base::JSONWriter::Write(*resources, &json->data()))
+    return nullptr;
+  return json;
+}
+
+void AdBlockCosmeticResourcesService::GetHiddenClassIdSelectors(
+    const std::string& session_id,
+    const std::vector<std::string>& classes,
+    const std::vector<std::string>& ids,
+    const std::vector<std::string>& exceptions,
+    base::OnceCallback<void(HiddenSelectors)> callback) {
+  base::PostTaskAndReplyWithResult(
+      task_runner_.get(), FROM_HERE,
+      base::BindOnce(&AdBlockCosmeticResourcesService::
+                         GetHiddenClassIdSelectorsOnTaskRunner,
+                     base::Unretained(this), session_id, classes, ids,
+                     exceptions),
+      std::move(callback));
+}
+
+AdBlockCosmeticResourcesService::HiddenSelectors
+AdBlockCosmeticResourcesService::GetHiddenClassIdSelectorsOnTaskRunner(
+    const std::string& session_id,
+    const std::vector<std::string>& classes,
+    const std::vector<std::string>& ids,
+    const std::vector<std::string>& exceptions) {
+  DCHECK(task_runner_->RunsTasksInCurrentSequence());
+  auto it = selector_sessions_.Get(session_id);
+  if (it == selector_sessions_.end()) {
+    it = selector_sessions_.Put(session_id,
+                                std::make_unique<AdBlockSelectorSession>());
+  }
+  AdBlockSelectorSession* session = it->second.get();
+
+  HiddenSelectors result;
+  std::vector<std::string> new_classes;
+  std::vector<std::string> new_ids;
+  session->AddClassesAndIds(classes, ids, GetEngineGeneration(), &new_classes,
+                            &new_ids);
+  if (new_classes.empty() && new_ids.empty())
+    return result;
+
+  base::Optional<base::Value> hide_selectors =
+      default_service_->HiddenClassIdSelectors(new_classes, new_ids,
+                                               exceptions);
+  if (hide_selectors)
+    session->TakeNewHideSelectors(*hide_selectors, &result.hide_selectors);
+
+  base::Optional<base::Value> regional_selectors =
+      regional_service_manager_->HiddenClassIdSelectors(new_classes, new_ids,
+                                                        exceptions);
+  if (regional_selectors) {
+    session->TakeNewHideSelectors(*regional_selectors,
+                                  &result.hide_selectors);
+  }
+
+  base::Optional<base::Value> custom_selectors =
+      custom_filters_service_->HiddenClassIdSelectors(new_classes, new_ids,
+                                                      exceptions);
+  if (custom_selectors) {
+    session->TakeNewForceHideSelectors(*custom_selectors,
+                                       &result.force_hide_selectors);
+  }
+
+  return result;
+}
+
+uint64_t AdBlockCosmeticResourcesService::GetEngineGeneration() const {
+  // Generations are unique across services and only increase, so the
+  // largest one changes whenever any engine does.
+  return std::max({default_service_->engine_generation(),
+                   regional_service_manager_->GetEngineGeneration(),
+                   custom_filters_service_->engine_generation()});
+}
+
+}  // namespace brave_shields
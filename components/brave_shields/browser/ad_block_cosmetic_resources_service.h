@@ -0,0 +1,113 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_COSMETIC_RESOURCES_SERVICE_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_COSMETIC_RESOURCES_SERVICE_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/callback_forward.h"
+#include "base/containers/mru_cache.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/sequenced_task_runner.h"
+
+namespace brave_shields {
+
+class AdBlockBaseService;
+class AdBlockRegionalServiceManager;
+class AdBlockSelectorSession;
+
+// Computes the cosmetic resources of the default, regional and custom filter
+// engines on the ad-block task runner.
+//
+// Hostname-specific resources are merged and kept, serialized to JSON, for
+// recently seen hostnames. Entries are reused until any of the engines
+// changes.
+//
+// Generic class and id selectors are looked up per frame session, see
+// AdBlockSelectorSession.
+class AdBlockCosmeticResourcesService {
+ public:
+  struct HiddenSelectors {
+    HiddenSelectors();
+    HiddenSelectors(HiddenSelectors&& other);
+    ~HiddenSelectors();
+
+    std::vector<std::string> hide_selectors;
+    // From custom filters, these are hidden without a first party check.
+    std::vector<std::string> force_hide_selectors;
+  };
+
+  // Receives the JSON serialized resources, or nullptr if the default
+  // engine had none to offer.
+  using ResourcesCallback =
+      base::OnceCallback<void(scoped_refptr<base::RefCountedString>)>;
+
+  AdBlockCosmeticResourcesService(
+      scoped_refptr<base::SequencedTaskRunner> task_runner,
+      AdBlockBaseService* default_service,
+      AdBlockRegionalServiceManager* regional_service_manager,
+      AdBlockBaseService* custom_filters_service);
+  ~AdBlockCosmeticResourcesService();
+
+  // Can be called from any sequence, |callback| runs on the calling one.
+  void GetHostnameCosmeticResources(const std::string& hostname,
+                                    ResourcesCallback callback);
+
+  // Evaluates the |classes| and |ids| that |session_id| has not sent before
+  // and replies with the selectors it has not received yet. Sessions are
+  // identified by the caller and forgotten when they have not been used for
+  // a while. Can be called from any sequence, |callback| runs on the calling
+  // one.
+  void GetHiddenClassIdSelectors(
+      const std::string& session_id,
+      const std::vector<std::string>& classes,
+      const std::vector<std::string>& ids,
+      const std::vector<std::string>& exceptions,
+      base::OnceCallback<void(HiddenSelectors)> callback);
+
+ private:
+  struct CachedResources {
+    CachedResources();
+    CachedResources(const CachedResources& other);
+    ~CachedResources();
+
+    uint64_t engine_generation;
+    scoped_refptr<base::RefCountedString> json;
+  };
+
+  scoped_refptr<base::RefCountedString> GetResourcesOnTaskRunner(
+      const std::string& hostname);
+  scoped_refptr<base::RefCountedString> ComputeResources(
+      const std::string& hostname);
+  HiddenSelectors GetHiddenClassIdSelectorsOnTaskRunner(
+      const std::string& session_id,
+      const std::vector<std::string>& classes,
+      const std::vector<std::string>& ids,
+      const std::vector<std::string>& exceptions);
+  uint64_t GetEngineGeneration() const;
+
+  scoped_refptr<base::SequencedTaskRunner> task_runner_;
+  AdBlockBaseService* default_service_;  // NOT OWNED
+  AdBlockRegionalServiceManager* regional_service_manager_;  // NOT OWNED
+  AdBlockBaseService* custom_filters_service_;  // NOT OWNED
+  // Only accessed on |task_runner_|.
+  base::HashingMRUCache<std::string, CachedResources> cache_;
+  // Only accessed on |task_runner_|.
+  base::HashingMRUCache<std::string, std::unique_ptr<AdBlockSelectorSession>>
+      selector_sessions_;
+
+  DISALLOW_COPY_AND_ASSIGN(AdBlockCosmeticResourcesService);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_COSMETIC_RESOURCES_SERVICE_H_
@@ -0,0 +1,240 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_cosmetic_resources_service.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/json/json_reader.h"
+#include "base/task/post_task.h"
+#include "base/values.h"
+#include "brave/components/brave_shields/browser/ad_block_base_service.h"
+#include "brave/components/brave_shields/browser/ad_block_regional_service.h"
+#include "brave/components/brave_shields/browser/ad_block_regional_service_manager.h"
+#include "brave/vendor/adblock_rust_ffi/src/wrapper.hpp"
+#include "content/public/test/browser_task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace brave_shields {
+
+namespace {
+
+const char kHostname[] = "example.com";
+
+class TestComponentDelegate : public BraveComponent::Delegate {
+ public:
+  TestComponentDelegate()
+      : task_runner_(base::CreateSequencedTaskRunner({base::ThreadPool()})) {}
+  ~TestComponentDelegate() override = default;
+
+  void Register(const std::string& component_name,
+                const std::string& component_base64_public_key,
+                base::OnceClosure registered_callback,
+                BraveComponent::ReadyCallback ready_callback) override {}
+  bool Unregister(const std::string& component_id) override { return true; }
+  void OnDemandUpdate(const std::string& component_id) override {}
+  scoped_refptr<base::SequencedTaskRunner> GetTaskRunner() override {
+    return task_runner_;
+  }
+
+ private:
+  scoped_refptr<base::SequencedTaskRunner> task_runner_;
+};
+
+base::Value ListFromJSON(const std::string& json) {
+  base::Optional<base::Value> value = base::JSONReader::Read(json);
+  DCHECK(value && value->is_list());
+  return std::move(*value);
+}
+
+}  // namespace
+
+class AdBlockCosmeticResourcesServiceTest : public testing::Test {
+ public:
+  AdBlockCosmeticResourcesServiceTest()
+      : default_service_(&delegate_),
+        custom_filters_service_(&delegate_),
+        regional_service_manager_(&delegate_),
+        service_(delegate_.GetTaskRunner(),
+                 &default_service_,
+                 &regional_service_manager_,
+                 &custom_filters_service_) {}
+  ~AdBlockCosmeticResourcesServiceTest() override {}
+
+ protected:
+  void SetUp() override {
+    ResetService(&default_service_, "example.com##.default-ad");
+  }
+
+  // Replaces the engine of |service| on the ad-block task runner.
+  void ResetService(AdBlockBaseService* service, const std::string& rules) {
+    delegate_.GetTaskRunner()->PostTask(
+        FROM_HERE, base::BindOnce(&AdBlockBaseService::ResetForTest,
+                                  base::Unretained(service), rules, ""));
+    task_environment_.RunUntilIdle();
+  }
+
+  // Enables the regional lists with the smallest uuids, in uuid order, one
+  // for each entry of |rules|. Regional lists are merged in that order.
+  void EnableRegionalLists(const std::vector<std::string>& rules) {
+    std::vector<std::string> uuids;
+    for (const auto& list : adblock::FilterList::GetRegionalLists())
+      uuids.push_back(list.uuid);
+    std::sort(uuids.begin(), uuids.end());
+    ASSERT_GE(uuids.size(), rules.size());
+
+    for (size_t i = 0; i < rules.size(); ++i) {
+      regional_service_manager_.EnableFilterList(uuids[i], true);
+      task_environment_.RunUntilIdle();
+      ResetService(
+          regional_service_manager_.regional_services_[uuids[i]].get(),
+          rules[i]);
+      enabled_uuids_.push_back(uuids[i]);
+    }
+  }
+
+  void DisableRegionalLists() {
+    for (const std::string& uuid : enabled_uuids_)
+      regional_service_manager_.EnableFilterList(uuid, false);
+    enabled_uuids_.clear();
+    task_environment_.RunUntilIdle();
+  }
+
+  scoped_refptr<base::RefCountedString> GetResources() {
+    scoped_refptr<base::RefCountedString> resources;
+    service_.GetHostnameCosmeticResources(
+        kHostname,
+        base::BindOnce(
+            [](scoped_refptr<base::RefCountedString>* resources,
+               scoped_refptr<base::RefCountedString> result) {
+              *resources = std::move(result);
+            },
+            &resources));
+    task_environment_.RunUntilIdle();
+    return resources;
+  }
+
+  base::Value GetResourcesValue() {
+    scoped_refptr<base::RefCountedString> resources = GetResources();
+    if (!resources)
+      return base::Value();
+    base::Optional<base::Value> value =
+        base::JSONReader::Read(resources->data());
+    if (!value || !value->is_dict())
+      return base::Value();
+    return std::move(*value);
+  }
+
+  content::BrowserTaskEnvironment task_environment_;
+  TestComponentDelegate delegate_;
+  AdBlockBaseService default_service_;
+  AdBlockBaseService custom_filters_service_;
+  AdBlockRegionalServiceManager regional_service_manager_;
+  AdBlockCosmeticResourcesService service_;
+  std::vector<std::string> enabled_uuids_;
+};
+
+TEST_F(AdBlockCosmeticResourcesServiceTest, ReusesResourcesForSameEngines) {
+  scoped_refptr<base::RefCountedString> first = GetResources();
+  ASSERT_TRUE(first);
+
+  EXPECT_EQ(first, GetResources());
+}
+
+TEST_F(AdBlockCosmeticResourcesServiceTest, RecomputesAfterTagChange) {
+  scoped_refptr<base::RefCountedString> first = GetResources();
+  ASSERT_TRUE(first);
+
+  default_service_.EnableTag("brave", true);
+  task_environment_.RunUntilIdle();
+
+  scoped_refptr<base::RefCountedString> second = GetResources();
+  ASSERT_TRUE(second);
+  EXPECT_NE(first, second);
+  EXPECT_EQ(second, GetResources());
+}
+
+TEST_F(AdBlockCosmeticResourcesServiceTest, RecomputesAfterResourcesChange) {
+  scoped_refptr<base::RefCountedString> first = GetResources();
+  ASSERT_TRUE(first);
+
+  default_service_.AddResources("[]");
+  task_environment_.RunUntilIdle();
+
+  scoped_refptr<base::RefCountedString> second = GetResources();
+  ASSERT_TRUE(second);
+  EXPECT_NE(first, second);
+}
+
+TEST_F(AdBlockCosmeticResourcesServiceTest, RecomputesAfterListChange) {
+  scoped_refptr<base::RefCountedString> first = GetResources();
+  ASSERT_TRUE(first);
+
+  EnableRegionalLists({"example.com##.regional-ad"});
+  scoped_refptr<base::RefCountedString> enabled = GetResources();
+  ASSERT_TRUE(enabled);
+  EXPECT_NE(first, enabled);
+  EXPECT_NE(std::string::npos, enabled->data().find(".regional-ad"));
+
+  DisableRegionalLists();
+  scoped_refptr<base::RefCountedString> disabled = GetResources();
+  ASSERT_TRUE(disabled);
+  EXPECT_NE(enabled, disabled);
+  EXPECT_EQ(std::string::npos, disabled->data().find(".regional-ad"));
+}
+
+TEST_F(AdBlockCosmeticResourcesServiceTest,
+       RecomputesAfterCustomFiltersChange) {
+  scoped_refptr<base::RefCountedString> first = GetResources();
+  ASSERT_TRUE(first);
+  EXPECT_EQ(std::string::npos, first->data().find(".custom-ad"));
+
+  ResetService(&custom_filters_service_, "example.com##.custom-ad");
+
+  scoped_refptr<base::RefCountedString> second = GetResources();
+  ASSERT_TRUE(second);
+  EXPECT_NE(first, second);
+  EXPECT_NE(std::string::npos, second->data().find(".custom-ad"));
+}
+
+TEST_F(AdBlockCosmeticResourcesServiceTest, MergesDefaultRegionalAndCustom) {
+  EnableRegionalLists({"example.com##.first-regional-ad",
+                       "example.com##.second-regional-ad"});
+  ResetService(&custom_filters_service_, "example.com##.custom-ad");
+
+  base::Value resources = GetResourcesValue();
+  ASSERT_TRUE(resources.is_dict());
+
+  const base::Value* hide_selectors = resources.FindListKey("hide_selectors");
+  ASSERT_TRUE(hide_selectors);
+  EXPECT_EQ(ListFromJSON("[\".default-ad\", \".first-regional-ad\", "
+                         "\".second-regional-ad\"]"),
+            *hide_selectors);
+
+  // Custom filters are hidden without a first party check.
+  const base::Value* force_hide_selectors =
+      resources.FindListKey("force_hide_selectors");
+  ASSERT_TRUE(force_hide_selectors);
+  EXPECT_EQ(ListFromJSON("[\".custom-ad\"]"), *force_hide_selectors);
+}
+
+TEST_F(AdBlockCosmeticResourcesServiceTest, MergesFirstRegionalListOnce) {
+  EnableRegionalLists({"example.com##.regional-ad"});
+
+  base::Value resources = GetResourcesValue();
+  ASSERT_TRUE(resources.is_dict());
+
+  const base::Value* hide_selectors = resources.FindListKey("hide_selectors");
+  ASSERT_TRUE(hide_selectors);
+  EXPECT_EQ(ListFromJSON("[\".default-ad\", \".regional-ad\"]"),
+            *hide_selectors);
+}
+
+}  // namespace brave_shields
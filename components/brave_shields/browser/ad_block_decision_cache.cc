@@ -0,0 +1,52 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_decision_cache.h"
+
+#include "brave/components/brave_shields/browser/ad_block_request.h"
+
+namespace brave_shields {
+
+AdBlockDecision::AdBlockDecision()
+    : matched(false), explicit_cancel(false), saved_from_exception(false) {}
+
+AdBlockDecision::AdBlockDecision(const AdBlockDecision& other) = default;
+
+AdBlockDecision::~AdBlockDecision() = default;
+
+AdBlockDecisionCache::AdBlockDecisionCache(size_t max_size)
+    : decisions_(max_size), hits_(0), misses_(0) {}
+
+AdBlockDecisionCache::~AdBlockDecisionCache() = default;
+
+bool AdBlockDecisionCache::Get(const AdBlockRequest& request,
+                               AdBlockDecision* decision) {
+  auto it = decisions_.Get(request.decision_key);
+  if (it == decisions_.end()) {
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  hits_.fetch_add(1, std::memory_order_relaxed);
+  *decision = it->second;
+  return true;
+}
+
+void AdBlockDecisionCache::Put(const AdBlockRequest& request,
+                               const AdBlockDecision& decision) {
+  decisions_.Put(request.decision_key, decision);
+}
+
+void AdBlockDecisionCache::Clear() {
+  decisions_.Clear();
+}
+
+AdBlockDecisionCache::Stats AdBlockDecisionCache::GetStats() const {
+  Stats stats;
+  stats.hits = hits_.load(std::memory_order_relaxed);
+  stats.misses = misses_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,67 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_DECISION_CACHE_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_DECISION_CACHE_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+
+#include "base/containers/mru_cache.h"
+#include "base/macros.h"
+
+namespace brave_shields {
+
+struct AdBlockRequest;
+
+// The outcome of matching a request against a single ad-block engine.
+struct AdBlockDecision {
+  AdBlockDecision();
+  AdBlockDecision(const AdBlockDecision& other);
+  ~AdBlockDecision();
+
+  bool matched;
+  bool explicit_cancel;
+  bool saved_from_exception;
+  std::string mock_data_url;
+};
+
+// Bounded LRU of engine decisions keyed by AdBlockRequest::decision_key.
+// Entries are only valid for the engine, tags and resources they were
+// computed with, so the owner must Clear() the cache whenever any of those
+// change. Lookups and insertions happen on the ad-block task runner; the
+// hit and miss counters may be read from any thread.
+class AdBlockDecisionCache {
+ public:
+  static constexpr size_t kDefaultMaxSize = 1024;
+
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+  };
+
+  explicit AdBlockDecisionCache(size_t max_size = kDefaultMaxSize);
+  ~AdBlockDecisionCache();
+
+  bool Get(const AdBlockRequest& request, AdBlockDecision* decision);
+  void Put(const AdBlockRequest& request, const AdBlockDecision& decision);
+  void Clear();
+
+  size_t size() const { return decisions_.size(); }
+  Stats GetStats() const;
+
+ private:
+  base::HashingMRUCache<std::string, AdBlockDecision> decisions_;
+  std::atomic<uint64_t> hits_;
+  std::atomic<uint64_t> misses_;
+
+  DISALLOW_COPY_AND_ASSIGN(AdBlockDecisionCache);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_DECISION_CACHE_H_
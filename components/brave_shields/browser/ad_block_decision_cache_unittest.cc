@@ -0,0 +1,88 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_decision_cache.h"
+
+#include "brave/components/brave_shields/browser/ad_block_request.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace brave_shields {
+
+TEST(AdBlockDecisionCacheTest, HitAfterPut) {
+  AdBlockDecisionCache cache;
+  const AdBlockRequest request(GURL("https://tracker.test/pixel.gif"),
+                               content::ResourceType::kImage,
+                               "www.example.com");
+  AdBlockDecision decision;
+  EXPECT_FALSE(cache.Get(request, &decision));
+
+  decision.matched = true;
+  decision.explicit_cancel = true;
+  decision.mock_data_url = "data:text/plain,";
+  cache.Put(request, decision);
+
+  AdBlockDecision cached;
+  ASSERT_TRUE(cache.Get(request, &cached));
+  EXPECT_TRUE(cached.matched);
+  EXPECT_TRUE(cached.explicit_cancel);
+  EXPECT_FALSE(cached.saved_from_exception);
+  EXPECT_EQ("data:text/plain,", cached.mock_data_url);
+
+  const AdBlockDecisionCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(1u, stats.misses);
+}
+
+TEST(AdBlockDecisionCacheTest, KeyCoversTabHostAndResourceType) {
+  AdBlockDecisionCache cache;
+  const GURL url("https://cdn.test/lib.js");
+  AdBlockDecision decision;
+  decision.matched = true;
+  cache.Put(AdBlockRequest(url, content::ResourceType::kScript, "a.test"),
+            decision);
+
+  AdBlockDecision cached;
+  EXPECT_TRUE(cache.Get(
+      AdBlockRequest(url, content::ResourceType::kScript, "a.test"), &cached));
+  EXPECT_FALSE(cache.Get(
+      AdBlockRequest(url, content::ResourceType::kScript, "www.a.test"),
+      &cached));
+  EXPECT_FALSE(cache.Get(
+      AdBlockRequest(url, content::ResourceType::kXhr, "a.test"), &cached));
+}
+
+TEST(AdBlockDecisionCacheTest, ClearDropsDecisions) {
+  AdBlockDecisionCache cache;
+  const AdBlockRequest request(GURL("https://tracker.test/a.js"),
+                               content::ResourceType::kScript, "example.com");
+  cache.Put(request, AdBlockDecision());
+  ASSERT_EQ(1u, cache.size());
+
+  cache.Clear();
+  EXPECT_EQ(0u, cache.size());
+  AdBlockDecision cached;
+  EXPECT_FALSE(cache.Get(request, &cached));
+}
+
+TEST(AdBlockDecisionCacheTest, Bounded) {
+  AdBlockDecisionCache cache(2);
+  const AdBlockRequest first(GURL("https://tracker.test/1"),
+                             content::ResourceType::kImage, "example.com");
+  const AdBlockRequest second(GURL("https://tracker.test/2"),
+                              content::ResourceType::kImage, "example.com");
+  const AdBlockRequest third(GURL("https://tracker.test/3"),
+                             content::ResourceType::kImage, "example.com");
+  cache.Put(first, AdBlockDecision());
+  cache.Put(second, AdBlockDecision());
+  cache.Put(third, AdBlockDecision());
+
+  EXPECT_EQ(2u, cache.size());
+  AdBlockDecision cached;
+  EXPECT_FALSE(cache.Get(first, &cached));
+  EXPECT_TRUE(cache.Get(third, &cached));
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,55 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_matcher.h"
+
+#include "brave/components/brave_shields/browser/ad_block_base_service.h"
+#include "brave/components/brave_shields/browser/ad_block_regional_service_manager.h"
+#include "brave/components/brave_shields/browser/ad_block_request.h"
+
+namespace brave_shields {
+
+AdBlockMatcher::AdBlockMatcher(
+    AdBlockBaseService* default_service,
+    AdBlockRegionalServiceManager* regional_service_manager,
+    AdBlockBaseService* custom_filters_service)
+    : default_service_(default_service),
+      regional_service_manager_(regional_service_manager),
+      custom_filters_service_(custom_filters_service) {}
+
+AdBlockMatcher::~AdBlockMatcher() = default;
+
+bool AdBlockMatcher::ShouldStartRequest(const AdBlockRequest& request,
+                                        bool* did_match_exception,
+                                        bool* cancel_request_explicitly,
+                                        std::string* mock_data_url) const {
+  if (did_match_exception)
+    *did_match_exception = false;
+
+  bool matched_exception = false;
+  if (default_service_ &&
+      !default_service_->ShouldStartRequest(request, &matched_exception,
+                                            cancel_request_explicitly,
+                                            mock_data_url)) {
+    return false;
+  }
+  if (!matched_exception && regional_service_manager_ &&
+      !regional_service_manager_->ShouldStartRequest(
+          request, &matched_exception, cancel_request_explicitly,
+          mock_data_url)) {
+    return false;
+  }
+  if (!matched_exception && custom_filters_service_ &&
+      !custom_filters_service_->ShouldStartRequest(request, &matched_exception,
+                                                   cancel_request_explicitly,
+                                                   mock_data_url)) {
+    return false;
+  }
+  if (did_match_exception)
+    *did_match_exception = matched_exception;
+  return true;
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,46 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_MATCHER_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_MATCHER_H_
+
+#include <string>
+
+#include "base/macros.h"
+
+namespace brave_shields {
+
+class AdBlockBaseService;
+class AdBlockRegionalServiceManager;
+struct AdBlockRequest;
+
+// Evaluates a request against every enabled ad-block engine in one call:
+// the default list, then each regional list, then the custom filters.
+// Evaluation stops at the first engine that blocks the request or matches an
+// exception filter. Must be used on the ad-block task runner.
+class AdBlockMatcher {
+ public:
+  AdBlockMatcher(AdBlockBaseService* default_service,
+                 AdBlockRegionalServiceManager* regional_service_manager,
+                 AdBlockBaseService* custom_filters_service);
+  ~AdBlockMatcher();
+
+  // Returns false if the request should be blocked.
+  bool ShouldStartRequest(const AdBlockRequest& request,
+                          bool* did_match_exception,
+                          bool* cancel_request_explicitly,
+                          std::string* mock_data_url) const;
+
+ private:
+  AdBlockBaseService* default_service_;  // NOT OWNED
+  AdBlockRegionalServiceManager* regional_service_manager_;  // NOT OWNED
+  AdBlockBaseService* custom_filters_service_;  // NOT OWNED
+
+  DISALLOW_COPY_AND_ASSIGN(AdBlockMatcher);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_MATCHER_H_
@@ -0,0 +1,43 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_prescreen_cache.h"
+
+namespace brave_shields {
+
+AdBlockPrescreenCache::AdBlockPrescreenCache(size_t max_size)
+    : entries_(max_size) {}
+
+AdBlockPrescreenCache::~AdBlockPrescreenCache() = default;
+
+bool AdBlockPrescreenCache::Get(const std::string& key,
+                                uint64_t current_generation,
+                                std::string* mock_data_url) {
+  base::AutoLock lock(lock_);
+  auto it = entries_.Get(key);
+  if (it == entries_.end())
+    return false;
+  if (it->second.engine_generation != current_generation) {
+    // Decided by an engine that has been replaced since.
+    entries_.Erase(it);
+    return false;
+  }
+  *mock_data_url = it->second.mock_data_url;
+  return true;
+}
+
+void AdBlockPrescreenCache::Put(const std::string& key,
+                                uint64_t engine_generation,
+                                const std::string& mock_data_url) {
+  base::AutoLock lock(lock_);
+  entries_.Put(key, Entry{engine_generation, mock_data_url});
+}
+
+size_t AdBlockPrescreenCache::size() const {
+  base::AutoLock lock(lock_);
+  return entries_.size();
+}
+
+}  // namespace brave_shields
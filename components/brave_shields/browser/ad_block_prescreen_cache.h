@@ -0,0 +1,58 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_PRESCREEN_CACHE_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_PRESCREEN_CACHE_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include "base/containers/mru_cache.h"
+#include "base/macros.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+
+namespace brave_shields {
+
+// Bounded LRU of requests that ended up blocked with a stub response, so that
+// identical requests can be answered synchronously before any work is done
+// for them. Entries remember the engine generation (see
+// AdBlockBaseService::CurrentEngineGeneration()) they were decided with and
+// are only valid as long as no engine has changed since. Can be used from
+// any thread.
+class AdBlockPrescreenCache {
+ public:
+  static constexpr size_t kDefaultMaxSize = 512;
+
+  explicit AdBlockPrescreenCache(size_t max_size = kDefaultMaxSize);
+  ~AdBlockPrescreenCache();
+
+  // Returns true if |key| was blocked at |current_generation|. |mock_data_url|
+  // receives the stub it was blocked with.
+  bool Get(const std::string& key,
+           uint64_t current_generation,
+           std::string* mock_data_url);
+  void Put(const std::string& key,
+           uint64_t engine_generation,
+           const std::string& mock_data_url);
+
+  size_t size() const;
+
+ private:
+  struct Entry {
+    uint64_t engine_generation;
+    std::string mock_data_url;
+  };
+
+  mutable base::Lock lock_;
+  base::HashingMRUCache<std::string, Entry> entries_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(AdBlockPrescreenCache);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_PRESCREEN_CACHE_H_
@@ -0,0 +1,46 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_prescreen_cache.h"
+
+#include <string>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace brave_shields {
+
+TEST(AdBlockPrescreenCacheTest, HitAtSameGeneration) {
+  AdBlockPrescreenCache cache;
+  std::string mock_data_url;
+  EXPECT_FALSE(cache.Get("k1", 7, &mock_data_url));
+
+  cache.Put("k1", 7, "data:text/plain,");
+  ASSERT_TRUE(cache.Get("k1", 7, &mock_data_url));
+  EXPECT_EQ("data:text/plain,", mock_data_url);
+  EXPECT_FALSE(cache.Get("k2", 7, &mock_data_url));
+}
+
+TEST(AdBlockPrescreenCacheTest, StaleAfterEngineChange) {
+  AdBlockPrescreenCache cache;
+  cache.Put("k1", 7, "");
+  std::string mock_data_url;
+  EXPECT_FALSE(cache.Get("k1", 8, &mock_data_url));
+  // Stale entries are dropped rather than kept around.
+  EXPECT_EQ(0u, cache.size());
+  EXPECT_FALSE(cache.Get("k1", 7, &mock_data_url));
+}
+
+TEST(AdBlockPrescreenCacheTest, Bounded) {
+  AdBlockPrescreenCache cache(2);
+  cache.Put("k1", 7, "");
+  cache.Put("k2", 7, "");
+  cache.Put("k3", 7, "");
+  EXPECT_EQ(2u, cache.size());
+  std::string mock_data_url;
+  EXPECT_FALSE(cache.Get("k1", 7, &mock_data_url));
+  EXPECT_TRUE(cache.Get("k3", 7, &mock_data_url));
+}
+
+}  // namespace brave_shields
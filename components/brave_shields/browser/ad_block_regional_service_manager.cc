@@ -5,16 +5,19 @@
 
 #include "brave/components/brave_shields/browser/ad_block_regional_service_manager.h"
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 #include <vector>
 
+#include "base/bind.h"
 #include "base/strings/string_util.h"
 #include "base/task/post_task.h"
 #include "base/values.h"
 #include "brave/browser/brave_browser_process_impl.h"
 #include "brave/common/pref_names.h"
 #include "brave/components/brave_shields/browser/ad_block_regional_service.h"
+#include "brave/components/brave_shields/browser/ad_block_request.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
 #include "brave/components/brave_shields/browser/ad_block_service_helper.h"
 #include "brave/vendor/adblock_rust_ffi/src/wrapper.hpp"
@@ -30,7 +33,9 @@ namespace brave_shields {
 AdBlockRegionalServiceManager::AdBlockRegionalServiceManager(
     brave_component_updater::BraveComponent::Delegate* delegate)
     : delegate_(delegate),
-      initialized_(false) {
+      initialized_(false),
+      matching_services_generation_(
+          AdBlockBaseService::NextEngineGeneration()) {
   if (Init()) {
     initialized_ = true;
   }
@@ -87,6 +92,7 @@ void AdBlockRegionalServiceManager::StartRegionalServices() {
           std::make_pair(uuid, std::move(regional_service)));
     }
   }
+  UpdateMatchingServices(nullptr);
 }
 
 void AdBlockRegionalServiceManager::UpdateFilterListPrefs(
@@ -130,11 +136,21 @@ bool AdBlockRegionalServiceManager::ShouldStartRequest(
     bool* matching_exception_filter,
     bool* cancel_request_explicitly,
     std::string* mock_data_url) {
-  base::AutoLock lock(regional_services_lock_);
-  for (const auto& regional_service : regional_services_) {
-    if (!regional_service.second->ShouldStartRequest(
-            url, resource_type, tab_host, matching_exception_filter,
-            cancel_request_explicitly, mock_data_url)) {
+  return ShouldStartRequest(AdBlockRequest(url, resource_type, tab_host),
+                            matching_exception_filter,
+                            cancel_request_explicitly, mock_data_url);
+}
+
+bool AdBlockRegionalServiceManager::ShouldStartRequest(
+    const AdBlockRequest& request,
+    bool* matching_exception_filter,
+    bool* cancel_request_explicitly,
+    std::string* mock_data_url) {
+  DCHECK(delegate_->GetTaskRunner()->RunsTasksInCurrentSequence());
+  for (AdBlockRegionalService* regional_service : matching_services_) {
+    if (!regional_service->ShouldStartRequest(
+            request, matching_exception_filter, cancel_request_explicitly,
+            mock_data_url)) {
       return false;
     }
     if (matching_exception_filter && *matching_exception_filter) {
@@ -145,6 +161,19 @@ bool AdBlockRegionalServiceManager::ShouldStartRequest(
   return true;
 }
 
+AdBlockDecisionCache::Stats
+AdBlockRegionalServiceManager::GetDecisionCacheStats() {
+  AdBlockDecisionCache::Stats stats;
+  base::AutoLock lock(regional_services_lock_);
+  for (const auto& regional_service : regional_services_) {
+    const AdBlockDecisionCache::Stats service_stats =
+        regional_service.second->GetDecisionCacheStats();
+    stats.hits += service_stats.hits;
+    stats.misses += service_stats.misses;
+  }
+  return stats;
+}
+
 void AdBlockRegionalServiceManager::EnableTag(const std::string& tag,
                                               bool enabled) {
   base::AutoLock lock(regional_services_lock_);
@@ -175,11 +204,17 @@ void AdBlockRegionalServiceManager::EnableFilterList(const std::string& uuid,
       regional_service->Start();
       regional_services_.insert(
           std::make_pair(uuid, std::move(regional_service)));
+      UpdateMatchingServices(nullptr);
     } else {
       DCHECK(it != regional_services_.end());
+      // Matching tasks may still be queued for the service, so its engine
+      // is only released on the task runner by UpdateMatchingServices().
       it->second->Stop();
       it->second->Unregister();
+      std::unique_ptr<AdBlockRegionalService> removed_service =
+          std::move(it->second);
       regional_services_.erase(it);
+      UpdateMatchingServices(std::move(removed_service));
     }
   }
 
@@ -191,19 +226,55 @@ void AdBlockRegionalServiceManager::EnableFilterList(const std::string& uuid,
                      base::Unretained(this), uuid, enabled));
 }
 
+void AdBlockRegionalServiceManager::UpdateMatchingServices(
+    std::unique_ptr<AdBlockRegionalService> removed_service) {
+  regional_services_lock_.AssertAcquired();
+  std::vector<AdBlockRegionalService*> services;
+  services.reserve(regional_services_.size());
+  for (const auto& regional_service : regional_services_)
+    services.push_back(regional_service.second.get());
+
+  // Matching tasks queued before the new snapshot is installed still use
+  // |removed_service| and its engine. The engine is released right after the
+  // snapshot is replaced, and the reply owns the service so that it outlives
+  // that task.
+  AdBlockRegionalService* removed_service_ptr = removed_service.get();
+  delegate_->GetTaskRunner()->PostTaskAndReply(
+      FROM_HERE,
+      base::BindOnce(&AdBlockRegionalServiceManager::SetMatchingServices,
+                     base::Unretained(this), std::move(services),
+                     base::Unretained(removed_service_ptr)),
+      base::BindOnce([](std::unique_ptr<AdBlockRegionalService>) {},
+                     std::move(removed_service)));
+}
+
+void AdBlockRegionalServiceManager::SetMatchingServices(
+    std::vector<AdBlockRegionalService*> services,
+    AdBlockRegionalService* removed_service) {
+  DCHECK(delegate_->GetTaskRunner()->RunsTasksInCurrentSequence());
+  matching_services_ = std::move(services);
+  matching_services_generation_ = AdBlockBaseService::NextEngineGeneration();
+  if (removed_service)
+    removed_service->ReleaseAdBlockClient();
+}
+
+uint64_t AdBlockRegionalServiceManager::GetEngineGeneration() const {
+  DCHECK(delegate_->GetTaskRunner()->RunsTasksInCurrentSequence());
+  uint64_t generation = matching_services_generation_;
+  for (const AdBlockRegionalService* regional_service : matching_services_) {
+    generation = std::max(generation, regional_service->engine_generation());
+  }
+  return generation;
+}
+
 base::Optional<base::Value>
 AdBlockRegionalServiceManager::HostnameCosmeticResources(
         const std::string& hostname) {
-  auto it = this->regional_services_.begin();
-  if (it == this->regional_services_.end()) {
-    return base::Optional<base::Value>();
-  }
-  base::Optional<base::Value> first_value =
-      it->second->HostnameCosmeticResources(hostname);
-
-  for ( ; it != this->regional_services_.end(); it++) {
+  DCHECK(delegate_->GetTaskRunner()->RunsTasksInCurrentSequence());
+  base::Optional<base::Value> first_value;
+  for (AdBlockRegionalService* regional_service : matching_services_) {
     base::Optional<base::Value> next_value =
-        it->second->HostnameCosmeticResources(hostname);
+        regional_service->HostnameCosmeticResources(hostname);
     if (first_value) {
       if (next_value) {
         MergeResourcesInto(&*first_value, &*next_value, false);
@@ -221,16 +292,11 @@ AdBlockRegionalServiceManager::HiddenClassIdSelectors(
         const std::vector<std::string>& classes,
         const std::vector<std::string>& ids,
         const std::vector<std::string>& exceptions) {
-  auto it = this->regional_services_.begin();
-  if (it == this->regional_services_.end()) {
-    return base::Optional<base::Value>();
-  }
-  base::Optional<base::Value> first_value =
-      it->second->HiddenClassIdSelectors(classes, ids, exceptions);
-
-  for ( ; it != this->regional_services_.end(); it++) {
+  DCHECK(delegate_->GetTaskRunner()->RunsTasksInCurrentSequence());
+  base::Optional<base::Value> first_value;
+  for (AdBlockRegionalService* regional_service : matching_services_) {
     base::Optional<base::Value> next_value =
-        it->second->HiddenClassIdSelectors(classes, ids, exceptions);
+        regional_service->HiddenClassIdSelectors(classes, ids, exceptions);
     if (first_value && first_value->is_list()) {
       if (next_value && next_value->is_list()) {
         for (auto i = next_value->GetList().begin();
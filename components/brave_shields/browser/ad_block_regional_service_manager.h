@@ -17,6 +17,7 @@
 #include "base/synchronization/lock.h"
 #include "base/values.h"
 #include "brave/components/brave_component_updater/browser/brave_component.h"
+#include "brave/components/brave_shields/browser/ad_block_decision_cache.h"
 #include "content/public/common/resource_type.h"
 #include "url/gurl.h"
 
@@ -31,6 +32,7 @@ using brave_component_updater::BraveComponent;
 namespace brave_shields {
 
 class AdBlockRegionalService;
+struct AdBlockRequest;
 
 // The AdBlock regional service manager, in charge of initializing and
 // managing regional AdBlock clients.
@@ -51,12 +53,26 @@ class AdBlockRegionalServiceManager {
                           bool* matching_exception_filter,
                           bool* cancel_request_explicitly,
                           std::string* mock_data_url);
+  // Matches |request| against every enabled regional list. Must be called on
+  // the ad-block task runner and takes no lock.
+  bool ShouldStartRequest(const AdBlockRequest& request,
+                          bool* matching_exception_filter,
+                          bool* cancel_request_explicitly,
+                          std::string* mock_data_url);
   void EnableTag(const std::string& tag, bool enabled);
   void AddResources(const std::string& resources);
   void EnableFilterList(const std::string& uuid, bool enabled);
+  // Decision cache counters summed over every regional list.
+  AdBlockDecisionCache::Stats GetDecisionCacheStats();
 
+  // Must be called on the ad-block task runner.
   base::Optional<base::Value> HostnameCosmeticResources(
           const std::string& hostname);
+  // The latest AdBlockBaseService::engine_generation() of any enabled list,
+  // also advanced when lists are enabled or disabled. Must be called on the
+  // ad-block task runner.
+  uint64_t GetEngineGeneration() const;
+  // Must be called on the ad-block task runner.
   base::Optional<base::Value> HiddenClassIdSelectors(
           const std::vector<std::string>& classes,
           const std::vector<std::string>& ids,
@@ -64,15 +80,29 @@ class AdBlockRegionalServiceManager {
 
  private:
   friend class ::AdBlockServiceTest;
+  friend class AdBlockCosmeticResourcesServiceTest;
   bool Init();
   void StartRegionalServices();
   void UpdateFilterListPrefs(const std::string& uuid, bool enabled);
+  // Publishes the current set of regional services to the ad-block task
+  // runner. |removed_service|, if any, has its engine released on the task
+  // runner once the new set is installed and is destroyed on this thread
+  // afterwards. Must be called with |regional_services_lock_| held.
+  void UpdateMatchingServices(
+      std::unique_ptr<AdBlockRegionalService> removed_service);
+  void SetMatchingServices(std::vector<AdBlockRegionalService*> services,
+                           AdBlockRegionalService* removed_service);
 
   brave_component_updater::BraveComponent::Delegate* delegate_;  // NOT OWNED
   bool initialized_;
   base::Lock regional_services_lock_;
   std::map<std::string, std::unique_ptr<AdBlockRegionalService>>
       regional_services_;
+  // Snapshot of |regional_services_| used for request matching. Only
+  // accessed on the ad-block task runner.
+  std::vector<AdBlockRegionalService*> matching_services_;
+  // Taken when |matching_services_| was last replaced.
+  uint64_t matching_services_generation_;
 
   DISALLOW_COPY_AND_ASSIGN(AdBlockRegionalServiceManager);
 };
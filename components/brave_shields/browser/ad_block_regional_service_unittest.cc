@@ -3,8 +3,43 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this file,
  * You can obtain one at http://mozilla.org/MPL/2.0/. */
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/task/post_task.h"
+#include "base/threading/thread_restrictions.h"
 #include "brave/components/brave_shields/browser/ad_block_regional_service_manager.h"
+#include "brave/vendor/adblock_rust_ffi/src/wrapper.hpp"
+#include "content/public/test/browser_task_environment.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace {
+
+class TestComponentDelegate : public BraveComponent::Delegate {
+ public:
+  TestComponentDelegate()
+      : task_runner_(base::CreateSequencedTaskRunner({base::ThreadPool()})) {}
+  ~TestComponentDelegate() override = default;
+
+  void Register(const std::string& component_name,
+                const std::string& component_base64_public_key,
+                base::OnceClosure registered_callback,
+                BraveComponent::ReadyCallback ready_callback) override {}
+  bool Unregister(const std::string& component_id) override { return true; }
+  void OnDemandUpdate(const std::string& component_id) override {}
+  scoped_refptr<base::SequencedTaskRunner> GetTaskRunner() override {
+    return task_runner_;
+  }
+
+ private:
+  scoped_refptr<base::SequencedTaskRunner> task_runner_;
+};
+
+}  // namespace
 
 TEST(AdBlockRegionalServiceTest, UserModelLanguages) {
   std::vector<std::string> languages({ "fr", "fR", "fr-FR", "fr-ca" });
@@ -14,3 +49,54 @@ TEST(AdBlockRegionalServiceTest, UserModelLanguages) {
         language));
   });
 }
+
+TEST(AdBlockRegionalServiceTest, DisableFilterListWithQueuedMatchingTasks) {
+  content::BrowserTaskEnvironment task_environment;
+  TestComponentDelegate delegate;
+  brave_shields::AdBlockRegionalServiceManager manager(&delegate);
+  const std::string uuid = adblock::FilterList::GetRegionalLists()[0].uuid;
+  manager.EnableFilterList(uuid, true);
+  task_environment.RunUntilIdle();
+
+  // Hold the task runner so that matching tasks are still queued when the
+  // list is disabled.
+  base::WaitableEvent matching_allowed;
+  delegate.GetTaskRunner()->PostTask(
+      FROM_HERE, base::BindOnce(
+                     [](base::WaitableEvent* event) {
+                       base::ScopedAllowBaseSyncPrimitivesForTesting allow;
+                       event->Wait();
+                     },
+                     &matching_allowed));
+
+  bool should_start_request = false;
+  delegate.GetTaskRunner()->PostTask(
+      FROM_HERE,
+      base::BindOnce(
+          [](brave_shields::AdBlockRegionalServiceManager* manager,
+             bool* should_start_request) {
+            bool matching_exception_filter = false;
+            bool cancel_request_explicitly = false;
+            std::string mock_data_url;
+            *should_start_request = manager->ShouldStartRequest(
+                GURL("https://example.com/ad.js"),
+                content::ResourceType::kScript, "example.com",
+                &matching_exception_filter, &cancel_request_explicitly,
+                &mock_data_url);
+          },
+          &manager, &should_start_request));
+  delegate.GetTaskRunner()->PostTask(
+      FROM_HERE,
+      base::BindOnce(
+          [](brave_shields::AdBlockRegionalServiceManager* manager) {
+            manager->HostnameCosmeticResources("example.com");
+            manager->HiddenClassIdSelectors({"ad"}, {"banner"}, {});
+          },
+          &manager));
+
+  manager.EnableFilterList(uuid, false);
+  matching_allowed.Signal();
+  task_environment.RunUntilIdle();
+
+  EXPECT_TRUE(should_start_request);
+}
@@ -0,0 +1,149 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_request.h"
+
+#include "base/no_destructor.h"
+#include "net/base/registry_controlled_domains/registry_controlled_domain.h"
+#include "url/gurl.h"
+#include "url/origin.h"
+
+using namespace net::registry_controlled_domains;  // NOLINT
+
+namespace brave_shields {
+
+namespace {
+
+bool IsThirdParty(const GURL& url, const std::string& tab_host) {
+  // CreateFromNormalizedTuple is needed because SameDomainOrHost needs
+  // a URL or origin and not a string to a host name.
+  return !SameDomainOrHost(
+      url,
+      url::Origin::CreateFromNormalizedTuple("https", tab_host.c_str(), 80),
+      INCLUDE_PRIVATE_REGISTRIES);
+}
+
+std::string GetDecisionKey(const std::string& url_spec,
+                           const std::string& tab_host,
+                           const std::string& resource_type) {
+  // The request host and third-partiness are derived from the URL and the
+  // tab host, so they need not be part of the key. None of the parts can
+  // contain a newline, a canonical URL has it escaped, so the separators
+  // keep the key unambiguous.
+  std::string key;
+  key.reserve(resource_type.size() + tab_host.size() + url_spec.size() + 2);
+  key.append(resource_type);
+  key.push_back('\n');
+  key.append(tab_host);
+  key.push_back('\n');
+  key.append(url_spec);
+  return key;
+}
+
+}  // namespace
+
+const std::string& ResourceTypeToString(content::ResourceType resource_type) {
+  static const base::NoDestructor<std::string> kMainFrame("main_frame");
+  static const base::NoDestructor<std::string> kSubFrame("sub_frame");
+  static const base::NoDestructor<std::string> kStylesheet("stylesheet");
+  static const base::NoDestructor<std::string> kScript("script");
+  static const base::NoDestructor<std::string> kImage("image");
+  static const base::NoDestructor<std::string> kFont("font");
+  static const base::NoDestructor<std::string> kOther("other");
+  static const base::NoDestructor<std::string> kObject("object");
+  static const base::NoDestructor<std::string> kMedia("media");
+  static const base::NoDestructor<std::string> kXhr("xhr");
+  static const base::NoDestructor<std::string> kPing("ping");
+  static const base::NoDestructor<std::string> kNone("");
+
+  switch (resource_type) {
+    // top level page
+    case content::ResourceType::kMainFrame:
+      return *kMainFrame;
+    // frame or iframe
+    case content::ResourceType::kSubFrame:
+      return *kSubFrame;
+    // a CSS stylesheet
+    case content::ResourceType::kStylesheet:
+      return *kStylesheet;
+    // an external script
+    case content::ResourceType::kScript:
+      return *kScript;
+    // an image (jpg/gif/png/etc)
+    case content::ResourceType::kFavicon:
+    case content::ResourceType::kImage:
+      return *kImage;
+    // a font
+    case content::ResourceType::kFontResource:
+      return *kFont;
+    // an "other" subresource.
+    case content::ResourceType::kSubResource:
+      return *kOther;
+    // an object (or embed) tag for a plugin.
+    case content::ResourceType::kObject:
+      return *kObject;
+    // a media resource.
+    case content::ResourceType::kMedia:
+      return *kMedia;
+    // a XMLHttpRequest
+    case content::ResourceType::kXhr:
+      return *kXhr;
+    // a ping request for <a ping>/sendBeacon.
+    case content::ResourceType::kPing:
+      return *kPing;
+    // the main resource of a dedicated worker.
+    case content::ResourceType::kWorker:
+    // the main resource of a shared worker.
+    case content::ResourceType::kSharedWorker:
+    // an explicitly requested prefetch
+    case content::ResourceType::kPrefetch:
+    // the main resource of a service worker.
+    case content::ResourceType::kServiceWorker:
+    // a report of Content Security Policy violations.
+    case content::ResourceType::kCspReport:
+    // a resource that a plugin requested.
+    case content::ResourceType::kPluginResource:
+    default:
+      return *kNone;
+  }
+}
+
+const std::string& WebSocketResourceTypeString() {
+  static const base::NoDestructor<std::string> kWebSocket("websocket");
+  return *kWebSocket;
+}
+
+std::string GetAdBlockDecisionKey(const GURL& url,
+                                  content::ResourceType resource_type,
+                                  const std::string& tab_host) {
+  return GetAdBlockDecisionKey(url, ResourceTypeToString(resource_type),
+                               tab_host);
+}
+
+std::string GetAdBlockDecisionKey(const GURL& url,
+                                  const std::string& resource_type,
+                                  const std::string& tab_host) {
+  return GetDecisionKey(url.spec(), tab_host, resource_type);
+}
+
+AdBlockRequest::AdBlockRequest(const GURL& url,
+                               content::ResourceType resource_type,
+                               const std::string& tab_host)
+    : AdBlockRequest(url, ResourceTypeToString(resource_type), tab_host) {}
+
+AdBlockRequest::AdBlockRequest(const GURL& url,
+                               const std::string& resource_type,
+                               const std::string& tab_host)
+    : url_spec(url.spec()),
+      host(url.host()),
+      tab_host(tab_host),
+      resource_type(resource_type),
+      is_third_party(IsThirdParty(url, tab_host)),
+      decision_key(
+          GetDecisionKey(url_spec, tab_host, this->resource_type)) {}
+
+AdBlockRequest::~AdBlockRequest() = default;
+
+}  // namespace brave_shields
@@ -0,0 +1,65 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_REQUEST_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_REQUEST_H_
+
+#include <string>
+
+#include "base/macros.h"
+#include "content/public/common/resource_type.h"
+
+class GURL;
+
+namespace brave_shields {
+
+// Returns the adblock-rust filter option name for |resource_type|, or an
+// empty string if the type has no corresponding option.
+const std::string& ResourceTypeToString(content::ResourceType resource_type);
+
+// Returns the adblock-rust filter option name for WebSocket handshakes, which
+// have no content::ResourceType.
+const std::string& WebSocketResourceTypeString();
+
+// Returns the AdBlockRequest::decision_key of a request without computing
+// the rest of its features.
+std::string GetAdBlockDecisionKey(const GURL& url,
+                                  content::ResourceType resource_type,
+                                  const std::string& tab_host);
+std::string GetAdBlockDecisionKey(const GURL& url,
+                                  const std::string& resource_type,
+                                  const std::string& tab_host);
+
+// The features of a request that every ad-block engine is queried with.
+// Computed once per request so that matching against the default, regional
+// and custom filter engines does not repeat the same work for each engine.
+struct AdBlockRequest {
+  AdBlockRequest(const GURL& url,
+                 content::ResourceType resource_type,
+                 const std::string& tab_host);
+  // |resource_type| is a filter option name and must outlive the request,
+  // e.g. WebSocketResourceTypeString().
+  AdBlockRequest(const GURL& url,
+                 const std::string& resource_type,
+                 const std::string& tab_host);
+  ~AdBlockRequest();
+
+  const std::string url_spec;
+  const std::string host;
+  const std::string tab_host;
+  const std::string& resource_type;
+  const bool is_third_party;
+  // Everything above that affects matching, see AdBlockDecisionCache. Kept
+  // in full rather than hashed so that cached decisions are never applied to
+  // a different request. The full tab host is used rather than its eTLD+1
+  // because $domain= options may name a subdomain.
+  const std::string decision_key;
+
+  DISALLOW_COPY_AND_ASSIGN(AdBlockRequest);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_REQUEST_H_
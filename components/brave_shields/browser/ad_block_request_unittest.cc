@@ -0,0 +1,68 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_request.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace brave_shields {
+
+TEST(AdBlockRequestTest, FirstParty) {
+  const AdBlockRequest request(GURL("https://cdn.example.com/a.js"),
+                               content::ResourceType::kScript,
+                               "www.example.com");
+  EXPECT_EQ("https://cdn.example.com/a.js", request.url_spec);
+  EXPECT_EQ("cdn.example.com", request.host);
+  EXPECT_EQ("www.example.com", request.tab_host);
+  EXPECT_EQ("script", request.resource_type);
+  EXPECT_FALSE(request.is_third_party);
+}
+
+TEST(AdBlockRequestTest, ThirdParty) {
+  const AdBlockRequest request(GURL("https://tracker.test/pixel.gif"),
+                               content::ResourceType::kFavicon,
+                               "www.example.com");
+  EXPECT_EQ("image", request.resource_type);
+  EXPECT_TRUE(request.is_third_party);
+}
+
+TEST(AdBlockRequestTest, ResourceTypeWithoutFilterOption) {
+  EXPECT_EQ("", ResourceTypeToString(content::ResourceType::kServiceWorker));
+  EXPECT_EQ("sub_frame",
+            ResourceTypeToString(content::ResourceType::kSubFrame));
+}
+
+TEST(AdBlockRequestTest, WebSocket) {
+  const AdBlockRequest request(GURL("wss://socket.tracker.test/live"),
+                               WebSocketResourceTypeString(),
+                               "www.example.com");
+  EXPECT_EQ("socket.tracker.test", request.host);
+  EXPECT_EQ("websocket", request.resource_type);
+  EXPECT_TRUE(request.is_third_party);
+  // The same URL fetched any other way must not share a decision.
+  EXPECT_NE(request.decision_key,
+            GetAdBlockDecisionKey(GURL("wss://socket.tracker.test/live"),
+                                  content::ResourceType::kXhr,
+                                  "www.example.com"));
+}
+
+TEST(AdBlockRequestTest, DecisionKey) {
+  const GURL url("https://tracker.test/pixel.gif");
+  const AdBlockRequest request(url, content::ResourceType::kImage,
+                               "www.example.com");
+  EXPECT_EQ(request.decision_key,
+            GetAdBlockDecisionKey(url, content::ResourceType::kImage,
+                                  "www.example.com"));
+  EXPECT_NE(request.decision_key,
+            GetAdBlockDecisionKey(url, content::ResourceType::kImage,
+                                  "example.com"));
+  EXPECT_NE(request.decision_key,
+            GetAdBlockDecisionKey(GURL("https://tracker.test/pixel.png"),
+                                  content::ResourceType::kImage,
+                                  "www.example.com"));
+}
+
+}  // namespace brave_shields
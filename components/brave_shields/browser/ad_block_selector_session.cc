@@ -0,0 +1,67 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_selector_session.h"
+
+#include "base/values.h"
+
+namespace brave_shields {
+
+namespace {
+
+void AddNew(const std::vector<std::string>& names,
+            std::unordered_set<std::string>* seen,
+            std::vector<std::string>* new_names) {
+  for (const std::string& name : names) {
+    if (seen->insert(name).second)
+      new_names->push_back(name);
+  }
+}
+
+void TakeNew(const base::Value& selectors,
+             std::unordered_set<std::string>* seen,
+             std::vector<std::string>* new_selectors) {
+  if (!selectors.is_list())
+    return;
+  for (const base::Value& selector : selectors.GetList()) {
+    if (selector.is_string() && seen->insert(selector.GetString()).second)
+      new_selectors->push_back(selector.GetString());
+  }
+}
+
+}  // namespace
+
+AdBlockSelectorSession::AdBlockSelectorSession() : engine_generation_(0) {}
+
+AdBlockSelectorSession::~AdBlockSelectorSession() = default;
+
+void AdBlockSelectorSession::AddClassesAndIds(
+    const std::vector<std::string>& classes,
+    const std::vector<std::string>& ids,
+    uint64_t engine_generation,
+    std::vector<std::string>* new_classes,
+    std::vector<std::string>* new_ids) {
+  if (engine_generation != engine_generation_) {
+    engine_generation_ = engine_generation;
+    new_classes->assign(classes_.begin(), classes_.end());
+    new_ids->assign(ids_.begin(), ids_.end());
+  }
+  AddNew(classes, &classes_, new_classes);
+  AddNew(ids, &ids_, new_ids);
+}
+
+void AdBlockSelectorSession::TakeNewHideSelectors(
+    const base::Value& selectors,
+    std::vector<std::string>* new_selectors) {
+  TakeNew(selectors, &hide_selectors_, new_selectors);
+}
+
+void AdBlockSelectorSession::TakeNewForceHideSelectors(
+    const base::Value& selectors,
+    std::vector<std::string>* new_selectors) {
+  TakeNew(selectors, &force_hide_selectors_, new_selectors);
+}
+
+}  // namespace brave_shields
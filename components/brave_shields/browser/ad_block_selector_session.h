@@ -0,0 +1,64 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_SELECTOR_SESSION_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_SELECTOR_SESSION_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "base/macros.h"
+
+namespace base {
+class Value;
+}
+
+namespace brave_shields {
+
+// Tracks what a single frame has already been told about generic class and
+// id selectors, so that it only needs to send newly seen class and id names
+// and only receives selectors it does not have yet.
+class AdBlockSelectorSession {
+ public:
+  AdBlockSelectorSession();
+  ~AdBlockSelectorSession();
+
+  // Records |classes| and |ids| and returns the ones not seen before in
+  // |new_classes| and |new_ids|. When |engine_generation| differs from the
+  // previous call the engines have changed since, so every class and id
+  // seen so far is returned to be evaluated again.
+  void AddClassesAndIds(const std::vector<std::string>& classes,
+                        const std::vector<std::string>& ids,
+                        uint64_t engine_generation,
+                        std::vector<std::string>* new_classes,
+                        std::vector<std::string>* new_ids);
+
+  // Appends the strings of the |selectors| list that were not returned
+  // before as hide selectors to |new_selectors|.
+  void TakeNewHideSelectors(const base::Value& selectors,
+                            std::vector<std::string>* new_selectors);
+
+  // Same as TakeNewHideSelectors() for force-hide selectors, which skip the
+  // first-party check. These are tracked separately so that a selector
+  // already returned as a hide selector is still returned as force-hide.
+  void TakeNewForceHideSelectors(const base::Value& selectors,
+                                 std::vector<std::string>* new_selectors);
+
+ private:
+  std::unordered_set<std::string> classes_;
+  std::unordered_set<std::string> ids_;
+  std::unordered_set<std::string> hide_selectors_;
+  std::unordered_set<std::string> force_hide_selectors_;
+  uint64_t engine_generation_;
+
+  DISALLOW_COPY_AND_ASSIGN(AdBlockSelectorSession);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_SELECTOR_SESSION_H_
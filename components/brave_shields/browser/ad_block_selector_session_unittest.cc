@@ -0,0 +1,95 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_selector_session.h"
+
+#include "base/values.h"
+#include "testing/gmock/include/gmock/gmock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
+
+namespace brave_shields {
+
+TEST(AdBlockSelectorSessionTest, OnlyNewClassesAndIds) {
+  AdBlockSelectorSession session;
+  std::vector<std::string> new_classes;
+  std::vector<std::string> new_ids;
+  session.AddClassesAndIds({"ad", "banner"}, {"top"}, 1, &new_classes,
+                           &new_ids);
+  EXPECT_THAT(new_classes, ElementsAre("ad", "banner"));
+  EXPECT_THAT(new_ids, ElementsAre("top"));
+
+  new_classes.clear();
+  new_ids.clear();
+  session.AddClassesAndIds({"banner", "sidebar", "sidebar"}, {"top"}, 1,
+                           &new_classes, &new_ids);
+  EXPECT_THAT(new_classes, ElementsAre("sidebar"));
+  EXPECT_THAT(new_ids, IsEmpty());
+}
+
+TEST(AdBlockSelectorSessionTest, EngineChangeReevaluatesEverything) {
+  AdBlockSelectorSession session;
+  std::vector<std::string> new_classes;
+  std::vector<std::string> new_ids;
+  session.AddClassesAndIds({"ad"}, {"top"}, 1, &new_classes, &new_ids);
+
+  new_classes.clear();
+  new_ids.clear();
+  session.AddClassesAndIds({"banner"}, {}, 2, &new_classes, &new_ids);
+  EXPECT_THAT(new_classes, UnorderedElementsAre("ad", "banner"));
+  EXPECT_THAT(new_ids, ElementsAre("top"));
+}
+
+TEST(AdBlockSelectorSessionTest, OnlyNewSelectors) {
+  AdBlockSelectorSession session;
+  base::Value first(base::Value::Type::LIST);
+  first.Append(".ad");
+  first.Append("#top");
+  std::vector<std::string> selectors;
+  session.TakeNewHideSelectors(first, &selectors);
+  EXPECT_THAT(selectors, ElementsAre(".ad", "#top"));
+
+  base::Value second(base::Value::Type::LIST);
+  second.Append("#top");
+  second.Append(".banner");
+  second.Append(1);
+  selectors.clear();
+  session.TakeNewHideSelectors(second, &selectors);
+  EXPECT_THAT(selectors, ElementsAre(".banner"));
+
+  selectors.clear();
+  session.TakeNewHideSelectors(base::Value("not a list"), &selectors);
+  EXPECT_THAT(selectors, IsEmpty());
+}
+
+TEST(AdBlockSelectorSessionTest, HideSelectorIsStillForceHidden) {
+  AdBlockSelectorSession session;
+  // From the default list
+  base::Value default_selectors(base::Value::Type::LIST);
+  default_selectors.Append(".ad");
+  std::vector<std::string> hide_selectors;
+  session.TakeNewHideSelectors(default_selectors, &hide_selectors);
+  EXPECT_THAT(hide_selectors, ElementsAre(".ad"));
+
+  // From custom filters
+  base::Value custom_selectors(base::Value::Type::LIST);
+  custom_selectors.Append(".ad");
+  std::vector<std::string> force_hide_selectors;
+  session.TakeNewForceHideSelectors(custom_selectors, &force_hide_selectors);
+  EXPECT_THAT(force_hide_selectors, ElementsAre(".ad"));
+
+  force_hide_selectors.clear();
+  session.TakeNewForceHideSelectors(custom_selectors, &force_hide_selectors);
+  EXPECT_THAT(force_hide_selectors, IsEmpty());
+
+  hide_selectors.clear();
+  session.TakeNewHideSelectors(default_selectors, &hide_selectors);
+  EXPECT_THAT(hide_selectors, IsEmpty());
+}
+
+}  // namespace brave_shields
@@ -58,6 +58,18 @@ AdBlockService::AdBlockService(
 
 AdBlockService::~AdBlockService() {}
 
+bool AdBlockService::PrescreenRequest(const std::string& prescreen_key,
+                                      std::string* mock_data_url) {
+  return prescreen_cache_.Get(prescreen_key, CurrentEngineGeneration(),
+                              mock_data_url);
+}
+
+void AdBlockService::RecordBlockedRequest(const std::string& prescreen_key,
+                                          uint64_t engine_generation,
+                                          const std::string& mock_data_url) {
+  prescreen_cache_.Put(prescreen_key, engine_generation, mock_data_url);
+}
+
 bool AdBlockService::Init() {
   if (!AdBlockBaseService::Init())
     return false;
@@ -12,7 +12,9 @@
 #include <string>
 #include <vector>
 
+#include "base/memory/weak_ptr.h"
 #include "brave/components/brave_shields/browser/ad_block_base_service.h"
+#include "brave/components/brave_shields/browser/ad_block_prescreen_cache.h"
 #include "components/keyed_service/core/keyed_service.h"
 #include "components/prefs/pref_registry_simple.h"
 #include "content/public/browser/browser_thread.h"
@@ -43,6 +45,18 @@ class AdBlockService : public AdBlockBaseService {
   explicit AdBlockService(BraveComponent::Delegate* delegate);
   ~AdBlockService() override;
 
+  // Returns true if a request with |prescreen_key| is known to be blocked with
+  // a stub response by the current engines, |mock_data_url| receives the stub.
+  // Can be called from any thread.
+  bool PrescreenRequest(const std::string& prescreen_key,
+                        std::string* mock_data_url);
+  // Remembers that a request with |prescreen_key| was blocked with a stub
+  // response by the engines at |engine_generation|. Can be called from any
+  // thread.
+  void RecordBlockedRequest(const std::string& prescreen_key,
+                            uint64_t engine_generation,
+                            const std::string& mock_data_url);
+
  protected:
   bool Init() override;
   void OnComponentReady(const std::string& component_id,
@@ -59,6 +73,8 @@ class AdBlockService : public AdBlockBaseService {
       const std::string& component_id,
       const std::string& component_base64_public_key);
 
+  AdBlockPrescreenCache prescreen_cache_;
+
   base::WeakPtrFactory<AdBlockService> weak_factory_{this};
   DISALLOW_COPY_AND_ASSIGN(AdBlockService);
 };
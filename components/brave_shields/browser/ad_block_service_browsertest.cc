@@ -7,6 +7,7 @@
 #include "base/task/post_task.h"
 #include "base/test/thread_test_helper.h"
 #include "brave/browser/brave_browser_process_impl.h"
+#include "brave/browser/net/brave_ad_block_tp_network_delegate_helper.h"
 #include "brave/common/brave_paths.h"
 #include "brave/common/pref_names.h"
 #include "brave/components/brave_component_updater/browser/local_data_files_service.h"
@@ -14,6 +15,7 @@
 #include "brave/components/brave_shields/browser/ad_block_regional_service.h"
 #include "brave/components/brave_shields/browser/ad_block_regional_service_manager.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
+#include "brave/components/brave_shields/browser/brave_shields_util.h"
 #include "brave/components/brave_shields/browser/tracking_protection_service.h"
 #include "brave/components/brave_shields/common/brave_shield_constants.h"
 #include "brave/components/brave_shields/common/features.h"
@@ -27,7 +29,12 @@
 #include "content/public/browser/browser_thread.h"
 #include "content/public/test/browser_test_utils.h"
 #include "extensions/test/extension_test_message_listener.h"
+#include "net/base/network_isolation_key.h"
 #include "net/dns/mock_host_resolver.h"
+#include "net/test/spawned_test_server/spawned_test_server.h"
+#include "net/test/test_data_directory.h"
+#include "services/network/public/cpp/resource_request.h"
+#include "url/origin.h"
 
 using brave_shields::features::kBraveAdblockCosmeticFiltering;
 using content::BrowserThread;
@@ -223,6 +230,47 @@ class AdBlockServiceTest : public ExtensionBrowserTest {
     ASSERT_TRUE(io_helper->Run());
   }
 
+  void WaitForAdBlockTaskRunner() {
+    scoped_refptr<base::ThreadTestHelper> helper(new base::ThreadTestHelper(
+        g_brave_browser_process->ad_block_service()->GetTaskRunner()));
+    ASSERT_TRUE(helper->Run());
+  }
+
+  // Loads |tab_url| and XHRs |src| from it, which is expected to get a blank
+  // stub response if |expect_blocked|, and to load otherwise.
+  void NavigateAndXHR(const GURL& tab_url,
+                      const std::string& src,
+                      bool expect_blocked) {
+    ui_test_utils::NavigateToURL(browser(), tab_url);
+    content::WebContents* contents =
+        browser()->tab_strip_model()->GetActiveWebContents();
+
+    bool as_expected = false;
+    ASSERT_TRUE(ExecuteScriptAndExtractBool(
+        contents,
+        base::StringPrintf("setExpectations(0, 0, 0, %d, %d, 0);"
+                           "xhr('%s')",
+                           expect_blocked ? 0 : 1, expect_blocked ? 1 : 0,
+                           src.c_str()),
+        &as_expected));
+    EXPECT_TRUE(as_expected);
+  }
+
+  // Whether an XHR for |resource_url| from a page on |tab_url| would be
+  // answered by the ad-block prescreen.
+  bool IsXHRPrescreened(const GURL& tab_url, const GURL& resource_url) {
+    network::ResourceRequest request;
+    request.url = resource_url;
+    request.resource_type = static_cast<int>(content::ResourceType::kXhr);
+    const url::Origin tab_origin = url::Origin::Create(tab_url);
+    request.trusted_params = network::ResourceRequest::TrustedParams();
+    request.trusted_params->network_isolation_key =
+        net::NetworkIsolationKey(tab_origin, tab_origin);
+    std::string mock_data_url;
+    return brave::PrescreenAdBlockedRequest(request, browser()->profile(), -1,
+                                            -1, &mock_data_url);
+  }
+
   void WaitForBraveExtensionShieldsDataReady() {
     // Sometimes, the page can start loading before the Shields panel has
     // received information about the window and tab it's loaded in.
@@ -788,6 +836,224 @@ IN_PROC_BROWSER_TEST_F(AdBlockServiceTest, RedirectRulesAreRespected) {
   EXPECT_EQ(browser()->profile()->GetPrefs()->GetUint64(kAdsBlocked), 1ULL);
 }
 
+// Once a resource has been blocked, loading it again is answered by the
+// prescreen and still counts as blocked.
+IN_PROC_BROWSER_TEST_F(AdBlockServiceTest, PrescreenAnswersRepeatedBlocks) {
+  UpdateAdBlockInstanceWithRules("adbanner.js");
+  EXPECT_EQ(browser()->profile()->GetPrefs()->GetUint64(kAdsBlocked), 0ULL);
+
+  const GURL tab_url =
+      embedded_test_server()->GetURL("example.com", kAdBlockTestPage);
+  const GURL resource_url =
+      embedded_test_server()->GetURL("example.com", "/adbanner.js");
+  EXPECT_FALSE(IsXHRPrescreened(tab_url, resource_url));
+
+  NavigateAndXHR(tab_url, "adbanner.js", true);
+  EXPECT_EQ(browser()->profile()->GetPrefs()->GetUint64(kAdsBlocked), 1ULL);
+  EXPECT_TRUE(IsXHRPrescreened(tab_url, resource_url));
+
+  NavigateAndXHR(tab_url, "adbanner.js", true);
+  EXPECT_EQ(browser()->profile()->GetPrefs()->GetUint64(kAdsBlocked), 2ULL);
+  EXPECT_TRUE(IsXHRPrescreened(tab_url, resource_url));
+}
+
+// Redirect rules are answered by the prescreen with the same stub.
+IN_PROC_BROWSER_TEST_F(AdBlockServiceTest, PrescreenAnswersRedirectRules) {
+  UpdateAdBlockInstanceWithRules(
+      "js_mock_me.js$redirect=noopjs",
+      R"(
+      [
+        {
+          "name": "noop.js",
+          "aliases": ["noopjs"],
+          "kind": {
+            "mime":"application/javascript"
+          },
+          "content": "KGZ1bmN0aW9uKCkgewogICAgJ3VzZSBzdHJpY3QnOwp9KSgpOwo="
+        }
+      ])");
+
+  const GURL url = embedded_test_server()->GetURL("example.com",
+                                                  kAdBlockTestPage);
+  const GURL resource_url =
+      embedded_test_server()->GetURL("example.com", "/js_mock_me.js");
+  const std::string noopjs = "(function() {\\n    \\'use strict\\';\\n})();\\n";
+  for (int i = 0; i < 2; ++i) {
+    ui_test_utils::NavigateToURL(browser(), url);
+    content::WebContents* contents =
+        browser()->tab_strip_model()->GetActiveWebContents();
+    bool as_expected = false;
+    ASSERT_TRUE(ExecuteScriptAndExtractBool(
+        contents,
+        base::StringPrintf("setExpectations(0, 0, 0, 1, 0, 0);"
+                           "xhr_expect_content('%s', '%s');",
+                           resource_url.spec().c_str(), noopjs.c_str()),
+        &as_expected));
+    EXPECT_TRUE(as_expected);
+    EXPECT_TRUE(IsXHRPrescreened(url, resource_url));
+  }
+  EXPECT_EQ(browser()->profile()->GetPrefs()->GetUint64(kAdsBlocked), 2ULL);
+}
+
+// Allowing ads for a site stops the prescreen from answering its requests.
+IN_PROC_BROWSER_TEST_F(AdBlockServiceTest, PrescreenRespectsAllowedAds) {
+  UpdateAdBlockInstanceWithRules("adbanner.js");
+  const GURL tab_url =
+      embedded_test_server()->GetURL("example.com", kAdBlockTestPage);
+  const GURL resource_url =
+      embedded_test_server()->GetURL("example.com", "/adbanner.js");
+  NavigateAndXHR(tab_url, "adbanner.js", true);
+  EXPECT_EQ(browser()->profile()->GetPrefs()->GetUint64(kAdsBlocked), 1ULL);
+  ASSERT_TRUE(IsXHRPrescreened(tab_url, resource_url));
+
+  brave_shields::SetAdControlType(browser()->profile(),
+                                  brave_shields::ControlType::ALLOW, tab_url);
+  EXPECT_FALSE(IsXHRPrescreened(tab_url, resource_url));
+  NavigateAndXHR(tab_url, "adbanner.js", false);
+  EXPECT_EQ(browser()->profile()->GetPrefs()->GetUint64(kAdsBlocked), 1ULL);
+}
+
+// Turning Shields off for a site stops the prescreen from answering its
+// requests.
+IN_PROC_BROWSER_TEST_F(AdBlockServiceTest, PrescreenRespectsShieldsDown) {
+  UpdateAdBlockInstanceWithRules("adbanner.js");
+  const GURL tab_url =
+      embedded_test_server()->GetURL("example.com", kAdBlockTestPage);
+  const GURL resource_url =
+      embedded_test_server()->GetURL("example.com", "/adbanner.js");
+  NavigateAndXHR(tab_url, "adbanner.js", true);
+  EXPECT_EQ(browser()->profile()->GetPrefs()->GetUint64(kAdsBlocked), 1ULL);
+  ASSERT_TRUE(IsXHRPrescreened(tab_url, resource_url));
+
+  brave_shields::SetBraveShieldsEnabled(browser()->profile(), false, tab_url);
+  EXPECT_FALSE(IsXHRPrescreened(tab_url, resource_url));
+  NavigateAndXHR(tab_url, "adbanner.js", false);
+  EXPECT_EQ(browser()->profile()->GetPrefs()->GetUint64(kAdsBlocked), 1ULL);
+}
+
+// Prescreen entries are dropped when any engine or the set of enabled lists
+// changes, and recorded again by the next blocked load.
+IN_PROC_BROWSER_TEST_F(AdBlockServiceTest,
+                       PrescreenForgetsBlocksAfterEngineChange) {
+  UpdateAdBlockInstanceWithRules("adbanner.js");
+  const GURL tab_url =
+      embedded_test_server()->GetURL("example.com", kAdBlockTestPage);
+  const GURL resource_url =
+      embedded_test_server()->GetURL("example.com", "/adbanner.js");
+  NavigateAndXHR(tab_url, "adbanner.js", true);
+  ASSERT_TRUE(IsXHRPrescreened(tab_url, resource_url));
+
+  // The default engine is replaced.
+  UpdateAdBlockInstanceWithRules("adbanner.js");
+  EXPECT_FALSE(IsXHRPrescreened(tab_url, resource_url));
+  NavigateAndXHR(tab_url, "adbanner.js", true);
+  ASSERT_TRUE(IsXHRPrescreened(tab_url, resource_url));
+
+  // Custom filters change.
+  ASSERT_TRUE(g_brave_browser_process->ad_block_custom_filters_service()
+                  ->UpdateCustomFilters("normal.js"));
+  WaitForAdBlockTaskRunner();
+  EXPECT_FALSE(IsXHRPrescreened(tab_url, resource_url));
+  NavigateAndXHR(tab_url, "adbanner.js", true);
+  ASSERT_TRUE(IsXHRPrescreened(tab_url, resource_url));
+
+  // A regional list is enabled.
+  g_brave_browser_process->ad_block_regional_service_manager()
+      ->EnableFilterList(kAdBlockEasyListFranceUUID, true);
+  WaitForAdBlockTaskRunner();
+  EXPECT_FALSE(IsXHRPrescreened(tab_url, resource_url));
+
+  EXPECT_EQ(browser()->profile()->GetPrefs()->GetUint64(kAdsBlocked), 3ULL);
+}
+
+class AdBlockServiceWebSocketTest : public AdBlockServiceTest {
+ public:
+  AdBlockServiceWebSocketTest()
+      : ws_server_(net::SpawnedTestServer::TYPE_WS,
+                   net::GetWebSocketTestDataDirectory()) {}
+
+  void SetUpOnMainThread() override {
+    AdBlockServiceTest::SetUpOnMainThread();
+    ASSERT_TRUE(ws_server_.Start());
+  }
+
+  // Returns true if a socket to |path| on the WebSocket server could be
+  // opened from the active tab.
+  bool OpenWebSocket(const std::string& path) {
+    content::WebContents* contents =
+        browser()->tab_strip_model()->GetActiveWebContents();
+    bool opened = false;
+    EXPECT_TRUE(ExecuteScriptAndExtractBool(
+        contents,
+        base::StringPrintf(
+            "(() => {"
+            "  const socket = new WebSocket('%s');"
+            "  socket.onopen = () => {"
+            "    socket.close();"
+            "    window.domAutomationController.send(true);"
+            "  };"
+            "  socket.onerror = () => {"
+            "    window.domAutomationController.send(false);"
+            "  };"
+            "})();",
+            ws_server_.GetURL(path).spec().c_str()),
+        &opened));
+    return opened;
+  }
+
+ private:
+  net::SpawnedTestServer ws_server_;
+};
+
+// WebSocket handshakes are matched as "websocket" requests, and blocked ones
+// are reported to Shields.
+IN_PROC_BROWSER_TEST_F(AdBlockServiceWebSocketTest, WebSocketsGetBlocked) {
+  UpdateAdBlockInstanceWithRules("echo-with-no-extension?ad$websocket");
+  EXPECT_EQ(browser()->profile()->GetPrefs()->GetUint64(kAdsBlocked), 0ULL);
+
+  ui_test_utils::NavigateToURL(
+      browser(),
+      embedded_test_server()->GetURL("example.com", kAdBlockTestPage));
+  EXPECT_FALSE(OpenWebSocket("echo-with-no-extension?ad"));
+  EXPECT_EQ(browser()->profile()->GetPrefs()->GetUint64(kAdsBlocked), 1ULL);
+
+  EXPECT_TRUE(OpenWebSocket("echo-with-no-extension?chat"));
+  EXPECT_EQ(browser()->profile()->GetPrefs()->GetUint64(kAdsBlocked), 1ULL);
+
+  // A repeated handshake, answered from the filter's decisions, is blocked
+  // and reported again.
+  ui_test_utils::NavigateToURL(
+      browser(),
+      embedded_test_server()->GetURL("example.com", kAdBlockTestPage));
+  EXPECT_FALSE(OpenWebSocket("echo-with-no-extension?ad"));
+  EXPECT_EQ(browser()->profile()->GetPrefs()->GetUint64(kAdsBlocked), 2ULL);
+}
+
+// Rules for other request types do not apply to WebSocket handshakes.
+IN_PROC_BROWSER_TEST_F(AdBlockServiceWebSocketTest,
+                       WebSocketsIgnoreRulesForOtherTypes) {
+  UpdateAdBlockInstanceWithRules("echo-with-no-extension?ad$script");
+
+  ui_test_utils::NavigateToURL(
+      browser(),
+      embedded_test_server()->GetURL("example.com", kAdBlockTestPage));
+  EXPECT_TRUE(OpenWebSocket("echo-with-no-extension?ad"));
+  EXPECT_EQ(browser()->profile()->GetPrefs()->GetUint64(kAdsBlocked), 0ULL);
+}
+
+// Turning Shields off for a site lets its sockets through.
+IN_PROC_BROWSER_TEST_F(AdBlockServiceWebSocketTest,
+                       WebSocketsAllowedWithShieldsDown) {
+  UpdateAdBlockInstanceWithRules("echo-with-no-extension?ad$websocket");
+  const GURL tab_url =
+      embedded_test_server()->GetURL("example.com", kAdBlockTestPage);
+  brave_shields::SetBraveShieldsEnabled(browser()->profile(), false, tab_url);
+
+  ui_test_utils::NavigateToURL(browser(), tab_url);
+  EXPECT_TRUE(OpenWebSocket("echo-with-no-extension?ad"));
+  EXPECT_EQ(browser()->profile()->GetPrefs()->GetUint64(kAdsBlocked), 0ULL);
+}
+
 class CosmeticFilteringDisabledTest : public AdBlockServiceTest {
  public:
   CosmeticFilteringDisabledTest() {
@@ -10,8 +10,11 @@
 
 #include "base/compiler_specific.h"
 #include "base/containers/flat_map.h"
+#include "base/containers/mru_cache.h"
 #include "base/no_destructor.h"
+#include "base/stl_util.h"
 #include "base/strings/string_split.h"
+#include "base/synchronization/lock.h"
 #include "net/base/data_url.h"
 #include "net/http/http_util.h"
 #include "services/network/public/cpp/resource_request.h"
@@ -20,6 +23,8 @@
 namespace brave_shields {
 namespace {
 
+constexpr size_t kMockResourceCacheSize = 32;
+
 // Everything but jpeg is a transparent pixel.
 const unsigned char kWebp1x1[] = {
     0x52, 0x49, 0x46, 0x46, 0x1a, 0x00, 0x00, 0x00, 0x57, 0x45, 0x42, 0x50,
@@ -55,35 +60,92 @@ const unsigned char kJpeg1x1[] = {
 // 'Accept' header that starts with "image/webp". However, it is possible to
 // craft a custom 'Accept', for example, using XHR, so we provide stubs for
 // other popular mime types.
-std::string GetContentForMimeType(const std::string& mime_type) {
-  static const base::NoDestructor<base::flat_map<std::string, std::string>>
+scoped_refptr<base::RefCountedMemory> GetContentForMimeType(
+    const std::string& mime_type) {
+  static const base::NoDestructor<
+      base::flat_map<std::string, scoped_refptr<base::RefCountedMemory>>>
       content({
-          {"image/webp", {kWebp1x1, std::end(kWebp1x1)}},
-          {"image/*", {kPng1x1, std::end(kPng1x1)}},
-          {"image/apng", {kPng1x1, std::end(kPng1x1)}},
-          {"image/png", {kPng1x1, std::end(kPng1x1)}},
-          {"image/x-png", {kPng1x1, std::end(kPng1x1)}},
-          {"image/gif", {kGif1x1, std::end(kGif1x1)}},
-          {"image/jpeg", {kJpeg1x1, std::end(kJpeg1x1)}},
+          {"image/webp", new base::RefCountedStaticMemory(
+                             kWebp1x1, base::size(kWebp1x1))},
+          {"image/*", new base::RefCountedStaticMemory(
+                          kPng1x1, base::size(kPng1x1))},
+          {"image/apng", new base::RefCountedStaticMemory(
+                             kPng1x1, base::size(kPng1x1))},
+          {"image/png", new base::RefCountedStaticMemory(
+                            kPng1x1, base::size(kPng1x1))},
+          {"image/x-png", new base::RefCountedStaticMemory(
+                              kPng1x1, base::size(kPng1x1))},
+          {"image/gif", new base::RefCountedStaticMemory(
+                            kGif1x1, base::size(kGif1x1))},
+          {"image/jpeg", new base::RefCountedStaticMemory(
+                             kJpeg1x1, base::size(kJpeg1x1))},
       });
   auto it = content->find(mime_type);
   if (it == content->end()) {
-    return {};
+    return nullptr;
   }
   return it->second;
 }
 
+// A parsed ad-block mock data URL.
+struct MockResource {
+  bool valid = false;
+  std::string mime_type;
+  scoped_refptr<base::RefCountedMemory> data;
+};
+
+// Ad-block only redirects to a handful of mock resources, parse each of them
+// once and share the result between all the responses using it.
+MockResource GetMockResource(const std::string& data_url) {
+  static base::NoDestructor<base::Lock> lock;
+  static base::NoDestructor<base::HashingMRUCache<std::string, MockResource>>
+      cache(kMockResourceCacheSize);
+
+  base::AutoLock auto_lock(*lock);
+  auto it = cache->Get(data_url);
+  if (it != cache->end()) {
+    return it->second;
+  }
+
+  MockResource resource;
+  std::string charset;
+  std::string url_data;
+  if (!net::DataURL::Parse(GURL(data_url), &resource.mime_type, &charset,
+                           &url_data)) {
+    LOG(ERROR) << "Could not parse ad-block data URL: " << data_url;
+  } else {
+    resource.valid = true;
+    if (!url_data.empty())
+      resource.data = base::RefCountedString::TakeString(&url_data);
+  }
+  cache->Put(data_url, resource);
+  return resource;
+}
+
 }  // namespace
 
 void MakeStubResponse(const base::Optional<std::string>& data_url,
                       const network::ResourceRequest& request,
                       network::mojom::URLResponseHeadPtr* response,
                       std::string* data) {
-  DCHECK(response && *response);
   DCHECK(data);
+  scoped_refptr<base::RefCountedMemory> body =
+      MakeStubResponse(data_url, request, response);
+  if (body) {
+    data->assign(body->front_as<char>(), body->size());
+  } else {
+    data->clear();
+  }
+}
+
+scoped_refptr<base::RefCountedMemory> MakeStubResponse(
+    const base::Optional<std::string>& data_url,
+    const network::ResourceRequest& request,
+    network::mojom::URLResponseHeadPtr* response) {
+  DCHECK(response && *response);
 
   (*response)->mime_type = "text/html";
-  *data = {};
+  scoped_refptr<base::RefCountedMemory> data;
 
   // Possibly overwrite mime and stub data.
   std::string accept_header;
@@ -97,20 +159,16 @@ void MakeStubResponse(const base::Optional<std::string>& data_url,
     if (mime_types.front()[0] != '*') {
       (*response)->mime_type = mime_types.front();
     }
-    *data = GetContentForMimeType((*response)->mime_type);
+    data = GetContentForMimeType((*response)->mime_type);
   }
 
   if (data_url.has_value() && !data_url->empty()) {
-    std::string charset;
-    std::string mime_type;
-    std::string url_data;
-    if (!net::DataURL::Parse(GURL(data_url.value()), &mime_type, &charset,
-                             &url_data)) {
-      LOG(ERROR) << "Could not parse ad-block data URL: " << data_url.value();
-    } else {
-      *data = std::move(url_data);
-      if (!mime_type.empty() && data_url.value().find("data:,") != 0) {
-        (*response)->mime_type = mime_type;
+    MockResource resource = GetMockResource(data_url.value());
+    if (resource.valid) {
+      data = std::move(resource.data);
+      if (!resource.mime_type.empty() &&
+          data_url.value().find("data:,") != 0) {
+        (*response)->mime_type = resource.mime_type;
       }
     }
   }
@@ -125,6 +183,7 @@ void MakeStubResponse(const base::Optional<std::string>& data_url,
       (*response)->mime_type + "\r\n";
   (*response)->headers = new net::HttpResponseHeaders(
       net::HttpUtil::AssembleRawHeaders(raw_headers));
+  return data;
 }
 
 }  // namespace brave_shields
@@ -7,6 +7,8 @@
 #define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_ADBLOCK_STUB_RESPONSE_H_
 
 #include <string>
+
+#include "base/memory/ref_counted_memory.h"
 #include "base/optional.h"
 #include "services/network/public/mojom/url_response_head.mojom-forward.h"
 
@@ -23,6 +25,14 @@ void MakeStubResponse(const base::Optional<std::string>& data_url,
                       network::mojom::URLResponseHeadPtr* response,
                       std::string* data);
 
+// Same as above, but returns the body from storage shared by every response
+// with the same stub, so nothing is copied per request. Returns nullptr for
+// an empty body.
+scoped_refptr<base::RefCountedMemory> MakeStubResponse(
+    const base::Optional<std::string>& data_url,
+    const network::ResourceRequest& request,
+    network::mojom::URLResponseHeadPtr* response);
+
 }  // namespace brave_shields
 
 #endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_ADBLOCK_STUB_RESPONSE_H_
@@ -58,3 +58,35 @@ TEST(AdBlockStubResponse, HTMLDataURLNoMimeTypeUsesAcceptHeader) {
   ASSERT_EQ(data, "<num>pi</num>");
   ASSERT_EQ(resource_response->mime_type, "text/xml");
 }
+
+TEST(AdBlockStubResponse, StubDataIsShared) {
+  network::ResourceRequest request;
+  request.headers.AddHeadersFromString("Accept: image/webp,*/*");
+  auto first_response = network::mojom::URLResponseHead::New();
+  auto second_response = network::mojom::URLResponseHead::New();
+  auto first = brave_shields::MakeStubResponse(base::nullopt, request,
+                                               &first_response);
+  auto second = brave_shields::MakeStubResponse(base::nullopt, request,
+                                                &second_response);
+  ASSERT_TRUE(first);
+  EXPECT_EQ(first.get(), second.get());
+  EXPECT_EQ(first_response->mime_type, "image/webp");
+
+  std::string data_url = "data:application/javascript,(function(){})()";
+  first = brave_shields::MakeStubResponse(data_url, {}, &first_response);
+  second = brave_shields::MakeStubResponse(data_url, {}, &second_response);
+  ASSERT_TRUE(first);
+  EXPECT_EQ(first.get(), second.get());
+  EXPECT_EQ(std::string(first->front_as<char>(), first->size()),
+            "(function(){})()");
+  EXPECT_EQ(second_response->mime_type, "application/javascript");
+}
+
+TEST(AdBlockStubResponse, EmptyStubHasNoData) {
+  network::ResourceRequest request;
+  request.headers.AddHeadersFromString("Accept: text/css");
+  auto resource_response = network::mojom::URLResponseHead::New();
+  EXPECT_FALSE(
+      brave_shields::MakeStubResponse("", request, &resource_response));
+  EXPECT_EQ(resource_response->mime_type, "text/css");
+}
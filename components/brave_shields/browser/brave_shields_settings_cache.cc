@@ -0,0 +1,84 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/brave_shields_settings_cache.h"
+
+#include <memory>
+
+#include "brave/components/brave_shields/browser/brave_shields_util.h"
+#include "chrome/browser/content_settings/host_content_settings_map_factory.h"
+#include "chrome/browser/profiles/profile.h"
+#include "components/content_settings/core/browser/host_content_settings_map.h"
+#include "content/public/browser/browser_thread.h"
+#include "url/gurl.h"
+
+namespace brave_shields {
+
+namespace {
+
+const char kShieldsSettingsCacheKey[] = "brave_shields_settings_cache";
+
+}  // namespace
+
+ShieldsSettingsCache::ShieldsSettingsCache(HostContentSettingsMap* map)
+    : map_(map), settings_(kMaxCachedOrigins) {
+  map_->AddObserver(this);
+}
+
+ShieldsSettingsCache::~ShieldsSettingsCache() {
+  map_->RemoveObserver(this);
+}
+
+// static
+ShieldsSettingsCache* ShieldsSettingsCache::GetForProfile(Profile* profile) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  ShieldsSettingsCache* cache = static_cast<ShieldsSettingsCache*>(
+      profile->GetUserData(kShieldsSettingsCacheKey));
+
+  if (!cache) {
+    // Object cleanup is handled by SupportsUserData
+    profile->SetUserData(
+        kShieldsSettingsCacheKey,
+        std::make_unique<ShieldsSettingsCache>(
+            HostContentSettingsMapFactory::GetForProfile(profile)));
+    cache = static_cast<ShieldsSettingsCache*>(
+        profile->GetUserData(kShieldsSettingsCacheKey));
+  }
+  return cache;
+}
+
+const ShieldsSettings& ShieldsSettingsCache::Get(const GURL& tab_origin) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  auto it = settings_.Get(tab_origin.spec());
+  if (it != settings_.end()) {
+    stats_.hits++;
+    return it->second;
+  }
+
+  stats_.rebuilds++;
+  ShieldsSettings settings;
+  settings.shields_enabled = GetBraveShieldsEnabled(map_.get(), tab_origin);
+  settings.allow_ads =
+      GetAdControlType(map_.get(), tab_origin) == ControlType::ALLOW;
+  settings.https_everywhere_enabled =
+      GetHTTPSEverywhereEnabled(map_.get(), tab_origin);
+  settings.allow_referrers = AllowReferrers(map_.get(), tab_origin);
+  return settings_.Put(tab_origin.spec(), settings)->second;
+}
+
+void ShieldsSettingsCache::OnContentSettingChanged(
+    const ContentSettingsPattern& primary_pattern,
+    const ContentSettingsPattern& secondary_pattern,
+    ContentSettingsType content_type,
+    const std::string& resource_identifier) {
+  // Shields settings are stored as plugin resources. A single change can
+  // affect any number of origins through its patterns, so start over.
+  if (content_type == ContentSettingsType::PLUGINS ||
+      content_type == ContentSettingsType::DEFAULT) {
+    settings_.Clear();
+  }
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,73 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_BRAVE_SHIELDS_SETTINGS_CACHE_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_BRAVE_SHIELDS_SETTINGS_CACHE_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include "base/containers/mru_cache.h"
+#include "base/macros.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/supports_user_data.h"
+#include "components/content_settings/core/browser/content_settings_observer.h"
+
+class GURL;
+class HostContentSettingsMap;
+class Profile;
+
+namespace brave_shields {
+
+// The shields settings network delegate helpers look at for a tab origin.
+struct ShieldsSettings {
+  bool shields_enabled = true;
+  bool allow_ads = false;
+  bool https_everywhere_enabled = true;
+  bool allow_referrers = false;
+};
+
+// Per-profile cache of ShieldsSettings keyed by tab origin, so that the
+// subresources of a page don't each walk the content settings rules again.
+// Any change to the shields content settings drops the whole cache.
+// Must be used on the UI thread.
+class ShieldsSettingsCache : public base::SupportsUserData::Data,
+                             public content_settings::Observer {
+ public:
+  static constexpr size_t kMaxCachedOrigins = 64;
+
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t rebuilds = 0;
+  };
+
+  explicit ShieldsSettingsCache(HostContentSettingsMap* map);
+  ~ShieldsSettingsCache() override;
+
+  static ShieldsSettingsCache* GetForProfile(Profile* profile);
+
+  const ShieldsSettings& Get(const GURL& tab_origin);
+
+  const Stats& stats() const { return stats_; }
+  size_t size() const { return settings_.size(); }
+
+ private:
+  // content_settings::Observer overrides:
+  void OnContentSettingChanged(const ContentSettingsPattern& primary_pattern,
+                               const ContentSettingsPattern& secondary_pattern,
+                               ContentSettingsType content_type,
+                               const std::string& resource_identifier) override;
+
+  scoped_refptr<HostContentSettingsMap> map_;
+  base::HashingMRUCache<std::string, ShieldsSettings> settings_;
+  Stats stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(ShieldsSettingsCache);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_BRAVE_SHIELDS_SETTINGS_CACHE_H_
@@ -0,0 +1,85 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <memory>
+
+#include "base/macros.h"
+#include "brave/components/brave_shields/browser/brave_shields_settings_cache.h"
+#include "brave/components/brave_shields/browser/brave_shields_util.h"
+#include "chrome/test/base/testing_profile.h"
+#include "content/public/test/browser_task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+using brave_shields::ControlType;
+using brave_shields::ShieldsSettings;
+using brave_shields::ShieldsSettingsCache;
+
+class ShieldsSettingsCacheTest : public testing::Test {
+ public:
+  ShieldsSettingsCacheTest() = default;
+  ~ShieldsSettingsCacheTest() override = default;
+
+  void SetUp() override { profile_ = std::make_unique<TestingProfile>(); }
+
+  TestingProfile* profile() { return profile_.get(); }
+
+  ShieldsSettingsCache* cache() {
+    return ShieldsSettingsCache::GetForProfile(profile());
+  }
+
+ private:
+  content::BrowserTaskEnvironment task_environment_;
+  std::unique_ptr<TestingProfile> profile_;
+
+  DISALLOW_COPY_AND_ASSIGN(ShieldsSettingsCacheTest);
+};
+
+TEST_F(ShieldsSettingsCacheTest, MatchesShieldsUtil) {
+  const GURL origin("https://brave.com/");
+  brave_shields::SetBraveShieldsEnabled(profile(), false, origin);
+  brave_shields::SetAdControlType(profile(), ControlType::ALLOW, origin);
+  brave_shields::SetHTTPSEverywhereEnabled(profile(), false, origin);
+
+  for (const GURL& url : {origin, GURL("https://example.com/"), GURL()}) {
+    const ShieldsSettings& settings = cache()->Get(url);
+    EXPECT_EQ(brave_shields::GetBraveShieldsEnabled(profile(), url),
+              settings.shields_enabled);
+    EXPECT_EQ(brave_shields::GetAdControlType(profile(), url) ==
+                  ControlType::ALLOW,
+              settings.allow_ads);
+    EXPECT_EQ(brave_shields::GetHTTPSEverywhereEnabled(profile(), url),
+              settings.https_everywhere_enabled);
+    EXPECT_EQ(brave_shields::AllowReferrers(profile(), url),
+              settings.allow_referrers);
+  }
+}
+
+TEST_F(ShieldsSettingsCacheTest, ReusesSnapshotPerOrigin) {
+  const GURL origin("https://brave.com/");
+  EXPECT_TRUE(cache()->Get(origin).shields_enabled);
+  EXPECT_TRUE(cache()->Get(origin).shields_enabled);
+  cache()->Get(GURL("https://example.com/"));
+
+  EXPECT_EQ(1u, cache()->stats().hits);
+  EXPECT_EQ(2u, cache()->stats().rebuilds);
+  EXPECT_EQ(2u, cache()->size());
+}
+
+TEST_F(ShieldsSettingsCacheTest, ContentSettingChangeInvalidates) {
+  const GURL origin("https://brave.com/");
+  EXPECT_TRUE(cache()->Get(origin).shields_enabled);
+  EXPECT_FALSE(cache()->Get(origin).allow_ads);
+
+  brave_shields::SetBraveShieldsEnabled(profile(), false, origin);
+  EXPECT_EQ(0u, cache()->size());
+  EXPECT_FALSE(cache()->Get(origin).shields_enabled);
+
+  brave_shields::SetAdControlType(profile(), ControlType::ALLOW, origin);
+  EXPECT_TRUE(cache()->Get(origin).allow_ads);
+
+  EXPECT_EQ(1u, cache()->stats().hits);
+  EXPECT_EQ(3u, cache()->stats().rebuilds);
+}
@@ -184,9 +184,13 @@ void SetAdControlType(Profile* profile, ControlType type, const GURL& url) {
 }
 
 ControlType GetAdControlType(Profile* profile, const GURL& url) {
-  ContentSetting setting =
-      HostContentSettingsMapFactory::GetForProfile(profile)->GetContentSetting(
-          url, GURL(), ContentSettingsType::PLUGINS, kAds);
+  return GetAdControlType(
+      HostContentSettingsMapFactory::GetForProfile(profile), url);
+}
+
+ControlType GetAdControlType(HostContentSettingsMap* map, const GURL& url) {
+  ContentSetting setting = map->GetContentSetting(
+      url, GURL(), ContentSettingsType::PLUGINS, kAds);
 
   return setting == CONTENT_SETTING_ALLOW ? ControlType::ALLOW
                                           : ControlType::BLOCK;
@@ -358,9 +362,13 @@ void ResetHTTPSEverywhereEnabled(Profile* profile,
 }
 
 bool GetHTTPSEverywhereEnabled(Profile* profile, const GURL& url) {
-  ContentSetting setting =
-      HostContentSettingsMapFactory::GetForProfile(profile)->GetContentSetting(
-          url, GURL(), ContentSettingsType::PLUGINS, kHTTPUpgradableResources);
+  return GetHTTPSEverywhereEnabled(
+      HostContentSettingsMapFactory::GetForProfile(profile), url);
+}
+
+bool GetHTTPSEverywhereEnabled(HostContentSettingsMap* map, const GURL& url) {
+  ContentSetting setting = map->GetContentSetting(
+      url, GURL(), ContentSettingsType::PLUGINS, kHTTPUpgradableResources);
 
   return setting == CONTENT_SETTING_ALLOW ? false : true;
 }
@@ -37,6 +37,7 @@ bool GetBraveShieldsEnabled(HostContentSettingsMap* map, const GURL& url);
 
 void SetAdControlType(Profile* profile, ControlType type, const GURL& url);
 ControlType GetAdControlType(Profile* profile, const GURL& url);
+ControlType GetAdControlType(HostContentSettingsMap* map, const GURL& url);
 
 void SetCookieControlType(Profile* profile, ControlType type, const GURL& url);
 void SetCookieControlType(HostContentSettingsMap* map,
@@ -60,6 +61,7 @@ void SetHTTPSEverywhereEnabled(Profile* profile, bool enable, const GURL& url);
 void SetHTTPSEverywhereEnabled(Profile* profile, bool enable, const GURL& url);
 void ResetHTTPSEverywhereEnabled(Profile* profile, const GURL& url);
 bool GetHTTPSEverywhereEnabled(Profile* profile, const GURL& url);
+bool GetHTTPSEverywhereEnabled(HostContentSettingsMap* map, const GURL& url);
 
 void SetNoScriptControlType(Profile* profile,
                             ControlType type,
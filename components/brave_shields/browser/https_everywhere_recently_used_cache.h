@@ -6,40 +6,134 @@
 #ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RECENTLY_USED_CACHE_H_
 #define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RECENTLY_USED_CACHE_H_
 
+#include <stdint.h>
+
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "base/containers/mru_cache.h"
+#include "base/hash/hash.h"
+#include "base/logging.h"
+#include "base/macros.h"
 #include "base/synchronization/lock.h"
+#include "base/trace_event/memory_usage_estimator.h"
 
+// Thread-safe LRU cache of HTTPS Everywhere lookups keyed by URL spec.
+// Entries are spread across independently locked shards so that concurrent
+// lookups from many loading tabs rarely contend, and the cache is bounded by
+// an approximate memory budget rather than an entry count. Only the shard is
+// picked by hash, entries are keyed by the full URL spec so that a hash
+// collision can never return the rewrite of another URL.
 template <class T> class HTTPSERecentlyUsedCache {
  public:
-  explicit HTTPSERecentlyUsedCache(size_t size = 100) : data_(size) {}
+  static constexpr size_t kDefaultMemoryBudget = 256 * 1024;
+  static constexpr size_t kDefaultShardCount = 16;
+
+  struct ShardStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+  };
+
+  explicit HTTPSERecentlyUsedCache(
+      size_t memory_budget = kDefaultMemoryBudget,
+      size_t shard_count = kDefaultShardCount) {
+    DCHECK_GT(shard_count, 0u);
+    const size_t shard_budget = memory_budget / shard_count;
+    for (size_t i = 0; i < shard_count; ++i)
+      shards_.push_back(std::make_unique<Shard>(shard_budget));
+  }
 
   void add(const std::string& key, const T& value) {
-    base::AutoLock create(lock_);
-    data_.Put(key, value);
+    Shard* shard = GetShard(key);
+    base::AutoLock lock(shard->lock);
+    auto it = shard->data.Peek(key);
+    if (it != shard->data.end()) {
+      shard->bytes -= EstimateEntrySize(it->first, it->second);
+      shard->data.Erase(it);
+    }
+    shard->data.Put(key, value);
+    shard->bytes += EstimateEntrySize(key, value);
+    while (shard->bytes > shard->budget && !shard->data.empty()) {
+      auto oldest = shard->data.rbegin();
+      shard->bytes -= EstimateEntrySize(oldest->first, oldest->second);
+      shard->data.Erase(oldest);
+    }
   }
 
   bool get(const std::string& key, T* value) {
-    base::AutoLock create(lock_);
-    auto it = data_.Get(key);
-    if (it != data_.end()) {
+    Shard* shard = GetShard(key);
+    base::AutoLock lock(shard->lock);
+    auto it = shard->data.Get(key);
+    if (it != shard->data.end()) {
       *value = it->second;
+      shard->hits++;
       return true;
     }
+    shard->misses++;
     return false;
   }
 
   void remove(const std::string& key) {
-    base::AutoLock lock(lock_);
-    auto it = data_.Peek(key);
-    if (it != data_.end())
-      data_.Erase(it);
+    Shard* shard = GetShard(key);
+    base::AutoLock lock(shard->lock);
+    auto it = shard->data.Peek(key);
+    if (it != shard->data.end()) {
+      shard->bytes -= EstimateEntrySize(it->first, it->second);
+      shard->data.Erase(it);
+    }
+  }
+
+  std::vector<ShardStats> GetShardStats() const {
+    std::vector<ShardStats> stats(shards_.size());
+    for (size_t i = 0; i < shards_.size(); ++i) {
+      base::AutoLock lock(shards_[i]->lock);
+      stats[i].hits = shards_[i]->hits;
+      stats[i].misses = shards_[i]->misses;
+      stats[i].entries = shards_[i]->data.size();
+      stats[i].bytes = shards_[i]->bytes;
+    }
+    return stats;
+  }
+
+  // Approximate heap cost of caching |value| under |key|, including the
+  // container bookkeeping.
+  static size_t EstimateEntrySize(const std::string& key, const T& value) {
+    // Hash map node, which holds a copy of the key, plus the doubly linked
+    // list node holding the pair.
+    constexpr size_t kEntryOverhead =
+        sizeof(std::string) + 4 * sizeof(void*);
+    return kEntryOverhead + sizeof(std::pair<std::string, T>) +
+           2 * base::trace_event::EstimateMemoryUsage(key) +
+           base::trace_event::EstimateMemoryUsage(value);
   }
 
  private:
-  base::MRUCache<std::string, T> data_;
-  base::Lock lock_;
+  struct Shard {
+    explicit Shard(size_t budget)
+        : budget(budget),
+          data(base::HashingMRUCache<std::string, T>::NO_AUTO_EVICT) {}
+
+    const size_t budget;
+    mutable base::Lock lock;
+    base::HashingMRUCache<std::string, T> data;
+    size_t bytes = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+  };
+
+  Shard* GetShard(const std::string& key) const {
+    // The shard's hash map buckets by std::hash, a different hash keeps
+    // shard and bucket choice independent.
+    return shards_[base::FastHash(key) % shards_.size()].get();
+  }
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+
+  DISALLOW_COPY_AND_ASSIGN(HTTPSERecentlyUsedCache);
 };
 
 #endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RECENTLY_USED_CACHE_H_
@@ -10,9 +10,10 @@
 
 TEST(HTTPSEverywhereRecentlyUsedCacheTest, Operations) {
   using Cache = HTTPSERecentlyUsedCache<std::string>;
-  Cache cache(3);
+  // A single shard with room for exactly three entries of this size.
+  Cache cache(3 * Cache::EstimateEntrySize("kA", "vA"), 1);
 
-  // Test add/get and check that max size is maintained.
+  // Test add/get and check that the memory budget is maintained.
   cache.add("kA", "vA");
   cache.add("kB", "vB");
   cache.add("kC", "vC");
@@ -24,7 +25,73 @@ TEST(HTTPSEverywhereRecentlyUsedCacheTest, Operations) {
   ASSERT_FALSE(cache.get("kB", &v));
   ASSERT_TRUE(cache.get("kD", &v));
 
+  // Re-adding an existing key replaces the value without evicting.
+  cache.add("kD", "vE");
+  ASSERT_TRUE(cache.get("kD", &v));
+  ASSERT_STREQ(v.c_str(), "vE");
+  ASSERT_TRUE(cache.get("kA", &v));
+  ASSERT_TRUE(cache.get("kC", &v));
+
   // Test remove.
   cache.remove("kD");
   ASSERT_FALSE(cache.get("kD", &v));
 }
+
+TEST(HTTPSEverywhereRecentlyUsedCacheTest, ShardStats) {
+  using Cache = HTTPSERecentlyUsedCache<std::string>;
+  Cache cache(Cache::kDefaultMemoryBudget, 4);
+
+  for (int i = 0; i < 100; ++i)
+    cache.add("http://example.com/" + std::to_string(i), "value");
+
+  std::string v;
+  for (int i = 0; i < 100; ++i)
+    ASSERT_TRUE(cache.get("http://example.com/" + std::to_string(i), &v));
+  for (int i = 100; i < 150; ++i)
+    ASSERT_FALSE(cache.get("http://example.com/" + std::to_string(i), &v));
+
+  const auto stats = cache.GetShardStats();
+  ASSERT_EQ(4u, stats.size());
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  size_t entries = 0;
+  size_t bytes = 0;
+  size_t expected_bytes = 0;
+  for (int i = 0; i < 100; ++i) {
+    expected_bytes += Cache::EstimateEntrySize(
+        "http://example.com/" + std::to_string(i), "value");
+  }
+  for (const auto& shard : stats) {
+    hits += shard.hits;
+    misses += shard.misses;
+    entries += shard.entries;
+    bytes += shard.bytes;
+    EXPECT_LE(shard.bytes, Cache::kDefaultMemoryBudget / 4);
+  }
+  EXPECT_EQ(100u, hits);
+  EXPECT_EQ(50u, misses);
+  EXPECT_EQ(100u, entries);
+  EXPECT_EQ(expected_bytes, bytes);
+}
+
+TEST(HTTPSEverywhereRecentlyUsedCacheTest, OversizedValueIsNotKept) {
+  using Cache = HTTPSERecentlyUsedCache<std::string>;
+  Cache cache(Cache::EstimateEntrySize("kA", "v"), 1);
+
+  cache.add("kA", std::string(1024, 'a'));
+  std::string v;
+  EXPECT_FALSE(cache.get("kA", &v));
+  EXPECT_EQ(0u, cache.GetShardStats()[0].bytes);
+}
+
+TEST(HTTPSEverywhereRecentlyUsedCacheTest, KeysAreComparedInFull) {
+  using Cache = HTTPSERecentlyUsedCache<std::string>;
+  Cache cache(Cache::kDefaultMemoryBudget, 1);
+
+  cache.add("http://example.com/a", "https://example.com/a");
+  std::string v;
+  EXPECT_FALSE(cache.get("http://example.com/b", &v));
+  EXPECT_FALSE(cache.get("http://example.com/a/", &v));
+  ASSERT_TRUE(cache.get("http://example.com/a", &v));
+  EXPECT_EQ("https://example.com/a", v);
+}
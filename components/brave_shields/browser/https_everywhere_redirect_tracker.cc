@@ -0,0 +1,44 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/https_everywhere_redirect_tracker.h"
+
+namespace brave_shields {
+
+HTTPSERedirectTracker::HTTPSERedirectTracker(unsigned int max_redirects)
+    : max_redirects_(max_redirects), redirects_(kMaxTrackedRequests) {}
+
+HTTPSERedirectTracker::~HTTPSERedirectTracker() = default;
+
+bool HTTPSERedirectTracker::ShouldRedirect(
+    uint64_t request_identifier) const {
+  base::AutoLock auto_lock(lock_);
+  auto it = redirects_.Peek(request_identifier);
+  return it == redirects_.end() || it->second < max_redirects_ - 1;
+}
+
+void HTTPSERedirectTracker::AddRedirect(uint64_t request_identifier) {
+  base::AutoLock auto_lock(lock_);
+  auto it = redirects_.Get(request_identifier);
+  if (it != redirects_.end()) {
+    it->second++;
+    return;
+  }
+  redirects_.Put(request_identifier, 1);
+}
+
+void HTTPSERedirectTracker::RemoveRequest(uint64_t request_identifier) {
+  base::AutoLock auto_lock(lock_);
+  auto it = redirects_.Peek(request_identifier);
+  if (it != redirects_.end())
+    redirects_.Erase(it);
+}
+
+size_t HTTPSERedirectTracker::size() const {
+  base::AutoLock auto_lock(lock_);
+  return redirects_.size();
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,50 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_REDIRECT_TRACKER_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_REDIRECT_TRACKER_H_
+
+#include <stdint.h>
+
+#include "base/containers/mru_cache.h"
+#include "base/macros.h"
+#include "base/synchronization/lock.h"
+
+namespace brave_shields {
+
+// Counts HTTPS Everywhere redirects per in-flight request so that rules which
+// bounce between http and https cannot loop forever. Entries are keyed by
+// request identifier and dropped when the request is destroyed. Safe to use
+// from any thread.
+class HTTPSERedirectTracker {
+ public:
+  // Upper bound on tracked requests. Entries are normally removed by
+  // |RemoveRequest|, this only guards against identifiers that are never
+  // reported as destroyed. The least recently redirected request is evicted
+  // first.
+  static constexpr size_t kMaxTrackedRequests = 10000;
+
+  explicit HTTPSERedirectTracker(unsigned int max_redirects);
+  ~HTTPSERedirectTracker();
+
+  // Returns false once |request_identifier| has been redirected
+  // |max_redirects| - 1 times.
+  bool ShouldRedirect(uint64_t request_identifier) const;
+  void AddRedirect(uint64_t request_identifier);
+  void RemoveRequest(uint64_t request_identifier);
+
+  size_t size() const;
+
+ private:
+  const unsigned int max_redirects_;
+  mutable base::Lock lock_;
+  base::HashingMRUCache<uint64_t, unsigned int> redirects_;
+
+  DISALLOW_COPY_AND_ASSIGN(HTTPSERedirectTracker);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_REDIRECT_TRACKER_H_
@@ -0,0 +1,118 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <memory>
+#include <vector>
+
+#include "base/threading/simple_thread.h"
+#include "brave/components/brave_shields/browser/https_everywhere_redirect_tracker.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace brave_shields {
+
+namespace {
+
+constexpr unsigned int kMaxRedirects = 5;
+
+// Drives |kRequestsPerThread| requests with distinct identifiers through the
+// full redirect limit and then destroys them.
+class RedirectDelegate : public base::DelegateSimpleThread::Delegate {
+ public:
+  static constexpr uint64_t kRequestsPerThread = 1000;
+
+  RedirectDelegate(HTTPSERedirectTracker* tracker, uint64_t first_id)
+      : tracker_(tracker), first_id_(first_id) {}
+
+  void Run() override {
+    for (uint64_t id = first_id_; id < first_id_ + kRequestsPerThread; ++id) {
+      unsigned int redirects = 0;
+      while (tracker_->ShouldRedirect(id)) {
+        tracker_->AddRedirect(id);
+        redirects++;
+      }
+      if (redirects != kMaxRedirects - 1)
+        failures_++;
+    }
+    for (uint64_t id = first_id_; id < first_id_ + kRequestsPerThread; ++id)
+      tracker_->RemoveRequest(id);
+  }
+
+  int failures() const { return failures_; }
+
+ private:
+  HTTPSERedirectTracker* tracker_;
+  const uint64_t first_id_;
+  int failures_ = 0;
+};
+
+}  // namespace
+
+TEST(HTTPSERedirectTrackerTest, LimitsRedirectsPerRequest) {
+  HTTPSERedirectTracker tracker(kMaxRedirects);
+  for (unsigned int i = 0; i < kMaxRedirects - 1; ++i) {
+    EXPECT_TRUE(tracker.ShouldRedirect(1));
+    tracker.AddRedirect(1);
+  }
+  EXPECT_FALSE(tracker.ShouldRedirect(1));
+  // Other requests are tracked independently.
+  EXPECT_TRUE(tracker.ShouldRedirect(2));
+  tracker.AddRedirect(2);
+  EXPECT_FALSE(tracker.ShouldRedirect(1));
+  EXPECT_EQ(2u, tracker.size());
+
+  tracker.RemoveRequest(1);
+  EXPECT_TRUE(tracker.ShouldRedirect(1));
+  EXPECT_EQ(1u, tracker.size());
+}
+
+TEST(HTTPSERedirectTrackerTest, BoundedSize) {
+  HTTPSERedirectTracker tracker(kMaxRedirects);
+  for (uint64_t id = 0; id < HTTPSERedirectTracker::kMaxTrackedRequests + 10;
+       ++id) {
+    tracker.AddRedirect(id);
+  }
+  EXPECT_LE(tracker.size(), HTTPSERedirectTracker::kMaxTrackedRequests);
+}
+
+TEST(HTTPSERedirectTrackerTest, EvictsOldestRequestWhenFull) {
+  constexpr uint64_t kMax = HTTPSERedirectTracker::kMaxTrackedRequests;
+  HTTPSERedirectTracker tracker(kMaxRedirects);
+  for (uint64_t id = 0; id < kMax; ++id)
+    tracker.AddRedirect(id);
+  // Drive the newest request to the limit.
+  while (tracker.ShouldRedirect(kMax - 1))
+    tracker.AddRedirect(kMax - 1);
+
+  // A new request evicts only the oldest one, the newest keeps its count.
+  tracker.AddRedirect(kMax);
+  EXPECT_EQ(kMax, tracker.size());
+  EXPECT_FALSE(tracker.ShouldRedirect(kMax - 1));
+  tracker.RemoveRequest(0);
+  EXPECT_EQ(kMax, tracker.size());
+}
+
+TEST(HTTPSERedirectTrackerTest, ConcurrentRequests) {
+  constexpr int kThreads = 8;
+  HTTPSERedirectTracker tracker(kMaxRedirects);
+
+  std::vector<std::unique_ptr<RedirectDelegate>> delegates;
+  std::vector<std::unique_ptr<base::DelegateSimpleThread>> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    delegates.push_back(std::make_unique<RedirectDelegate>(
+        &tracker, i * RedirectDelegate::kRequestsPerThread));
+    threads.push_back(std::make_unique<base::DelegateSimpleThread>(
+        delegates.back().get(), "HTTPSERedirectTrackerTest"));
+  }
+  for (auto& thread : threads)
+    thread->Start();
+  for (auto& thread : threads)
+    thread->Join();
+
+  for (const auto& delegate : delegates)
+    EXPECT_EQ(0, delegate->failures());
+  EXPECT_EQ(0u, tracker.size());
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,225 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/https_everywhere_rule_index.h"
+
+#include <unordered_set>
+#include <utility>
+
+#include "base/json/json_reader.h"
+#include "base/logging.h"
+#include "base/strings/string_split.h"
+#include "base/values.h"
+#include "third_party/leveldatabase/src/include/leveldb/db.h"
+#include "third_party/re2/src/re2/re2.h"
+#include "url/gurl.h"
+
+namespace brave_shields {
+
+namespace {
+
+// Returns the labels of |host| in reverse order joined with dots, e.g.
+// "www.example.com" becomes "com.example.www". |boundaries| receives the
+// length of each reversed prefix ("com", "com.example", ...). A fully
+// qualified host ("www.example.com.") is looked up without its trailing dot.
+std::string ReverseHost(base::StringPiece host,
+                        std::vector<size_t>* boundaries) {
+  if (!host.empty() && host.back() == '.')
+    host.remove_suffix(1);
+  std::vector<base::StringPiece> labels = base::SplitStringPiece(
+      host, ".", base::KEEP_WHITESPACE, base::SPLIT_WANT_ALL);
+  std::string reversed;
+  reversed.reserve(host.size());
+  for (auto it = labels.rbegin(); it != labels.rend(); ++it) {
+    if (!reversed.empty())
+      reversed.push_back('.');
+    it->AppendToString(&reversed);
+    boundaries->push_back(reversed.size());
+  }
+  return reversed;
+}
+
+std::unique_ptr<re2::RE2> CompilePattern(const std::string& pattern) {
+  auto regex = std::make_unique<re2::RE2>(pattern, re2::RE2::Quiet);
+  if (!regex->ok())
+    return nullptr;
+  return regex;
+}
+
+}  // namespace
+
+HTTPSEverywhereRuleIndex::Rule::Rule() : upgrade_scheme(false) {}
+HTTPSEverywhereRuleIndex::Rule::Rule(Rule&& other) = default;
+HTTPSEverywhereRuleIndex::Rule::~Rule() = default;
+
+HTTPSEverywhereRuleIndex::Target::Target() = default;
+HTTPSEverywhereRuleIndex::Target::Target(Target&& other) = default;
+HTTPSEverywhereRuleIndex::Target::~Target() = default;
+
+HTTPSEverywhereRuleIndex::HTTPSEverywhereRuleIndex() = default;
+
+HTTPSEverywhereRuleIndex::~HTTPSEverywhereRuleIndex() = default;
+
+// static
+std::unique_ptr<HTTPSEverywhereRuleIndex>
+HTTPSEverywhereRuleIndex::CreateFromDB(leveldb::DB* db) {
+  if (!db)
+    return nullptr;
+
+  auto index = std::make_unique<HTTPSEverywhereRuleIndex>();
+  leveldb::ReadOptions options;
+  options.fill_cache = false;
+  std::unique_ptr<leveldb::Iterator> it(db->NewIterator(options));
+  for (it->SeekToFirst(); it->Valid(); it->Next()) {
+    if (!index->AddRuleSet(it->key().ToString(), it->value().ToString())) {
+      LOG(WARNING) << "Skipping malformed HTTPS Everywhere rule for "
+                   << it->key().ToString();
+    }
+  }
+  if (!it->status().ok()) {
+    LOG(ERROR) << "HTTPS Everywhere rule iteration error: "
+               << it->status().ToString();
+    return nullptr;
+  }
+  index->rule_sets_by_json_.clear();
+  return index;
+}
+
+bool HTTPSEverywhereRuleIndex::AddRuleSet(const std::string& key,
+                                          const std::string& rule) {
+  auto compiled = rule_sets_by_json_.find(rule);
+  if (compiled != rule_sets_by_json_.end()) {
+    rule_sets_[key] = compiled->second;
+    return true;
+  }
+
+  base::Optional<base::Value> json_object = base::JSONReader::Read(rule);
+  if (!json_object || !json_object->is_list())
+    return false;
+
+  auto rule_set = std::make_shared<RuleSet>();
+  for (const base::Value& target_value : json_object->GetList()) {
+    if (!target_value.is_dict())
+      continue;
+
+    Target target;
+    const base::Value* exclusions = target_value.FindListKey("e");
+    if (exclusions) {
+      for (const base::Value& exclusion : exclusions->GetList()) {
+        if (!exclusion.is_dict())
+          continue;
+        const std::string* pattern = exclusion.FindStringKey("p");
+        if (!pattern)
+          continue;
+        auto regex = CompilePattern(CorrectToRuleToRE2Engine(*pattern));
+        if (regex)
+          target.exclusions.push_back(std::move(regex));
+      }
+    }
+
+    // A target without rules ends evaluation of the whole rule set, so
+    // anything following it can never apply.
+    const base::Value* rules = target_value.FindListKey("r");
+    if (!rules)
+      break;
+
+    for (const base::Value& rule_value : rules->GetList()) {
+      if (!rule_value.is_dict())
+        continue;
+      Rule rule;
+      if (rule_value.FindKey("d")) {
+        // The default rule always applies, later rules are unreachable.
+        rule.upgrade_scheme = true;
+        target.rules.push_back(std::move(rule));
+        break;
+      }
+      const std::string* from = rule_value.FindStringKey("f");
+      const std::string* to = rule_value.FindStringKey("t");
+      if (!from || !to)
+        continue;
+      rule.from = CompilePattern(*from);
+      if (!rule.from)
+        continue;
+      rule.to = CorrectToRuleToRE2Engine(*to);
+      target.rules.push_back(std::move(rule));
+    }
+    rule_set->push_back(std::move(target));
+  }
+
+  rule_sets_[key] = rule_set;
+  rule_sets_by_json_[rule] = std::move(rule_set);
+  return true;
+}
+
+std::string HTTPSEverywhereRuleIndex::Rewrite(const GURL& url) const {
+  if (rule_sets_.empty() || !url.has_host())
+    return "";
+
+  std::vector<size_t> boundaries;
+  const std::string reversed_host = ReverseHost(url.host(), &boundaries);
+  if (boundaries.size() < 2)
+    return "";
+
+  // Exact host first, then wildcard entries for successively shorter
+  // suffixes. A bare TLD wildcard ("com.*") is never looked up.
+  std::string key = reversed_host;
+  for (size_t i = boundaries.size() - 1; i > 0; --i) {
+    if (i != boundaries.size() - 1) {
+      key.assign(reversed_host, 0, boundaries[i]);
+      key.append(".*");
+    }
+    auto it = rule_sets_.find(key);
+    if (it == rule_sets_.end())
+      continue;
+    std::string new_url = ApplyRuleSet(*it->second, url.spec());
+    if (!new_url.empty())
+      return new_url;
+  }
+  return "";
+}
+
+size_t HTTPSEverywhereRuleIndex::GetCompiledRuleSetCount() const {
+  std::unordered_set<const RuleSet*> compiled;
+  for (const auto& rule_set : rule_sets_)
+    compiled.insert(rule_set.second.get());
+  return compiled.size();
+}
+
+std::string HTTPSEverywhereRuleIndex::ApplyRuleSet(
+    const RuleSet& rule_set,
+    const std::string& url_spec) const {
+  for (const Target& target : rule_set) {
+    for (const auto& exclusion : target.exclusions) {
+      if (re2::RE2::FullMatch(url_spec, *exclusion))
+        return "";
+    }
+    for (const Rule& rule : target.rules) {
+      if (rule.upgrade_scheme) {
+        std::string new_url(url_spec);
+        return new_url.insert(4, "s");
+      }
+      std::string new_url(url_spec);
+      if (re2::RE2::Replace(&new_url, *rule.from, rule.to) &&
+          new_url != url_spec) {
+        return new_url;
+      }
+    }
+  }
+  return "";
+}
+
+// static
+std::string HTTPSEverywhereRuleIndex::CorrectToRuleToRE2Engine(
+    const std::string& to) {
+  std::string corrected_to(to);
+  size_t pos = corrected_to.find('$');
+  while (std::string::npos != pos) {
+    corrected_to[pos] = '\\';
+    pos = corrected_to.find('$', pos + 1);
+  }
+  return corrected_to;
+}
+
+}  // namespace brave_shields
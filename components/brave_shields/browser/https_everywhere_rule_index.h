@@ -0,0 +1,97 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RULE_INDEX_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RULE_INDEX_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/macros.h"
+
+class GURL;
+
+namespace leveldb {
+class DB;
+}
+
+namespace re2 {
+class RE2;
+}
+
+namespace brave_shields {
+
+// In-memory, precompiled form of the HTTPS Everywhere ruleset. The ruleset
+// is shipped as a LevelDB keyed by reversed host ("com.example.www" or
+// "com.example.*" for wildcards) with a JSON rule list as the value. The
+// index parses that JSON and compiles every regular expression once at load
+// time so that |Rewrite| does no JSON parsing or regex compilation.
+class HTTPSEverywhereRuleIndex {
+ public:
+  HTTPSEverywhereRuleIndex();
+  ~HTTPSEverywhereRuleIndex();
+
+  // Builds an index from every entry in |db|. Returns nullptr if |db| is null
+  // or could not be iterated.
+  static std::unique_ptr<HTTPSEverywhereRuleIndex> CreateFromDB(
+      leveldb::DB* db);
+
+  // Parses the JSON |rule| stored under the reversed host |key| and adds it to
+  // the index. Returns false if |rule| could not be parsed. The ruleset stores
+  // the same JSON under every target host of a rule set, so a |rule| that has
+  // been added before shares the rules compiled for it the first time.
+  bool AddRuleSet(const std::string& key, const std::string& rule);
+
+  // Returns the HTTPS rewrite of |url| or an empty string if no rule applies.
+  std::string Rewrite(const GURL& url) const;
+
+  // Number of lookup keys.
+  size_t size() const { return rule_sets_.size(); }
+
+  // Number of distinct compiled rule sets shared by the lookup keys.
+  size_t GetCompiledRuleSetCount() const;
+
+  // HTTPS Everywhere uses $1 style back references, RE2 expects \1.
+  static std::string CorrectToRuleToRE2Engine(const std::string& to);
+
+ private:
+  struct Rule {
+    Rule();
+    Rule(Rule&& other);
+    ~Rule();
+
+    // Set for the "d" (default) rule, which simply upgrades the scheme.
+    bool upgrade_scheme;
+    std::unique_ptr<re2::RE2> from;
+    std::string to;
+  };
+
+  struct Target {
+    Target();
+    Target(Target&& other);
+    ~Target();
+
+    std::vector<std::unique_ptr<re2::RE2>> exclusions;
+    std::vector<Rule> rules;
+  };
+
+  using RuleSet = std::vector<Target>;
+
+  std::string ApplyRuleSet(const RuleSet& rule_set,
+                           const std::string& url_spec) const;
+
+  std::unordered_map<std::string, std::shared_ptr<const RuleSet>> rule_sets_;
+  // Compiled rule sets by their JSON, only kept while the index is built.
+  std::unordered_map<std::string, std::shared_ptr<const RuleSet>>
+      rule_sets_by_json_;
+
+  DISALLOW_COPY_AND_ASSIGN(HTTPSEverywhereRuleIndex);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RULE_INDEX_H_
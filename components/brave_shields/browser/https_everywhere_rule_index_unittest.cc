@@ -0,0 +1,107 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <string>
+
+#include "brave/components/brave_shields/browser/https_everywhere_rule_index.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace brave_shields {
+
+class HTTPSEverywhereRuleIndexTest : public testing::Test {
+ public:
+  HTTPSEverywhereRuleIndexTest() {}
+  ~HTTPSEverywhereRuleIndexTest() override {}
+
+ protected:
+  std::string Rewrite(const std::string& url) {
+    return index_.Rewrite(GURL(url));
+  }
+
+  HTTPSEverywhereRuleIndex index_;
+};
+
+TEST_F(HTTPSEverywhereRuleIndexTest, DefaultRule) {
+  ASSERT_TRUE(index_.AddRuleSet("com.example.www", R"([{"r":[{"d":1}]}])"));
+  EXPECT_EQ("https://www.example.com/a?b=c",
+            Rewrite("http://www.example.com/a?b=c"));
+  EXPECT_EQ("", Rewrite("http://example.com/"));
+  EXPECT_EQ("", Rewrite("http://sub.www.example.com/"));
+}
+
+TEST_F(HTTPSEverywhereRuleIndexTest, WildcardLookup) {
+  ASSERT_TRUE(index_.AddRuleSet("com.example.*", R"([{"r":[{"d":1}]}])"));
+  EXPECT_EQ("https://www.example.com/", Rewrite("http://www.example.com/"));
+  EXPECT_EQ("https://a.b.example.com/", Rewrite("http://a.b.example.com/"));
+  // The wildcard does not cover the bare domain.
+  EXPECT_EQ("", Rewrite("http://example.com/"));
+}
+
+TEST_F(HTTPSEverywhereRuleIndexTest, ExactHostBeforeWildcard) {
+  ASSERT_TRUE(index_.AddRuleSet("com.example.*", R"([{"r":[{"d":1}]}])"));
+  ASSERT_TRUE(index_.AddRuleSet("com.example.www",
+      R"([{"r":[{"f":"^http://www\\.example\\.com/",)"
+      R"("t":"https://secure.example.com/"}]}])"));
+  EXPECT_EQ("https://secure.example.com/x",
+            Rewrite("http://www.example.com/x"));
+}
+
+TEST_F(HTTPSEverywhereRuleIndexTest, FromToRewriteWithBackReference) {
+  ASSERT_TRUE(index_.AddRuleSet("org.example",
+      R"([{"r":[{"f":"^http://(\\w+\\.)?example\\.org/",)"
+      R"("t":"https://$1example.org/"}]}])"));
+  EXPECT_EQ("https://example.org/path", Rewrite("http://example.org/path"));
+  EXPECT_EQ("", Rewrite("http://other.org/path"));
+}
+
+TEST_F(HTTPSEverywhereRuleIndexTest, Exclusions) {
+  ASSERT_TRUE(index_.AddRuleSet("net.example",
+      R"([{"e":[{"p":"^http://example\\.net/insecure/.*"}],)"
+      R"("r":[{"d":1}]}])"));
+  EXPECT_EQ("https://example.net/secure", Rewrite("http://example.net/secure"));
+  EXPECT_EQ("", Rewrite("http://example.net/insecure/page"));
+}
+
+TEST_F(HTTPSEverywhereRuleIndexTest, TargetWithoutRulesStopsEvaluation) {
+  ASSERT_TRUE(index_.AddRuleSet("net.example",
+      R"([{"e":[]},{"r":[{"d":1}]}])"));
+  EXPECT_EQ("", Rewrite("http://example.net/"));
+}
+
+TEST_F(HTTPSEverywhereRuleIndexTest, InvalidRules) {
+  EXPECT_FALSE(index_.AddRuleSet("com.example", "not json"));
+  EXPECT_FALSE(index_.AddRuleSet("com.example", R"({"r":[]})"));
+  ASSERT_TRUE(index_.AddRuleSet("com.example",
+      R"([{"r":[{"f":"(","t":"https://example.com/"},{"d":1}]}])"));
+  // The invalid pattern is skipped and the default rule still applies.
+  EXPECT_EQ("https://example.com/", Rewrite("http://example.com/"));
+}
+
+TEST_F(HTTPSEverywhereRuleIndexTest, SharesRuleSetsWithTheSameJSON) {
+  const std::string rule =
+      R"([{"r":[{"f":"^http://(www\\.)?example\\.com/",)"
+      R"("t":"https://www.example.com/"}]}])";
+  ASSERT_TRUE(index_.AddRuleSet("com.example", rule));
+  ASSERT_TRUE(index_.AddRuleSet("com.example.www", rule));
+  ASSERT_TRUE(index_.AddRuleSet("org.example", R"([{"r":[{"d":1}]}])"));
+  EXPECT_EQ(3u, index_.size());
+  EXPECT_EQ(2u, index_.GetCompiledRuleSetCount());
+  EXPECT_EQ("https://www.example.com/", Rewrite("http://example.com/"));
+  EXPECT_EQ("https://www.example.com/", Rewrite("http://www.example.com/"));
+}
+
+TEST_F(HTTPSEverywhereRuleIndexTest, HostWithTrailingDot) {
+  ASSERT_TRUE(index_.AddRuleSet("com.example.www", R"([{"r":[{"d":1}]}])"));
+  EXPECT_EQ("https://www.example.com./", Rewrite("http://www.example.com./"));
+}
+
+TEST_F(HTTPSEverywhereRuleIndexTest, CorrectToRuleToRE2Engine) {
+  EXPECT_EQ("https://\\1example.\\2/",
+            HTTPSEverywhereRuleIndex::CorrectToRuleToRE2Engine(
+                "https://$1example.$2/"));
+}
+
+}  // namespace brave_shields
@@ -5,80 +5,69 @@
 
 #include "brave/components/brave_shields/browser/https_everywhere_service.h"
 
-#include <algorithm>
 #include <string>
 #include <utility>
-#include <vector>
 
 #include "base/base_paths.h"
 #include "base/bind.h"
-#include "base/json/json_reader.h"
 #include "base/logging.h"
 #include "base/macros.h"
 #include "base/memory/ptr_util.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/task/post_task.h"
 #include "base/threading/scoped_blocking_call.h"
-#include "base/values.h"
+#include "brave/components/brave_shields/browser/https_everywhere_rule_index.h"
 #include "third_party/leveldatabase/src/include/leveldb/db.h"
-#include "third_party/re2/src/re2/re2.h"
 #include "third_party/zlib/google/zip.h"
 
 #define DAT_FILE "httpse.leveldb.zip"
 #define DAT_FILE_VERSION "6.0"
-#define HTTPSE_URLS_REDIRECTS_COUNT_QUEUE   1
 #define HTTPSE_URL_MAX_REDIRECTS_COUNT      5
 
+namespace brave_shields {
+
 namespace {
 
-std::vector<std::string> Split(const std::string& s, char delim) {
-  std::stringstream ss(s);
-  std::string item;
-  std::vector<std::string> result;
-  while (getline(ss, item, delim)) {
-    result.push_back(item);
+std::unique_ptr<HTTPSEverywhereRuleIndex> CreateRuleIndex(
+    const base::FilePath& install_dir) {
+  base::FilePath zip_db_file_path =
+      install_dir.AppendASCII(DAT_FILE_VERSION).AppendASCII(DAT_FILE);
+  base::FilePath unzipped_level_db_path = zip_db_file_path.RemoveExtension();
+  base::FilePath destination = zip_db_file_path.DirName();
+  if (!zip::Unzip(zip_db_file_path, destination)) {
+    LOG(ERROR) << "Failed to unzip database file "
+               << zip_db_file_path.value().c_str();
+    return nullptr;
   }
-  return result;
-}
 
-// returns parts in reverse order, makes list of lookup domains like com.foo.*
-std::vector<std::string> ExpandDomainForLookup(const std::string& domain) {
-  std::vector<std::string> resultDomains;
-  std::vector<std::string> domainParts = Split(domain, '.');
-  if (domainParts.empty()) {
-    return resultDomains;
+  leveldb::DB* level_db = nullptr;
+  leveldb::Options options;
+  leveldb::Status status =
+      leveldb::DB::Open(options,
+                        unzipped_level_db_path.AsUTF8Unsafe(),
+                        &level_db);
+  if (!status.ok() || !level_db) {
+    LOG(ERROR) << "Level db open error "
+               << unzipped_level_db_path.value().c_str()
+               << ", error: " << status.ToString();
+    delete level_db;
+    return nullptr;
   }
 
-  for (size_t i = 0; i < domainParts.size() - 1; i++) {
-    // i < size()-1 is correct: don't want 'com.*' added to resultDomains
-    std::string slice = "";
-    std::string dot = "";
-    for (int j = domainParts.size() - 1; j >= static_cast<int>(i); j--) {
-      slice += dot + domainParts[j];
-      dot = ".";
-    }
-    if (0 != i) {
-      // We don't want * on the top URL
-      resultDomains.push_back(slice + ".*");
-    } else {
-      resultDomains.push_back(slice);
-    }
-  }
-  return resultDomains;
-}
-std::string leveldbGet(leveldb::DB* db, const std::string &key) {
-  if (!db) {
-    return "";
+  // Compile the whole ruleset once so that lookups never touch the database,
+  // parse JSON or compile regular expressions.
+  std::unique_ptr<leveldb::DB> db(level_db);
+  std::unique_ptr<HTTPSEverywhereRuleIndex> rule_index =
+      HTTPSEverywhereRuleIndex::CreateFromDB(db.get());
+  if (!rule_index) {
+    LOG(ERROR) << "Failed to build HTTPS Everywhere rule index from "
+               << unzipped_level_db_path.value().c_str();
   }
-
-  std::string value;
-  leveldb::Status s = db->Get(leveldb::ReadOptions(), key, &value);
-  return s.ok() ? value : "";
+  return rule_index;
 }
 
 }  // namespace
 
-namespace brave_shields {
-
 const char kHTTPSEverywhereComponentName[] = "Brave HTTPS Everywhere Updater";
 const char kHTTPSEverywhereComponentId[] = "oofiananboodjbbmdelgdommihjbkfag";
 const char kHTTPSEverywhereComponentBase64PublicKey[] =
@@ -100,7 +89,7 @@ HTTPSEverywhereService::g_https_everywhere_component_base64_public_key_(
 HTTPSEverywhereService::HTTPSEverywhereService(
     BraveComponent::Delegate* delegate)
     : BaseBraveShieldsService(delegate),
-      level_db_(nullptr) {
+      redirect_tracker_(HTTPSE_URL_MAX_REDIRECTS_COUNT) {
   DETACH_FROM_SEQUENCE(sequence_checker_);
 }
 
@@ -111,7 +100,7 @@ HTTPSEverywhereService::~HTTPSEverywhereService() {
 void HTTPSEverywhereService::Cleanup() {
   GetTaskRunner()->PostTask(
       FROM_HERE,
-      base::Bind(&HTTPSEverywhereService::CloseDatabase,
+      base::Bind(&HTTPSEverywhereService::ResetRuleIndex,
                  AsWeakPtr()));
 }
 
@@ -122,33 +111,34 @@ bool HTTPSEverywhereService::Init() {
   return true;
 }
 
-void HTTPSEverywhereService::InitDB(const base::FilePath& install_dir) {
+void HTTPSEverywhereService::BuildRuleIndex(
+    const base::FilePath& install_dir) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
-  base::FilePath zip_db_file_path =
-      install_dir.AppendASCII(DAT_FILE_VERSION).AppendASCII(DAT_FILE);
-  base::FilePath unzipped_level_db_path = zip_db_file_path.RemoveExtension();
-  base::FilePath destination = zip_db_file_path.DirName();
-  if (!zip::Unzip(zip_db_file_path, destination)) {
-    LOG(ERROR) << "Failed to unzip database file "
-               << zip_db_file_path.value().c_str();
-    return;
-  }
-
-  CloseDatabase();
+  // Building the index takes a while, lookups keep using the current index
+  // on this sequence until the new one is ready.
+  base::PostTaskAndReplyWithResult(
+      FROM_HERE,
+      {base::ThreadPool(), base::MayBlock(), base::TaskPriority::BEST_EFFORT,
+       base::TaskShutdownBehavior::SKIP_ON_SHUTDOWN},
+      base::BindOnce(&CreateRuleIndex, install_dir),
+      base::BindOnce(&HTTPSEverywhereService::OnRuleIndexBuilt, AsWeakPtr(),
+                     ++rule_index_generation_));
+}
 
-  leveldb::Options options;
-  leveldb::Status status =
-      leveldb::DB::Open(options,
-                        unzipped_level_db_path.AsUTF8Unsafe(),
-                        &level_db_);
-  if (!status.ok() || !level_db_) {
-    level_db_ = nullptr;
-    LOG(ERROR) << "Level db open error "
-               << unzipped_level_db_path.value().c_str()
-               << ", error: " << status.ToString();
-    CloseDatabase();
+void HTTPSEverywhereService::OnRuleIndexBuilt(
+    uint64_t rule_index_generation,
+    std::unique_ptr<HTTPSEverywhereRuleIndex> rule_index) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  // Drop indexes superseded by a newer component or a cleanup.
+  if (!rule_index || rule_index_generation != rule_index_generation_)
     return;
-  }
+
+  rule_index_.swap(rule_index);
+  // Freeing the compiled rules of the old index is not free either.
+  base::PostTask(
+      FROM_HERE, {base::ThreadPool(), base::TaskPriority::BEST_EFFORT},
+      base::BindOnce([](std::unique_ptr<HTTPSEverywhereRuleIndex>) {},
+                     std::move(rule_index)));
 }
 
 void HTTPSEverywhereService::OnComponentReady(
@@ -157,7 +147,7 @@ void HTTPSEverywhereService::OnComponentReady(
     const std::string& manifest) {
   GetTaskRunner()->PostTask(
       FROM_HERE,
-      base::Bind(&HTTPSEverywhereService::InitDB,
+      base::Bind(&HTTPSEverywhereService::BuildRuleIndex,
                  AsWeakPtr(),
                  install_dir));
 }
@@ -171,7 +161,7 @@ bool HTTPSEverywhereService::GetHTTPSURL(
   if (!url->is_valid())
     return false;
 
-  if (!IsInitialized() || !level_db_ || url->scheme() == url::kHttpsScheme) {
+  if (!IsInitialized() || !rule_index_ || url->scheme() == url::kHttpsScheme) {
     return false;
   }
   if (!ShouldHTTPSERedirect(request_identifier)) {
@@ -190,18 +180,11 @@ bool HTTPSEverywhereService::GetHTTPSURL(
     candidate_url = candidate_url.ReplaceComponents(replacements);
   }
 
-  const std::vector<std::string> domains =
-      ExpandDomainForLookup(candidate_url.host());
-  for (auto domain : domains) {
-    std::string value = leveldbGet(level_db_, domain);
-    if (!value.empty()) {
-      *new_url = ApplyHTTPSRule(candidate_url.spec(), value);
-      if (0 != new_url->length()) {
-        recently_used_cache_.add(candidate_url.spec(), *new_url);
-        AddHTTPSEUrlToRedirectList(request_identifier);
-        return true;
-      }
-    }
+  *new_url = rule_index_->Rewrite(candidate_url);
+  if (!new_url->empty()) {
+    recently_used_cache_.add(candidate_url.spec(), *new_url);
+    AddHTTPSEUrlToRedirectList(request_identifier);
+    return true;
   }
   recently_used_cache_.remove(candidate_url.spec());
   return false;
@@ -228,166 +211,25 @@ bool HTTPSEverywhereService::GetHTTPSURLFromCacheOnly(
   return false;
 }
 
-bool HTTPSEverywhereService::ShouldHTTPSERedirect(
+void HTTPSEverywhereService::OnRequestDestroyed(
     const uint64_t& request_identifier) {
-  base::AutoLock auto_lock(httpse_get_urls_redirects_count_mutex_);
-  for (size_t i = 0; i < httpse_urls_redirects_count_.size(); i++) {
-    if (request_identifier ==
-        httpse_urls_redirects_count_[i].request_identifier_ &&
-        httpse_urls_redirects_count_[i].redirects_ >=
-        HTTPSE_URL_MAX_REDIRECTS_COUNT - 1) {
-      return false;
-    }
-  }
-
-  return true;
+  redirect_tracker_.RemoveRequest(request_identifier);
 }
 
-void HTTPSEverywhereService::AddHTTPSEUrlToRedirectList(
+bool HTTPSEverywhereService::ShouldHTTPSERedirect(
     const uint64_t& request_identifier) {
-  // Adding redirects count for the current request
-  base::AutoLock auto_lock(httpse_get_urls_redirects_count_mutex_);
-  bool hostFound = false;
-  for (size_t i = 0; i < httpse_urls_redirects_count_.size(); i++) {
-    if (request_identifier ==
-        httpse_urls_redirects_count_[i].request_identifier_) {
-      // Found the host, just increment the redirects_count
-      httpse_urls_redirects_count_[i].redirects_++;
-      hostFound = true;
-      break;
-    }
-  }
-  if (!hostFound) {
-      // The host is new, adding it to the redirects list
-      if (httpse_urls_redirects_count_.size() >=
-          HTTPSE_URLS_REDIRECTS_COUNT_QUEUE) {
-          // The queue is full, erase the first element
-          httpse_urls_redirects_count_.erase(
-              httpse_urls_redirects_count_.begin());
-      }
-      httpse_urls_redirects_count_.push_back(
-          HTTPSE_REDIRECTS_COUNT_ST(request_identifier, 1));
-  }
-}
-
-std::string HTTPSEverywhereService::ApplyHTTPSRule(
-    const std::string& originalUrl,
-    const std::string& rule) {
-  base::Optional<base::Value> json_object = base::JSONReader::Read(rule);
-  if (base::nullopt == json_object || !json_object->is_list()) {
-    return "";
-  }
-
-  base::Value::ConstListView topValues = json_object->GetList();
-  for (auto it = topValues.cbegin(); it != topValues.cend(); ++it) {
-    if (!it->is_dict()) {
-      continue;
-    }
-    const base::DictionaryValue* childTopDictionary = nullptr;
-    it->GetAsDictionary(&childTopDictionary);
-    if (nullptr == childTopDictionary) {
-      continue;
-    }
-
-    const base::Value* exclusion = nullptr;
-    if (childTopDictionary->Get("e", &exclusion)) {
-      const base::ListValue* eValues = nullptr;
-      exclusion->GetAsList(&eValues);
-      if (nullptr != eValues) {
-        for (size_t j = 0; j < eValues->GetSize(); ++j) {
-          const base::Value* pValue = nullptr;
-          if (!eValues->Get(j, &pValue)) {
-            continue;
-          }
-          const base::DictionaryValue* pDictionary = nullptr;
-          pValue->GetAsDictionary(&pDictionary);
-          if (nullptr == pDictionary) {
-            continue;
-          }
-          const base::Value* patternValue = nullptr;
-          if (!pDictionary->Get("p", &patternValue)) {
-            continue;
-          }
-          std::string pattern;
-          if (!patternValue->GetAsString(&pattern)) {
-            continue;
-          }
-          pattern = CorrecttoRuleToRE2Engine(pattern);
-          if (RE2::FullMatch(originalUrl, pattern)) {
-            return "";
-          }
-        }
-      }
-    }
-
-    const base::Value* rules = nullptr;
-    if (!childTopDictionary->Get("r", &rules)) {
-      return "";
-    }
-    const base::ListValue* rValues = nullptr;
-    rules->GetAsList(&rValues);
-    if (nullptr == rValues) {
-      return "";
-    }
-
-    for (size_t j = 0; j < rValues->GetSize(); ++j) {
-      const base::Value* pValue = nullptr;
-      if (!rValues->Get(j, &pValue)) {
-        continue;
-      }
-      const base::DictionaryValue* pDictionary = nullptr;
-      pValue->GetAsDictionary(&pDictionary);
-      if (nullptr == pDictionary) {
-        continue;
-      }
-      const base::Value* patternValue = nullptr;
-      if (pDictionary->Get("d", &patternValue)) {
-        std::string newUrl(originalUrl);
-        return newUrl.insert(4, "s");
-      }
-
-      const base::Value* from_value = nullptr;
-      const base::Value* to_value = nullptr;
-      if (!pDictionary->Get("f", &from_value) ||
-          !pDictionary->Get("t", &to_value)) {
-        continue;
-      }
-      std::string from, to;
-      if (!from_value->GetAsString(&from) ||
-          !to_value->GetAsString(&to)) {
-        continue;
-      }
-
-      to = CorrecttoRuleToRE2Engine(to);
-      std::string newUrl(originalUrl);
-      RE2 regExp(from);
-
-      if (RE2::Replace(&newUrl, regExp, to) && newUrl != originalUrl) {
-        return newUrl;
-      }
-    }
-  }
-  return "";
+  return redirect_tracker_.ShouldRedirect(request_identifier);
 }
 
-std::string HTTPSEverywhereService::CorrecttoRuleToRE2Engine(
-    const std::string& to) {
-  std::string correctedto(to);
-  size_t pos = to.find("$");
-  while (std::string::npos != pos) {
-    correctedto[pos] = '\\';
-    pos = correctedto.find("$");
-  }
-
-  return correctedto;
+void HTTPSEverywhereService::AddHTTPSEUrlToRedirectList(
+    const uint64_t& request_identifier) {
+  redirect_tracker_.AddRedirect(request_identifier);
 }
 
-void HTTPSEverywhereService::CloseDatabase() {
+void HTTPSEverywhereService::ResetRuleIndex() {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
-  if (level_db_) {
-    delete level_db_;
-    level_db_ = nullptr;
-  }
+  rule_index_generation_++;
+  rule_index_.reset();
 }
 
 // static
@@ -4,6 +4,7 @@
  * You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "base/task/post_task.h"
+#include "base/task/thread_pool/thread_pool_instance.h"
 #include "base/path_service.h"
 #include "base/test/thread_test_helper.h"
 #include "brave/browser/brave_browser_process_impl.h"
@@ -84,6 +85,10 @@ class HTTPSEverywhereServiceTest : public ExtensionBrowserTest {
     g_brave_browser_process->https_everywhere_service()->OnComponentReady(
         httpse_extension->id(), httpse_extension->path(), "");
     WaitForHTTPSEverywhereServiceThread();
+    // The rule index is built on the thread pool and handed back to the
+    // service thread.
+    base::ThreadPoolInstance::Get()->FlushForTesting();
+    WaitForHTTPSEverywhereServiceThread();
 
     return true;
   }
@@ -17,7 +17,6 @@
 #include "content/public/browser/browser_thread.h"
 
 #if BUILDFLAG(BRAVE_STP_ENABLED)
-#include "base/strings/string_split.h"
 #include "brave/components/brave_shields/browser/brave_shields_util.h"
 #include "brave/components/brave_shields/browser/tracking_protection_helper.h"
 #include "brave/components/brave_shields/common/brave_shield_constants.h"
@@ -31,13 +30,27 @@ namespace brave_shields {
 #if BUILDFLAG(BRAVE_STP_ENABLED)
 const char kDatFileVersion[] = "1";
 const char kStorageTrackersFile[] = "StorageTrackingProtection.dat";
+
+namespace {
+
+scoped_refptr<TrackingProtectionState::StorageTrackers> LoadStorageTrackers(
+    const base::FilePath& path) {
+  const std::string contents =
+      brave_component_updater::GetDATFileAsString(path);
+  if (contents.empty()) {
+    LOG(ERROR) << "Could not obtain first party trackers data";
+    return nullptr;
+  }
+  return TrackingProtectionState::ParseStorageTrackers(contents);
+}
+
+}  // namespace
 #endif
 
 TrackingProtectionService::TrackingProtectionService(
     LocalDataFilesService* local_data_files_service)
     : LocalDataFilesObserver(local_data_files_service),
-      weak_factory_(this),
-      weak_factory_io_thread_(this) {
+      weak_factory_(this) {
 }
 
 TrackingProtectionService::~TrackingProtectionService() {
@@ -54,47 +67,19 @@ bool TrackingProtectionService::IsSmartTrackingProtectionEnabled() {
 }
 
 #if BUILDFLAG(BRAVE_STP_ENABLED)
-TrackingProtectionService::RenderFrameIdKey::RenderFrameIdKey()
-    : render_process_id(content::ChildProcessHost::kInvalidUniqueID),
-      frame_routing_id(MSG_ROUTING_NONE) {}
-
-TrackingProtectionService::RenderFrameIdKey::RenderFrameIdKey(
-    int render_process_id,
-    int frame_routing_id)
-    : render_process_id(render_process_id),
-      frame_routing_id(frame_routing_id) {}
-
-bool TrackingProtectionService::RenderFrameIdKey::operator<(
-    const RenderFrameIdKey& other) const {
-  return std::tie(render_process_id, frame_routing_id) <
-         std::tie(other.render_process_id, other.frame_routing_id);
-}
-
-bool TrackingProtectionService::RenderFrameIdKey::operator==(
-    const RenderFrameIdKey& other) const {
-  return render_process_id == other.render_process_id &&
-         frame_routing_id == other.frame_routing_id;
-}
-
 void TrackingProtectionService::SetStartingSiteForRenderFrame(
     GURL starting_site,
     int render_process_id,
     int render_frame_id) {
   DCHECK_CURRENTLY_ON(BrowserThread::IO);
-  const RenderFrameIdKey key(render_process_id, render_frame_id);
-  render_frame_key_to_starting_site_url[key] = starting_site;
+  state_.SetStartingSite(render_process_id, render_frame_id, starting_site);
 }
 
 GURL TrackingProtectionService::GetStartingSiteForRenderFrame(
     int render_process_id,
     int render_frame_id) const {
   DCHECK_CURRENTLY_ON(BrowserThread::UI);
-  const RenderFrameIdKey key(render_process_id, render_frame_id);
-  auto iter = render_frame_key_to_starting_site_url.find(key);
-  if (iter != render_frame_key_to_starting_site_url.end()) {
-    return iter->second;
-  }
-  return {};
+  return state_.GetStartingSite(render_process_id, render_frame_id);
 }
 
 void TrackingProtectionService::ModifyRenderFrameKey(int old_render_process_id,
@@ -102,21 +87,14 @@ void TrackingProtectionService::ModifyRenderFrameKey(int old_render_process_id,
                                                      int new_render_process_id,
                                                      int new_render_frame_id) {
   DCHECK_CURRENTLY_ON(BrowserThread::IO);
-  const RenderFrameIdKey old_key(old_render_process_id, old_render_frame_id);
-  auto iter = render_frame_key_to_starting_site_url.find(old_key);
-  if (iter != render_frame_key_to_starting_site_url.end()) {
-    const RenderFrameIdKey new_key(new_render_process_id, new_render_frame_id);
-    render_frame_key_to_starting_site_url.insert(
-        std::pair<RenderFrameIdKey, GURL>(new_key, iter->second));
-    render_frame_key_to_starting_site_url.erase(old_key);
-  }
+  state_.ModifyRenderFrameKey(old_render_process_id, old_render_frame_id,
+                              new_render_process_id, new_render_frame_id);
 }
 
 void TrackingProtectionService::DeleteRenderFrameKey(int render_process_id,
                                                      int render_frame_id) {
   DCHECK_CURRENTLY_ON(BrowserThread::IO);
-  const RenderFrameIdKey key(render_process_id, render_frame_id);
-  render_frame_key_to_starting_site_url.erase(key);
+  state_.DeleteRenderFrameKey(render_process_id, render_frame_id);
 }
 
 bool TrackingProtectionService::ShouldStoreState(HostContentSettingsMap* map,
@@ -129,7 +107,7 @@ bool TrackingProtectionService::ShouldStoreState(HostContentSettingsMap* map,
     return true;
   }
 
-  if (first_party_storage_trackers_.empty()) {
+  if (!state_.HasStorageTrackers()) {
     LOG(INFO) << "First party storage trackers list is empty";
     return true;
   }
@@ -153,36 +131,16 @@ bool TrackingProtectionService::ShouldStoreState(HostContentSettingsMap* map,
     return true;
 
   // deny storage if host is found in the tracker list
-  return first_party_storage_trackers_.find(host) ==
-         first_party_storage_trackers_.end();
+  return !state_.IsStorageTracker(host);
 }
 
-void TrackingProtectionService::OnGetSTPDATFileData(std::string contents) {
-  if (contents.empty()) {
-    LOG(ERROR) << "Could not obtain first party trackers data";
-    return;
-  }
-
-  std::vector<std::string> storage_trackers =
-      base::SplitString(base::StringPiece(contents.data(), contents.size()),
-                        ",", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
-
-  if (storage_trackers.empty()) {
+void TrackingProtectionService::OnGetStorageTrackers(
+    scoped_refptr<TrackingProtectionState::StorageTrackers> storage_trackers) {
+  if (!storage_trackers) {
     LOG(ERROR) << "No first party trackers found";
     return;
   }
-
-  base::PostTask(
-      FROM_HERE, {BrowserThread::IO},
-      base::BindOnce(
-          &TrackingProtectionService::UpdateFirstPartyStorageTrackers,
-          weak_factory_io_thread_.GetWeakPtr(), std::move(storage_trackers)));
-}
-
-void TrackingProtectionService::UpdateFirstPartyStorageTrackers(
-    std::vector<std::string> storage_trackers) {
-  first_party_storage_trackers_ =
-      base::flat_set<std::string>(std::move(storage_trackers));
+  state_.SetStorageTrackers(std::move(storage_trackers));
 }
 
 #else  // !BUILDFLAG(BRAVE_STP_ENABLED)
@@ -225,9 +183,8 @@ void TrackingProtectionService::OnComponentReady(
   base::PostTaskAndReplyWithResult(
       local_data_files_service()->GetTaskRunner().get(),
       FROM_HERE,
-      base::BindOnce(&brave_component_updater::GetDATFileAsString,
-                     storage_tracking_protection_path),
-      base::BindOnce(&TrackingProtectionService::OnGetSTPDATFileData,
+      base::BindOnce(&LoadStorageTrackers, storage_tracking_protection_path),
+      base::BindOnce(&TrackingProtectionService::OnGetStorageTrackers,
                      weak_factory_.GetWeakPtr()));
 #endif
 }
@@ -12,7 +12,6 @@
 #include <utility>
 #include <vector>
 
-#include "base/containers/flat_set.h"
 #include "base/files/file_path.h"
 #include "base/memory/weak_ptr.h"
 #include "base/sequenced_task_runner.h"
@@ -23,6 +22,10 @@
 #include "content/public/common/resource_type.h"
 #include "url/gurl.h"
 
+#if BUILDFLAG(BRAVE_STP_ENABLED)
+#include "brave/components/brave_shields/browser/tracking_protection_state.h"
+#endif
+
 class HostContentSettingsMap;
 class TrackingProtectionServiceTest;
 
@@ -76,30 +79,14 @@ class TrackingProtectionService : public LocalDataFilesObserver {
 
  protected:
 #if BUILDFLAG(BRAVE_STP_ENABLED)
-  // ParseStorageTrackersData parses the storage trackers list provided by
-  // the offline-crawler
-  void OnGetSTPDATFileData(std::string contents);
-  void UpdateFirstPartyStorageTrackers(std::vector<std::string>);
-
-  // For Smart Tracking Protection, we need to keep track of the starting site
-  // that initiated the redirects. We use RenderFrameIdKey to determine the
-  // starting site for a given render frame host.
-  struct RenderFrameIdKey {
-    RenderFrameIdKey();
-    RenderFrameIdKey(int render_process_id, int frame_routing_id);
-
-    int render_process_id;
-    int frame_routing_id;
-
-    bool operator<(const RenderFrameIdKey& other) const;
-    bool operator==(const RenderFrameIdKey& other) const;
-  };
+  void OnGetStorageTrackers(
+      scoped_refptr<TrackingProtectionState::StorageTrackers>
+          storage_trackers);
 #endif
 
  private:
 #if BUILDFLAG(BRAVE_STP_ENABLED)
-  base::flat_set<std::string> first_party_storage_trackers_;
-  std::map<RenderFrameIdKey, GURL> render_frame_key_to_starting_site_url;
+  TrackingProtectionState state_;
 #endif
 
   std::vector<std::string> third_party_base_hosts_;
@@ -107,7 +94,6 @@ class TrackingProtectionService : public LocalDataFilesObserver {
   base::Lock third_party_hosts_lock_;
 
   base::WeakPtrFactory<TrackingProtectionService> weak_factory_;
-  base::WeakPtrFactory<TrackingProtectionService> weak_factory_io_thread_;
   DISALLOW_COPY_AND_ASSIGN(TrackingProtectionService);
 };
 
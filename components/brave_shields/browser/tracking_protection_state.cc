@@ -0,0 +1,124 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/tracking_protection_state.h"
+
+#include <utility>
+
+#include "base/hash/hash.h"
+#include "base/strings/string_split.h"
+
+namespace brave_shields {
+
+TrackingProtectionState::RenderFrameIdKey::RenderFrameIdKey(
+    int render_process_id,
+    int frame_routing_id)
+    : render_process_id(render_process_id),
+      frame_routing_id(frame_routing_id) {}
+
+bool TrackingProtectionState::RenderFrameIdKey::operator==(
+    const RenderFrameIdKey& other) const {
+  return render_process_id == other.render_process_id &&
+         frame_routing_id == other.frame_routing_id;
+}
+
+size_t TrackingProtectionState::RenderFrameIdKeyHash::operator()(
+    const RenderFrameIdKey& key) const {
+  return base::HashInts(key.render_process_id, key.frame_routing_id);
+}
+
+TrackingProtectionState::TrackingProtectionState() = default;
+
+TrackingProtectionState::~TrackingProtectionState() = default;
+
+// static
+scoped_refptr<TrackingProtectionState::StorageTrackers>
+TrackingProtectionState::ParseStorageTrackers(base::StringPiece contents) {
+  auto storage_trackers = base::MakeRefCounted<StorageTrackers>();
+  for (base::StringPiece tracker :
+       base::SplitStringPiece(contents, ",", base::TRIM_WHITESPACE,
+                              base::SPLIT_WANT_NONEMPTY)) {
+    storage_trackers->data.insert(tracker.as_string());
+  }
+  if (storage_trackers->data.empty())
+    return nullptr;
+  return storage_trackers;
+}
+
+void TrackingProtectionState::SetStorageTrackers(
+    scoped_refptr<StorageTrackers> storage_trackers) {
+  scoped_refptr<const StorageTrackers> old_storage_trackers;
+  {
+    base::AutoLock lock(storage_trackers_lock_);
+    old_storage_trackers = std::move(storage_trackers_);
+    storage_trackers_ = std::move(storage_trackers);
+  }
+  // |old_storage_trackers| is freed here, outside of the lock, unless a
+  // reader still holds on to it.
+}
+
+scoped_refptr<const TrackingProtectionState::StorageTrackers>
+TrackingProtectionState::GetStorageTrackers() const {
+  base::AutoLock lock(storage_trackers_lock_);
+  return storage_trackers_;
+}
+
+bool TrackingProtectionState::HasStorageTrackers() const {
+  return !!GetStorageTrackers();
+}
+
+bool TrackingProtectionState::IsStorageTracker(const std::string& host) const {
+  scoped_refptr<const StorageTrackers> storage_trackers = GetStorageTrackers();
+  return storage_trackers && storage_trackers->data.count(host);
+}
+
+void TrackingProtectionState::SetStartingSite(int render_process_id,
+                                              int render_frame_id,
+                                              const GURL& starting_site) {
+  const RenderFrameIdKey key(render_process_id, render_frame_id);
+  base::AutoLock lock(starting_sites_lock_);
+  starting_sites_[key] = starting_site;
+}
+
+GURL TrackingProtectionState::GetStartingSite(int render_process_id,
+                                              int render_frame_id) const {
+  const RenderFrameIdKey key(render_process_id, render_frame_id);
+  base::AutoLock lock(starting_sites_lock_);
+  auto it = starting_sites_.find(key);
+  if (it != starting_sites_.end())
+    return it->second;
+  return GURL();
+}
+
+void TrackingProtectionState::ModifyRenderFrameKey(int old_render_process_id,
+                                                   int old_render_frame_id,
+                                                   int new_render_process_id,
+                                                   int new_render_frame_id) {
+  const RenderFrameIdKey old_key(old_render_process_id, old_render_frame_id);
+  const RenderFrameIdKey new_key(new_render_process_id, new_render_frame_id);
+  if (old_key == new_key)
+    return;
+  base::AutoLock lock(starting_sites_lock_);
+  auto it = starting_sites_.find(old_key);
+  if (it == starting_sites_.end())
+    return;
+  // Like before, an existing entry for |new_key| is kept.
+  starting_sites_.emplace(new_key, std::move(it->second));
+  starting_sites_.erase(old_key);
+}
+
+void TrackingProtectionState::DeleteRenderFrameKey(int render_process_id,
+                                                   int render_frame_id) {
+  const RenderFrameIdKey key(render_process_id, render_frame_id);
+  base::AutoLock lock(starting_sites_lock_);
+  starting_sites_.erase(key);
+}
+
+size_t TrackingProtectionState::render_frame_count() const {
+  base::AutoLock lock(starting_sites_lock_);
+  return starting_sites_.size();
+}
+
+}  // namespace brave_shields
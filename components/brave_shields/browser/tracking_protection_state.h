@@ -0,0 +1,94 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_TRACKING_PROTECTION_STATE_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_TRACKING_PROTECTION_STATE_H_
+
+#include <stddef.h>
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/strings/string_piece.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+#include "url/gurl.h"
+
+namespace brave_shields {
+
+// The state Smart Tracking Protection consults in ShouldStoreState. Frames
+// are tracked from the IO thread while storage checks come from the UI
+// thread, so everything here can be used from any thread.
+//
+// The storage tracker list is an immutable snapshot that is replaced as a
+// whole; readers only hold the lock long enough to take a reference to the
+// current one. Frame updates are single hash map operations under their own
+// lock. Neither ever makes a reader wait for a list to be parsed or built.
+class TrackingProtectionState {
+ public:
+  using StorageTrackers =
+      base::RefCountedData<std::unordered_set<std::string>>;
+
+  TrackingProtectionState();
+  ~TrackingProtectionState();
+
+  // Parses the comma separated storage tracker list shipped in the STP DAT
+  // file. Returns nullptr if it contains no trackers. Meant to run on a
+  // background sequence.
+  static scoped_refptr<StorageTrackers> ParseStorageTrackers(
+      base::StringPiece contents);
+
+  void SetStorageTrackers(scoped_refptr<StorageTrackers> storage_trackers);
+  bool HasStorageTrackers() const;
+  bool IsStorageTracker(const std::string& host) const;
+
+  void SetStartingSite(int render_process_id,
+                       int render_frame_id,
+                       const GURL& starting_site);
+  GURL GetStartingSite(int render_process_id, int render_frame_id) const;
+  void ModifyRenderFrameKey(int old_render_process_id,
+                            int old_render_frame_id,
+                            int new_render_process_id,
+                            int new_render_frame_id);
+  void DeleteRenderFrameKey(int render_process_id, int render_frame_id);
+
+  size_t render_frame_count() const;
+
+ private:
+  // For Smart Tracking Protection, we need to keep track of the starting site
+  // that initiated the redirects. We use RenderFrameIdKey to determine the
+  // starting site for a given render frame host.
+  struct RenderFrameIdKey {
+    RenderFrameIdKey(int render_process_id, int frame_routing_id);
+
+    bool operator==(const RenderFrameIdKey& other) const;
+
+    int render_process_id;
+    int frame_routing_id;
+  };
+
+  struct RenderFrameIdKeyHash {
+    size_t operator()(const RenderFrameIdKey& key) const;
+  };
+
+  scoped_refptr<const StorageTrackers> GetStorageTrackers() const;
+
+  mutable base::Lock storage_trackers_lock_;
+  scoped_refptr<const StorageTrackers> storage_trackers_
+      GUARDED_BY(storage_trackers_lock_);
+
+  mutable base::Lock starting_sites_lock_;
+  std::unordered_map<RenderFrameIdKey, GURL, RenderFrameIdKeyHash>
+      starting_sites_ GUARDED_BY(starting_sites_lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(TrackingProtectionState);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_TRACKING_PROTECTION_STATE_H_
@@ -0,0 +1,145 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/tracking_protection_state.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace brave_shields {
+
+namespace {
+
+constexpr int kStableProcessId = 1;
+constexpr int kStableFrameId = 1;
+constexpr int kIterations = 10000;
+
+class FrameWriter : public base::DelegateSimpleThread::Delegate {
+ public:
+  FrameWriter(TrackingProtectionState* state, int render_process_id)
+      : state_(state), render_process_id_(render_process_id) {}
+
+  void Run() override {
+    const GURL site("https://writer.com/");
+    for (int i = 0; i < kIterations; ++i) {
+      state_->SetStartingSite(render_process_id_, i, site);
+      state_->ModifyRenderFrameKey(render_process_id_, i, render_process_id_,
+                                   i + kIterations);
+      state_->DeleteRenderFrameKey(render_process_id_, i + kIterations);
+      if (i % 100 == 0) {
+        state_->SetStorageTrackers(
+            TrackingProtectionState::ParseStorageTrackers(
+                i % 200 ? "tracker.com,other.com" : "tracker.com"));
+      }
+    }
+  }
+
+ private:
+  TrackingProtectionState* state_;
+  const int render_process_id_;
+};
+
+class Reader : public base::DelegateSimpleThread::Delegate {
+ public:
+  Reader(TrackingProtectionState* state, std::atomic<int>* failures)
+      : state_(state), failures_(failures) {}
+
+  void Run() override {
+    const GURL expected("https://stable.com/");
+    for (int i = 0; i < kIterations; ++i) {
+      if (!state_->IsStorageTracker("tracker.com") ||
+          state_->IsStorageTracker("stable.com") ||
+          state_->GetStartingSite(kStableProcessId, kStableFrameId) !=
+              expected) {
+        (*failures_)++;
+      }
+    }
+  }
+
+ private:
+  TrackingProtectionState* state_;
+  std::atomic<int>* failures_;
+};
+
+}  // namespace
+
+TEST(TrackingProtectionStateTest, ParseStorageTrackers) {
+  auto storage_trackers = TrackingProtectionState::ParseStorageTrackers(
+      " tracker.com,,other.com ,");
+  ASSERT_TRUE(storage_trackers);
+  EXPECT_EQ(2u, storage_trackers->data.size());
+  EXPECT_TRUE(storage_trackers->data.count("tracker.com"));
+  EXPECT_TRUE(storage_trackers->data.count("other.com"));
+
+  EXPECT_FALSE(TrackingProtectionState::ParseStorageTrackers(""));
+  EXPECT_FALSE(TrackingProtectionState::ParseStorageTrackers(" , "));
+}
+
+TEST(TrackingProtectionStateTest, StorageTrackers) {
+  TrackingProtectionState state;
+  EXPECT_FALSE(state.HasStorageTrackers());
+  EXPECT_FALSE(state.IsStorageTracker("tracker.com"));
+
+  state.SetStorageTrackers(
+      TrackingProtectionState::ParseStorageTrackers("tracker.com"));
+  EXPECT_TRUE(state.HasStorageTrackers());
+  EXPECT_TRUE(state.IsStorageTracker("tracker.com"));
+  EXPECT_FALSE(state.IsStorageTracker("sub.tracker.com"));
+}
+
+TEST(TrackingProtectionStateTest, RenderFrames) {
+  TrackingProtectionState state;
+  const GURL site("https://brave.com/");
+  state.SetStartingSite(1, 2, site);
+  EXPECT_EQ(site, state.GetStartingSite(1, 2));
+  EXPECT_EQ(GURL(), state.GetStartingSite(2, 1));
+
+  // A frame swap moves the starting site to the new frame.
+  state.ModifyRenderFrameKey(1, 2, 3, 4);
+  EXPECT_EQ(GURL(), state.GetStartingSite(1, 2));
+  EXPECT_EQ(site, state.GetStartingSite(3, 4));
+
+  // Swapping to the same frame keeps it.
+  state.ModifyRenderFrameKey(3, 4, 3, 4);
+  EXPECT_EQ(site, state.GetStartingSite(3, 4));
+
+  state.DeleteRenderFrameKey(3, 4);
+  EXPECT_EQ(GURL(), state.GetStartingSite(3, 4));
+  EXPECT_EQ(0u, state.render_frame_count());
+}
+
+TEST(TrackingProtectionStateTest, ConcurrentReadersAndWriters) {
+  TrackingProtectionState state;
+  state.SetStorageTrackers(
+      TrackingProtectionState::ParseStorageTrackers("tracker.com"));
+  state.SetStartingSite(kStableProcessId, kStableFrameId,
+                        GURL("https://stable.com/"));
+
+  std::atomic<int> failures(0);
+  std::vector<std::unique_ptr<base::DelegateSimpleThread::Delegate>> delegates;
+  std::vector<std::unique_ptr<base::DelegateSimpleThread>> threads;
+  for (int i = 0; i < 4; ++i) {
+    // Writers use their own render process ids to not touch the stable frame.
+    delegates.push_back(std::make_unique<FrameWriter>(&state, 100 + i));
+    delegates.push_back(std::make_unique<Reader>(&state, &failures));
+  }
+  for (auto& delegate : delegates) {
+    threads.push_back(std::make_unique<base::DelegateSimpleThread>(
+        delegate.get(), "TrackingProtectionStateTest"));
+    threads.back()->Start();
+  }
+  for (auto& thread : threads)
+    thread->Join();
+
+  EXPECT_EQ(0, failures);
+  EXPECT_EQ(1u, state.render_frame_count());
+}
+
+}  // namespace brave_shields
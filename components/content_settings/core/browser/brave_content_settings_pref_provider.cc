@@ -5,11 +5,16 @@
 
 #include "brave/components/content_settings/core/browser/brave_content_settings_pref_provider.h"
 
+#include <algorithm>
 #include <memory>
+#include <set>
+#include <unordered_map>
 #include <utility>
 
+#include "base/auto_reset.h"
 #include "base/bind.h"
 #include "base/optional.h"
+#include "base/strings/string_piece.h"
 #include "base/task/post_task.h"
 #include "brave/common/network_constants.h"
 #include "brave/common/pref_names.h"
@@ -78,8 +83,62 @@ class BraveShieldsRuleIterator : public RuleIterator {
 };
 
 
+// Shields rules indexed by the host of their primary pattern. A shields
+// rule can only be identical to or a successor of a cookie rule's pattern if
+// it is for the same host, one of its parent domains or all hosts, so those
+// are the only rules that have to be compared.
+class ShieldsRuleIndex {
+ public:
+  explicit ShieldsRuleIndex(const std::vector<Rule>& shield_rules)
+      : shield_rules_(shield_rules) {
+    for (size_t i = 0; i < shield_rules_.size(); ++i) {
+      const std::string& host = shield_rules_[i].primary_pattern.GetHost();
+      if (host.empty())
+        all_hosts_rules_.push_back(i);
+      else
+        host_rules_[host].push_back(i);
+    }
+  }
+
+  // Returns the first shields rule, in iteration order, whose primary pattern
+  // is identical to or a successor of |pattern|.
+  const Rule* FindCoveringRule(const ContentSettingsPattern& pattern) const {
+    std::vector<size_t> candidates(all_hosts_rules_);
+    base::StringPiece host = pattern.GetHost();
+    while (!host.empty()) {
+      auto it = host_rules_.find(host.as_string());
+      if (it != host_rules_.end())
+        candidates.insert(candidates.end(), it->second.begin(),
+                          it->second.end());
+      const size_t dot = host.find('.');
+      if (dot == base::StringPiece::npos)
+        break;
+      host.remove_prefix(dot + 1);
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    for (size_t index : candidates) {
+      const Rule& shield_rule = shield_rules_[index];
+      auto primary_compare = shield_rule.primary_pattern.Compare(pattern);
+      // TODO(bridiver) - verify that SUCCESSOR is correct and not PREDECESSOR
+      if (primary_compare == ContentSettingsPattern::IDENTITY ||
+          primary_compare == ContentSettingsPattern::SUCCESSOR) {
+        return &shield_rule;
+      }
+    }
+    return nullptr;
+  }
+
+ private:
+  const std::vector<Rule>& shield_rules_;
+  std::unordered_map<std::string, std::vector<size_t>> host_rules_;
+  std::vector<size_t> all_hosts_rules_;
+
+  DISALLOW_COPY_AND_ASSIGN(ShieldsRuleIndex);
+};
+
 bool IsActive(const Rule& cookie_rule,
-              const std::vector<Rule>& shield_rules) {
+              const ShieldsRuleIndex& shield_rules) {
   // don't include default rules in the iterator
   if (cookie_rule.primary_pattern == ContentSettingsPattern::Wildcard() &&
       (cookie_rule.secondary_pattern == ContentSettingsPattern::Wildcard() ||
@@ -88,20 +147,12 @@ bool IsActive(const Rule& cookie_rule,
     return false;
   }
 
-  bool default_value = true;
-  for (const auto& shield_rule : shield_rules) {
-    auto primary_compare =
-        shield_rule.primary_pattern.Compare(cookie_rule.primary_pattern);
-    // TODO(bridiver) - verify that SUCCESSOR is correct and not PREDECESSOR
-    if (primary_compare == ContentSettingsPattern::IDENTITY ||
-        primary_compare == ContentSettingsPattern::SUCCESSOR) {
-      // TODO(bridiver) - move this logic into shields_util for allow/block
-      return
-          ValueToContentSetting(&shield_rule.value) != CONTENT_SETTING_BLOCK;
-    }
-  }
-
-  return default_value;
+  const Rule* shield_rule =
+      shield_rules.FindCoveringRule(cookie_rule.primary_pattern);
+  if (!shield_rule)
+    return true;
+  // TODO(bridiver) - move this logic into shields_util for allow/block
+  return ValueToContentSetting(&shield_rule->value) != CONTENT_SETTING_BLOCK;
 }
 
 }  // namespace
@@ -346,9 +397,10 @@ void BravePrefProvider::UpdateCookieRules(ContentSettingsType content_type,
       incognito);
 
   // Matching cookie rules against shield rules.
+  const ShieldsRuleIndex shield_rule_index(shield_rules);
   while (brave_cookies_iterator && brave_cookies_iterator->HasNext()) {
     auto rule = brave_cookies_iterator->Next();
-    if (IsActive(rule, shield_rules)) {
+    if (IsActive(rule, shield_rule_index)) {
       rules.push_back(CloneRule(rule, true));
       brave_cookie_rules_[incognito].push_back(CloneRule(rule, true));
     }
@@ -374,36 +426,32 @@ void BravePrefProvider::UpdateCookieRules(ContentSettingsType content_type,
   }
 
   // get the list of changes
+  using PatternPair = std::pair<ContentSettingsPattern, ContentSettingsPattern>;
+  std::set<std::pair<PatternPair, ContentSetting>> old_rule_settings;
+  for (const auto& old_rule : old_rules) {
+    old_rule_settings.emplace(
+        PatternPair(old_rule.primary_pattern, old_rule.secondary_pattern),
+        ValueToContentSetting(&old_rule.value));
+  }
+  std::set<PatternPair> new_rule_patterns;
   std::vector<Rule> brave_cookie_updates;
   for (const auto& new_rule : brave_cookie_rules_[incognito]) {
-    auto match = std::find_if(
-        old_rules.begin(),
-        old_rules.end(),
-        [&new_rule](const auto& old_rule) {
-          // we want an exact match here because any change to the rule
-          // is an update
-          return new_rule.primary_pattern == old_rule.primary_pattern &&
-                 new_rule.secondary_pattern == old_rule.secondary_pattern &&
-                 ValueToContentSetting(&new_rule.value) ==
-                    ValueToContentSetting(&old_rule.value);
-        });
-    if (match == old_rules.end()) {
+    PatternPair patterns(new_rule.primary_pattern, new_rule.secondary_pattern);
+    // we want an exact match here because any change to the rule
+    // is an update
+    if (!old_rule_settings.count(
+            {patterns, ValueToContentSetting(&new_rule.value)})) {
       brave_cookie_updates.push_back(CloneRule(new_rule));
     }
+    new_rule_patterns.insert(std::move(patterns));
   }
 
   // find any removed rules
   for (const auto& old_rule : old_rules) {
-    auto match = std::find_if(
-        brave_cookie_rules_[incognito].begin(),
-        brave_cookie_rules_[incognito].end(),
-        [&old_rule](const auto& new_rule) {
-          // we only care about the patterns here because we're looking
-          // for deleted rules, not changed rules
-          return new_rule.primary_pattern == old_rule.primary_pattern &&
-                 new_rule.secondary_pattern == old_rule.secondary_pattern;
-        });
-    if (match == brave_cookie_rules_[incognito].end()) {
+    // we only care about the patterns here because we're looking
+    // for deleted rules, not changed rules
+    if (!new_rule_patterns.count(
+            {old_rule.primary_pattern, old_rule.secondary_pattern})) {
       brave_cookie_updates.push_back(
           Rule(old_rule.primary_pattern,
                old_rule.secondary_pattern,
@@ -425,6 +473,9 @@ void BravePrefProvider::UpdateCookieRules(ContentSettingsType content_type,
 
 void BravePrefProvider::NotifyChanges(const std::vector<Rule>& rules,
                                       bool incognito) {
+  // |cookie_rules_| already reflect these changes, don't rebuild them again
+  // for each notification.
+  base::AutoReset<bool> notifying(&notifying_cookie_changes_, true);
   for (const auto& rule : rules) {
     Notify(rule.primary_pattern,
            rule.secondary_pattern,
@@ -449,6 +500,8 @@ void BravePrefProvider::OnContentSettingChanged(
     const ContentSettingsPattern& secondary_pattern,
     ContentSettingsType content_type,
     const std::string& resource_identifier) {
+  if (notifying_cookie_changes_)
+    return;
   if (content_type == ContentSettingsType::COOKIES ||
       (content_type == ContentSettingsType::PLUGINS &&
           (resource_identifier == brave_shields::kCookies ||
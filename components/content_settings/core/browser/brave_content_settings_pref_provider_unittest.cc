@@ -8,6 +8,7 @@
 
 #include "base/macros.h"
 #include "base/optional.h"
+#include "base/strings/stringprintf.h"
 #include "brave/common/pref_names.h"
 #include "brave/components/brave_shields/common/brave_shield_constants.h"
 #include "brave/components/content_settings/core/browser/brave_content_settings_pref_provider.h"
@@ -336,4 +337,60 @@ TEST_F(BravePrefProviderTest, TestShieldsSettingsMigrationVersion) {
   provider.ShutdownOnUIThread();
 }
 
+TEST_F(BravePrefProviderTest, CookieRulesFollowShieldsStatus) {
+  BravePrefProvider provider(testing_profile()->GetPrefs(),
+                             false /* incognito */,
+                             true /* store_last_modified */);
+  const auto set_plugin_setting = [&provider](const std::string& pattern,
+                                              const std::string& resource_id,
+                                              ContentSetting setting) {
+    provider.SetWebsiteSetting(ContentSettingsPattern::FromString(pattern),
+                               ContentSettingsPattern::Wildcard(),
+                               ContentSettingsType::PLUGINS, resource_id,
+                               ContentSettingToValue(setting));
+  };
+  const auto get_cookie_setting = [&provider](const std::string& url) {
+    return TestUtils::GetContentSetting(&provider, GURL("https://other.com/"),
+                                        GURL(url), ContentSettingsType::COOKIES,
+                                        "", false);
+  };
+
+  // Many sites blocking cookies, every other one with shields down.
+  constexpr int kSiteCount = 500;
+  for (int i = 0; i < kSiteCount; ++i) {
+    const std::string pattern = base::StringPrintf("*://site%d.com/*", i);
+    set_plugin_setting(pattern, brave_shields::kCookies,
+                       CONTENT_SETTING_BLOCK);
+    if (i % 2 == 0) {
+      set_plugin_setting(pattern, brave_shields::kBraveShields,
+                         CONTENT_SETTING_BLOCK);
+    }
+  }
+  for (int i = 0; i < kSiteCount; ++i) {
+    EXPECT_EQ(i % 2 == 0 ? CONTENT_SETTING_ALLOW : CONTENT_SETTING_BLOCK,
+              get_cookie_setting(base::StringPrintf("https://site%d.com/", i)));
+  }
+
+  // Toggling one site only changes that site.
+  set_plugin_setting("*://site1.com/*", brave_shields::kBraveShields,
+                     CONTENT_SETTING_BLOCK);
+  EXPECT_EQ(CONTENT_SETTING_ALLOW, get_cookie_setting("https://site1.com/"));
+  EXPECT_EQ(CONTENT_SETTING_BLOCK, get_cookie_setting("https://site3.com/"));
+  set_plugin_setting("*://site1.com/*", brave_shields::kBraveShields,
+                     CONTENT_SETTING_DEFAULT);
+  EXPECT_EQ(CONTENT_SETTING_BLOCK, get_cookie_setting("https://site1.com/"));
+
+  // Shields down for a whole domain also covers cookie rules of subdomains.
+  set_plugin_setting("*://www.brave.com/*", brave_shields::kCookies,
+                     CONTENT_SETTING_BLOCK);
+  EXPECT_EQ(CONTENT_SETTING_BLOCK,
+            get_cookie_setting("https://www.brave.com/"));
+  set_plugin_setting("*://[*.]brave.com/*", brave_shields::kBraveShields,
+                     CONTENT_SETTING_BLOCK);
+  EXPECT_EQ(CONTENT_SETTING_ALLOW,
+            get_cookie_setting("https://www.brave.com/"));
+
+  provider.ShutdownOnUIThread();
+}
+
 }  //  namespace content_settings
@@ -10,10 +10,16 @@ declare namespace AdBlock {
     },
     stats: {
       adsBlockedStat?: number
+      decisionCacheStats?: DecisionCacheStats
       numBlocked: number
     }
   }
 
+  export interface DecisionCacheStats {
+    hits: number
+    misses: number
+  }
+
   export interface FilterList {
     uuid: string
     url: string
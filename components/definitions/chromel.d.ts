@@ -238,8 +238,9 @@ declare namespace chrome.braveShields {
     injected_script: string
     force_hide_selectors: string[]
   }
-  const hostnameCosmeticResources: (hostname: string, callback: (resources: HostnameSpecificResources) => void) => void
-  const hiddenClassIdSelectors: (classes: string[], ids: string[], exceptions: string[], callback: (selectors: string[], forceHideSelectors: string[]) => void) => void
+  // |resources| is a JSON serialized HostnameSpecificResources
+  const hostnameCosmeticResources: (hostname: string, callback: (resources: string) => void) => void
+  const hiddenClassIdSelectors: (sessionId: string, classes: string[], ids: string[], exceptions: string[], callback: (selectors: string[], forceHideSelectors: string[]) => void) => void
 
   type BraveShieldsViewPreferences = {
     showAdvancedView: boolean
@@ -0,0 +1,107 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/speedreader/speedreader_host_index.h"
+
+#include <utility>
+
+#include "base/json/json_reader.h"
+#include "base/strings/string_util.h"
+#include "base/values.h"
+#include "third_party/zlib/google/compression_utils.h"
+#include "url/gurl.h"
+
+namespace speedreader {
+
+namespace {
+
+constexpr char kGzipMagic[] = "\x1f\x8b";
+
+// Adds the host |rule| is anchored to to |hosts| or |host_prefixes|. Returns
+// false if |rule| isn't anchored to a host.
+bool AddRule(base::StringPiece rule,
+             std::vector<std::string>* hosts,
+             std::vector<std::string>* host_prefixes) {
+  if (base::StartsWith(rule, "@@", base::CompareCase::SENSITIVE))
+    return true;
+  if (!base::StartsWith(rule, "||", base::CompareCase::SENSITIVE))
+    return false;
+
+  rule.remove_prefix(2);
+  const size_t end = rule.find_first_of("/^:*$|");
+  std::string host = base::ToLowerASCII(rule.substr(0, end));
+  if (host.empty())
+    return false;
+
+  if (end != base::StringPiece::npos &&
+      (rule[end] == '/' || rule[end] == '^' || rule[end] == ':')) {
+    hosts->push_back(std::move(host));
+  } else {
+    host_prefixes->push_back(std::move(host));
+  }
+  return true;
+}
+
+}  // namespace
+
+SpeedreaderHostIndex::SpeedreaderHostIndex() = default;
+
+SpeedreaderHostIndex::~SpeedreaderHostIndex() = default;
+
+// static
+std::unique_ptr<SpeedreaderHostIndex> SpeedreaderHostIndex::Create(
+    base::StringPiece whitelist) {
+  std::string uncompressed;
+  if (base::StartsWith(whitelist, kGzipMagic, base::CompareCase::SENSITIVE)) {
+    if (!compression::GzipUncompress(whitelist.as_string(), &uncompressed))
+      return nullptr;
+    whitelist = uncompressed;
+  }
+
+  base::Optional<base::Value> configurations =
+      base::JSONReader::Read(whitelist);
+  if (!configurations || !configurations->is_list())
+    return nullptr;
+
+  std::vector<std::string> hosts;
+  std::vector<std::string> host_prefixes;
+  for (const base::Value& configuration : configurations->GetList()) {
+    const base::Value* url_rules =
+        configuration.is_dict() ? configuration.FindListKey("url_rules")
+                                : nullptr;
+    if (!url_rules)
+      return nullptr;
+    for (const base::Value& rule : url_rules->GetList()) {
+      if (!rule.is_string() ||
+          !AddRule(rule.GetString(), &hosts, &host_prefixes)) {
+        return nullptr;
+      }
+    }
+  }
+
+  auto index = std::make_unique<SpeedreaderHostIndex>();
+  index->hosts_ = base::flat_set<std::string, std::less<>>(std::move(hosts));
+  index->host_prefixes_ = std::move(host_prefixes);
+  return index;
+}
+
+bool SpeedreaderHostIndex::MayMatch(const GURL& url) const {
+  // "||" anchors a rule at the start of any label of the host.
+  for (base::StringPiece domain = url.host_piece(); !domain.empty();) {
+    if (hosts_.find(domain) != hosts_.end())
+      return true;
+    for (const std::string& prefix : host_prefixes_) {
+      if (base::StartsWith(domain, prefix, base::CompareCase::SENSITIVE))
+        return true;
+    }
+    const size_t dot = domain.find('.');
+    if (dot == base::StringPiece::npos)
+      break;
+    domain.remove_prefix(dot + 1);
+  }
+  return false;
+}
+
+}  // namespace speedreader
@@ -0,0 +1,53 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_SPEEDREADER_SPEEDREADER_HOST_INDEX_H_
+#define BRAVE_COMPONENTS_SPEEDREADER_SPEEDREADER_HOST_INDEX_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/containers/flat_set.h"
+#include "base/strings/string_piece.h"
+
+class GURL;
+
+namespace speedreader {
+
+// Hosts the url rules of the Speedreader whitelist are anchored to. Used to
+// turn down navigations that cannot match any rule without going through the
+// FFI. Exception rules are ignored, they can only turn a match down.
+class SpeedreaderHostIndex {
+ public:
+  SpeedreaderHostIndex();
+  ~SpeedreaderHostIndex();
+
+  SpeedreaderHostIndex(const SpeedreaderHostIndex&) = delete;
+  SpeedreaderHostIndex& operator=(const SpeedreaderHostIndex&) = delete;
+
+  // Builds the index from the (optionally gzipped) JSON whitelist. Returns
+  // nullptr if the whitelist can't be parsed or has a rule that isn't
+  // anchored to a host, the whitelist itself has to be asked in that case.
+  static std::unique_ptr<SpeedreaderHostIndex> Create(
+      base::StringPiece whitelist);
+
+  // Returns false if no rule can match |url|.
+  bool MayMatch(const GURL& url) const;
+
+  size_t size() const { return hosts_.size() + host_prefixes_.size(); }
+
+ private:
+  // Hosts followed by a separator in their rule, "||example.com/article".
+  base::flat_set<std::string, std::less<>> hosts_;
+  // Hosts that may go on in the url, "||example.com" matches
+  // "example.com.au" as well.
+  std::vector<std::string> host_prefixes_;
+};
+
+}  // namespace speedreader
+
+#endif  // BRAVE_COMPONENTS_SPEEDREADER_SPEEDREADER_HOST_INDEX_H_
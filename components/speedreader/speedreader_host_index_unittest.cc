@@ -0,0 +1,103 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/speedreader/speedreader_host_index.h"
+
+#include <memory>
+#include <string>
+
+#include "brave/components/speedreader/rust/ffi/speedreader.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/zlib/google/compression_utils.h"
+#include "url/gurl.h"
+
+namespace speedreader {
+
+namespace {
+
+constexpr char kWhitelist[] = R"(
+[
+    {
+        "domain": "example.com",
+        "url_rules": [
+            "||example.com/*/article/",
+            "@@||example.com/*/video/"
+        ],
+        "declarative_rewrite": null
+    },
+    {
+        "domain": "news.org",
+        "url_rules": [
+            "||news.org^",
+            "||blog.news"
+        ],
+        "declarative_rewrite": null
+    }
+]
+)";
+
+}  // namespace
+
+TEST(SpeedreaderHostIndexTest, MayMatch) {
+  auto index = SpeedreaderHostIndex::Create(kWhitelist);
+  ASSERT_TRUE(index);
+  EXPECT_EQ(3u, index->size());
+
+  EXPECT_TRUE(index->MayMatch(GURL("https://example.com/a/article/")));
+  EXPECT_TRUE(index->MayMatch(GURL("https://www.example.com/")));
+  EXPECT_TRUE(index->MayMatch(GURL("https://news.org/")));
+  EXPECT_TRUE(index->MayMatch(GURL("https://blog.news.net/")));
+  EXPECT_TRUE(index->MayMatch(GURL("https://a.blog.news/")));
+
+  EXPECT_FALSE(index->MayMatch(GURL("https://example.org/a/article/")));
+  EXPECT_FALSE(index->MayMatch(GURL("https://myexample.com/a/article/")));
+  EXPECT_FALSE(index->MayMatch(GURL("https://news.org.uk/")));
+  EXPECT_FALSE(index->MayMatch(GURL("https://brave.com/")));
+}
+
+TEST(SpeedreaderHostIndexTest, Gzipped) {
+  std::string compressed;
+  ASSERT_TRUE(compression::GzipCompress(std::string(kWhitelist), &compressed));
+  auto index = SpeedreaderHostIndex::Create(compressed);
+  ASSERT_TRUE(index);
+  EXPECT_TRUE(index->MayMatch(GURL("https://example.com/a/article/")));
+  EXPECT_FALSE(index->MayMatch(GURL("https://brave.com/")));
+}
+
+TEST(SpeedreaderHostIndexTest, UnanchoredRules) {
+  EXPECT_FALSE(SpeedreaderHostIndex::Create(R"([
+    {"domain": "example.com", "url_rules": ["/article/"]}
+  ])"));
+  EXPECT_FALSE(SpeedreaderHostIndex::Create(R"([
+    {"domain": "example.com", "url_rules": ["||*.example.com/"]}
+  ])"));
+  EXPECT_FALSE(SpeedreaderHostIndex::Create("not json"));
+}
+
+// Whatever the index turns down must not be readable for the whitelist.
+TEST(SpeedreaderHostIndexTest, AgreesWithWhitelist) {
+  auto index = SpeedreaderHostIndex::Create(kWhitelist);
+  ASSERT_TRUE(index);
+  SpeedReader speedreader(kWhitelist, sizeof(kWhitelist) - 1);
+
+  const char* urls[] = {
+      "https://example.com/a/article/",
+      "https://www.example.com/a/article/",
+      "https://example.com/a/video/",
+      "https://example.org/a/article/",
+      "https://myexample.com/a/article/",
+      "https://news.org/story",
+      "https://news.org.uk/story",
+      "https://blog.news.net/story",
+      "https://brave.com/",
+  };
+  for (const char* url : urls) {
+    if (!index->MayMatch(GURL(url)))
+      EXPECT_FALSE(speedreader.IsReadableURL(url)) << url;
+  }
+  EXPECT_TRUE(speedreader.IsReadableURL("https://example.com/a/article/"));
+}
+
+}  // namespace speedreader
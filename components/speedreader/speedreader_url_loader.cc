@@ -5,12 +5,14 @@
 
 #include "brave/components/speedreader/speedreader_url_loader.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
 
 #include "base/bind.h"
 #include "base/metrics/histogram_macros.h"
+#include "base/no_destructor.h"
 #include "base/task/post_task.h"
 #include "brave/components/speedreader/rust/ffi/speedreader.h"
 #include "brave/components/speedreader/speedreader_throttle.h"
@@ -25,6 +27,9 @@ namespace speedreader {
 namespace {
 
 constexpr uint32_t kReadBufferSize = 32768;
+// Capacity of the pipe the body is sent through. Rewriter output only waits in
+// |pending_output_| while the pipe is full.
+constexpr uint32_t kSendPipeCapacity = 4 * kReadBufferSize;
 
 std::string GetDistilledPageResources() {
   return "<style id=\"brave_speedreader_style\">" +
@@ -34,8 +39,86 @@ std::string GetDistilledPageResources() {
          "</style>";
 }
 
+SpeedReaderURLLoader::DistillerFactory& GetDistillerFactoryForTesting() {
+  static base::NoDestructor<SpeedReaderURLLoader::DistillerFactory> factory;
+  return *factory;
+}
+
+// Feeds the body to the whitelist's streaming rewriter. Created on the
+// loader's sequence, used and destroyed on its distill task runner.
+class RewriterDistiller : public SpeedReaderURLLoader::Distiller {
+ public:
+  RewriterDistiller(SpeedreaderWhitelist* whitelist, const GURL& url)
+      : rewriter_(
+            whitelist->MakeRewriter(url, &RewriterDistiller::OnOutput, this)) {}
+  ~RewriterDistiller() override = default;
+
+  RewriterDistiller(const RewriterDistiller&) = delete;
+  RewriterDistiller& operator=(const RewriterDistiller&) = delete;
+
+  bool Write(const std::string& chunk, std::string* output) override {
+    const base::TimeTicks start = base::TimeTicks::Now();
+    const bool ok = rewriter_->Write(chunk.data(), chunk.size()) == 0;
+    elapsed_ += base::TimeTicks::Now() - start;
+    TakeOutput(output);
+    return ok;
+  }
+
+  bool End(std::string* output) override {
+    const base::TimeTicks start = base::TimeTicks::Now();
+    const bool ok = rewriter_->End() == 0;
+    elapsed_ += base::TimeTicks::Now() - start;
+    UMA_HISTOGRAM_TIMES("Brave.Speedreader.Distill", elapsed_);
+    TakeOutput(output);
+    return ok;
+  }
+
+ private:
+  static void OnOutput(const char* chunk, size_t chunk_len, void* user_data) {
+    static_cast<RewriterDistiller*>(user_data)->output_.append(chunk,
+                                                               chunk_len);
+  }
+
+  void TakeOutput(std::string* output) {
+    output->append(output_);
+    output_.clear();
+  }
+
+  std::unique_ptr<Rewriter> rewriter_;
+  std::string output_;
+  base::TimeDelta elapsed_;
+};
+
 }  // namespace
 
+struct SpeedReaderURLLoader::DistillResult {
+  bool ok = false;
+  std::string output;
+};
+
+// static
+void SpeedReaderURLLoader::SetDistillerFactoryForTesting(
+    DistillerFactory factory) {
+  GetDistillerFactoryForTesting() = std::move(factory);
+}
+
+// static
+SpeedReaderURLLoader::DistillResult SpeedReaderURLLoader::DistillChunk(
+    Distiller* distiller,
+    const std::string& chunk) {
+  DistillResult result;
+  result.ok = distiller->Write(chunk, &result.output);
+  return result;
+}
+
+// static
+SpeedReaderURLLoader::DistillResult SpeedReaderURLLoader::EndDistilling(
+    Distiller* distiller) {
+  DistillResult result;
+  result.ok = distiller->End(&result.output);
+  return result;
+}
+
 // static
 std::tuple<mojo::PendingRemote<network::mojom::URLLoader>,
            mojo::PendingReceiver<network::mojom::URLLoaderClient>,
@@ -72,6 +155,9 @@ SpeedReaderURLLoader::SpeedReaderURLLoader(
       destination_url_loader_client_(std::move(destination_url_loader_client)),
       response_url_(response_url),
       task_runner_(task_runner),
+      distill_task_runner_(base::CreateSequencedTaskRunner(
+          {base::ThreadPool(), base::TaskPriority::USER_BLOCKING})),
+      distiller_(nullptr, base::OnTaskRunnerDeleter(distill_task_runner_)),
       body_consumer_watcher_(FROM_HERE,
                              mojo::SimpleWatcher::ArmingPolicy::MANUAL,
                              task_runner),
@@ -129,6 +215,17 @@ void SpeedReaderURLLoader::OnStartLoadingResponseBody(
   VLOG(2) << __func__ << " " << response_url_;
   state_ = State::kLoading;
   body_consumer_handle_ = std::move(body);
+  const DistillerFactory& distiller_factory = GetDistillerFactoryForTesting();
+  if (!throttle_ || (!whitelist_ && !distiller_factory)) {
+    Abort();
+    return;
+  }
+
+  body_start_time_ = base::TimeTicks::Now();
+  if (distiller_factory)
+    distiller_.reset(distiller_factory.Run(response_url_).release());
+  else
+    distiller_.reset(new RewriterDistiller(whitelist_, response_url_));
   body_consumer_watcher_.Watch(
       body_consumer_handle_.get(),
       MOJO_HANDLE_SIGNAL_READABLE | MOJO_HANDLE_SIGNAL_PEER_CLOSED,
@@ -197,20 +294,32 @@ void SpeedReaderURLLoader::ResumeReadingBodyFromNet() {
 }
 
 void SpeedReaderURLLoader::OnBodyReadable(MojoResult) {
-  DCHECK_EQ(State::kLoading, state_);
+  DCHECK(state_ == State::kLoading || state_ == State::kSending);
 
-  size_t start_size = buffered_body_.size();
+  std::string chunk(kReadBufferSize, '\0');
   uint32_t read_bytes = kReadBufferSize;
-  buffered_body_.resize(start_size + read_bytes);
   MojoResult result = body_consumer_handle_->ReadData(
-      &buffered_body_[0] + start_size, &read_bytes, MOJO_READ_DATA_FLAG_NONE);
+      &chunk[0], &read_bytes, MOJO_READ_DATA_FLAG_NONE);
   switch (result) {
     case MOJO_RESULT_OK:
       break;
     case MOJO_RESULT_FAILED_PRECONDITION:
       // Reading is finished.
-      buffered_body_.resize(start_size);
-      MaybeLaunchSpeedreader();
+      body_read_ = true;
+      if (fallback_) {
+        SendPendingOutput();
+      } else if (state_ == State::kLoading && original_body_.empty()) {
+        // Nothing to distill.
+        FallBackToOriginalBody();
+      } else {
+        distilling_ = true;
+        base::PostTaskAndReplyWithResult(
+            distill_task_runner_.get(), FROM_HERE,
+            base::BindOnce(&SpeedReaderURLLoader::EndDistilling,
+                           base::Unretained(distiller_.get())),
+            base::BindOnce(&SpeedReaderURLLoader::OnDistilled,
+                           weak_factory_.GetWeakPtr(), true));
+      }
       return;
     case MOJO_RESULT_SHOULD_WAIT:
       body_consumer_watcher_.ArmOrNotify();
@@ -221,61 +330,96 @@ void SpeedReaderURLLoader::OnBodyReadable(MojoResult) {
   }
 
   DCHECK_EQ(MOJO_RESULT_OK, result);
-  buffered_body_.resize(start_size + read_bytes);
-  // TODO(iefremov): We actually can partially |pumpContent| to speedreader,
-  // but skipping it for now to simplify things. Pumping is not free in terms
-  // of CPU ticks, so we will have to keep alive speedreader instance on another
-  // thread.
+  chunk.resize(read_bytes);
+  if (fallback_) {
+    AppendOutput(chunk);
+    SendPendingOutput();
+    return;
+  }
 
-  body_consumer_watcher_.ArmOrNotify();
+  if (state_ == State::kLoading) {
+    original_body_.append(chunk);
+    UpdatePeakBufferedBytes();
+  }
+  // |distiller_| is deleted on |distill_task_runner_|, so it outlives this.
+  distilling_ = true;
+  base::PostTaskAndReplyWithResult(
+      distill_task_runner_.get(), FROM_HERE,
+      base::BindOnce(&SpeedReaderURLLoader::DistillChunk,
+                     base::Unretained(distiller_.get()), std::move(chunk)),
+      base::BindOnce(&SpeedReaderURLLoader::OnDistilled,
+                     weak_factory_.GetWeakPtr(), false));
 }
 
-void SpeedReaderURLLoader::OnBodyWritable(MojoResult r) {
+void SpeedReaderURLLoader::OnBodyWritable(MojoResult) {
   DCHECK_EQ(State::kSending, state_);
-  if (bytes_remaining_in_buffer_ > 0) {
-    SendReceivedBodyToClient();
-  } else {
-    CompleteSending();
+  SendPendingOutput();
+}
+
+void SpeedReaderURLLoader::ReadMore() {
+  // Only one chunk is distilled at a time, and its output has to be in the
+  // pipe before the next one is read. This bounds what is buffered here.
+  if (body_read_ || distilling_ ||
+      pending_output_offset_ < pending_output_.size()) {
+    return;
   }
+  body_consumer_watcher_.ArmOrNotify();
 }
 
-void SpeedReaderURLLoader::MaybeLaunchSpeedreader() {
-  DCHECK_EQ(State::kLoading, state_);
-  if (!throttle_ || !whitelist_) {
+void SpeedReaderURLLoader::OnDistilled(bool end, DistillResult result) {
+  DCHECK(distilling_);
+  distilling_ = false;
+  if (state_ == State::kAborted)
+    return;
+
+  if (!result.ok) {
+    if (state_ == State::kLoading) {
+      FallBackToOriginalBody();
+      return;
+    }
+    // Part of the distilled page is sent already, there is nothing sensible
+    // to fall back to.
     Abort();
     return;
   }
 
-  VLOG(2) << __func__ << " buffered body size = " << buffered_body_.size();
-  bytes_remaining_in_buffer_ = buffered_body_.size();
-
-  if (bytes_remaining_in_buffer_ > 0) {
-    // Offload heavy distilling to another thread.
-    base::PostTaskAndReplyWithResult(
-        FROM_HERE, {base::ThreadPool(), base::TaskPriority::USER_BLOCKING},
-        base::BindOnce(
-            [](std::string data, std::unique_ptr<Rewriter> rewriter) -> auto {
-              SCOPED_UMA_HISTOGRAM_TIMER("Brave.Speedreader.Distill");
-              int written = rewriter->Write(data.c_str(), data.length());
-              // Error occurred
-              if (written != 0) {
-                return data;
-              }
-
-              rewriter->End();
-              const std::string& transformed = rewriter->GetOutput();
-
-              return GetDistilledPageResources() + transformed;
-            },
-            std::move(buffered_body_), whitelist_->MakeRewriter(response_url_)),
-        base::BindOnce(&SpeedReaderURLLoader::CompleteLoading,
-                       weak_factory_.GetWeakPtr()));
+  if (state_ == State::kLoading && (end || !result.output.empty())) {
+    // The rewriter has committed to its output, the original body is no
+    // longer needed.
+    std::string().swap(original_body_);
+    StartSending();
+    if (state_ != State::kSending)
+      return;
+    AppendOutput(GetDistilledPageResources());
+  }
+  AppendOutput(result.output);
+
+  if (end) {
+    distill_ended_ = true;
+    distiller_.reset();
+  }
+  if (state_ == State::kSending) {
+    SendPendingOutput();
     return;
   }
-  CompleteLoading(std::move(buffered_body_));
+  ReadMore();
+}
+
+void SpeedReaderURLLoader::FallBackToOriginalBody() {
+  DCHECK_EQ(State::kLoading, state_);
+  fallback_ = true;
+  distiller_.reset();
+  StartSending();
+  if (state_ != State::kSending)
+    return;
+
+  DCHECK(pending_output_.empty());
+  pending_output_.swap(original_body_);
+  pending_output_offset_ = 0;
+  SendPendingOutput();
 }
 
-void SpeedReaderURLLoader::CompleteLoading(std::string body) {
+void SpeedReaderURLLoader::StartSending() {
   DCHECK_EQ(State::kLoading, state_);
   state_ = State::kSending;
 
@@ -284,13 +428,17 @@ void SpeedReaderURLLoader::CompleteLoading(std::string body) {
     return;
   }
 
-  buffered_body_ = std::move(body);
-  bytes_remaining_in_buffer_ = buffered_body_.size();
-
+  UMA_HISTOGRAM_TIMES("Brave.Speedreader.TimeToFirstByte",
+                      base::TimeTicks::Now() - body_start_time_);
   throttle_->Resume();
+  MojoCreateDataPipeOptions options;
+  options.struct_size = sizeof(MojoCreateDataPipeOptions);
+  options.flags = MOJO_CREATE_DATA_PIPE_FLAG_NONE;
+  options.element_num_bytes = 1;
+  options.capacity_num_bytes = kSendPipeCapacity;
   mojo::ScopedDataPipeConsumerHandle body_to_send;
   MojoResult result =
-      mojo::CreateDataPipe(nullptr, &body_producer_handle_, &body_to_send);
+      mojo::CreateDataPipe(&options, &body_producer_handle_, &body_to_send);
   if (result != MOJO_RESULT_OK) {
     Abort();
     return;
@@ -305,19 +453,67 @@ void SpeedReaderURLLoader::CompleteLoading(std::string body) {
   // Send deferred message.
   destination_url_loader_client_->OnStartLoadingResponseBody(
       std::move(body_to_send));
+}
 
-  DCHECK(bytes_remaining_in_buffer_);
-  if (bytes_remaining_in_buffer_) {
-    SendReceivedBodyToClient();
+void SpeedReaderURLLoader::AppendOutput(base::StringPiece output) {
+  if (output.empty())
     return;
+  // Drop what has been sent already before growing the buffer.
+  if (pending_output_offset_ == pending_output_.size()) {
+    pending_output_.clear();
+    pending_output_offset_ = 0;
+  }
+  output.AppendToString(&pending_output_);
+  UpdatePeakBufferedBytes();
+}
+
+void SpeedReaderURLLoader::UpdatePeakBufferedBytes() {
+  peak_buffered_bytes_ =
+      std::max(peak_buffered_bytes_, original_body_.size() +
+                                         pending_output_.size() -
+                                         pending_output_offset_);
+}
+
+void SpeedReaderURLLoader::SendPendingOutput() {
+  DCHECK_EQ(State::kSending, state_);
+  while (pending_output_offset_ < pending_output_.size()) {
+    uint32_t bytes_sent =
+        static_cast<uint32_t>(pending_output_.size() - pending_output_offset_);
+    MojoResult result = body_producer_handle_->WriteData(
+        pending_output_.data() + pending_output_offset_, &bytes_sent,
+        MOJO_WRITE_DATA_FLAG_NONE);
+    switch (result) {
+      case MOJO_RESULT_OK:
+        break;
+      case MOJO_RESULT_FAILED_PRECONDITION:
+        // The pipe is closed unexpectedly. |this| should be deleted once
+        // URLLoaderPtr on the destination is released.
+        Abort();
+        return;
+      case MOJO_RESULT_SHOULD_WAIT:
+        body_producer_watcher_.ArmOrNotify();
+        return;
+      default:
+        NOTREACHED();
+        return;
+    }
+    pending_output_offset_ += bytes_sent;
   }
+  pending_output_.clear();
+  pending_output_offset_ = 0;
 
-  CompleteSending();
+  if (body_read_ && (fallback_ || distill_ended_)) {
+    CompleteSending();
+    return;
+  }
+  ReadMore();
 }
 
 void SpeedReaderURLLoader::CompleteSending() {
   DCHECK_EQ(State::kSending, state_);
   state_ = State::kCompleted;
+  UMA_HISTOGRAM_MEMORY_KB("Brave.Speedreader.PeakBufferedKB",
+                          peak_buffered_bytes_ / 1024);
   // Call client's OnComplete() if |this|'s OnComplete() has already been
   // called.
   if (complete_status_.has_value())
@@ -329,34 +525,6 @@ void SpeedReaderURLLoader::CompleteSending() {
   body_producer_handle_.reset();
 }
 
-void SpeedReaderURLLoader::SendReceivedBodyToClient() {
-  DCHECK_EQ(State::kSending, state_);
-  // Send the buffered data first.
-  DCHECK_GT(bytes_remaining_in_buffer_, 0u);
-  size_t start_position = buffered_body_.size() - bytes_remaining_in_buffer_;
-  uint32_t bytes_sent = bytes_remaining_in_buffer_;
-  MojoResult result =
-      body_producer_handle_->WriteData(buffered_body_.data() + start_position,
-                                       &bytes_sent, MOJO_WRITE_DATA_FLAG_NONE);
-  switch (result) {
-    case MOJO_RESULT_OK:
-      break;
-    case MOJO_RESULT_FAILED_PRECONDITION:
-      // The pipe is closed unexpectedly. |this| should be deleted once
-      // URLLoaderPtr on the destination is released.
-      Abort();
-      return;
-    case MOJO_RESULT_SHOULD_WAIT:
-      body_producer_watcher_.ArmOrNotify();
-      return;
-    default:
-      NOTREACHED();
-      return;
-  }
-  bytes_remaining_in_buffer_ -= bytes_sent;
-  body_producer_watcher_.ArmOrNotify();
-}
-
 void SpeedReaderURLLoader::Abort() {
   VLOG(2) << __func__ << " " << response_url_;
   state_ = State::kAborted;
@@ -365,6 +533,7 @@ void SpeedReaderURLLoader::Abort() {
   source_url_loader_.reset();
   source_url_client_receiver_.reset();
   destination_url_loader_client_.reset();
+  distiller_.reset();
   // |this| should be removed since the owner will destroy |this| or the owner
   // has already been destroyed by some reason.
 }
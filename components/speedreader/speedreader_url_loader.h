@@ -6,6 +6,7 @@
 #ifndef BRAVE_COMPONENTS_SPEEDREADER_SPEEDREADER_URL_LOADER_H_
 #define BRAVE_COMPONENTS_SPEEDREADER_SPEEDREADER_URL_LOADER_H_
 
+#include <memory>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -13,6 +14,8 @@
 #include "base/callback.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/weak_ptr.h"
+#include "base/sequenced_task_runner.h"
+#include "base/time/time.h"
 #include "base/strings/string_piece.h"
 #include "mojo/public/cpp/bindings/binding.h"
 #include "mojo/public/cpp/bindings/pending_receiver.h"
@@ -30,7 +33,7 @@ namespace speedreader {
 class SpeedReaderThrottle;
 class SpeedreaderWhitelist;
 
-// Loads the whole response body and tries to Speedreader-distill it.
+// Streams the response body through Speedreader as it arrives.
 // Cargoculted from |`SniffingURLLoader|.
 //
 // This loader has five states:
@@ -39,18 +42,22 @@ class SpeedreaderWhitelist;
 //               finished (= OnComplete() is called). When body is provided, the
 //               state is changed to kLoading. Otherwise the state goes to
 //               kCompleted.
-// kLoading: Receives the body from the source loader and distills the page.
-//            The received body is kept in this loader until distilling
-//            is finished. When all body has been received and distilling is
-//            done, this loader will dispatch queued messages like
-//            OnStartLoadingResponseBody() to the destination
-//            loader client, and then the state is changed to kSending.
-// kSending: Receives the body and sends it to the destination loader client.
-//           The state changes to kCompleted after all data is sent.
+// kLoading: Receives the body from the source loader and feeds it chunk by
+//           chunk to the rewriter on a background sequence. The received body
+//           is kept until the rewriter produces its first output, so that the
+//           original page can still be sent if distilling fails. Once there is
+//           output (or distilling has failed) this loader dispatches queued
+//           messages like OnStartLoadingResponseBody() to the destination
+//           loader client, and then the state is changed to kSending.
+// kSending: Keeps reading and rewriting the body and writes the output to the
+//           destination loader client. Reading pauses while output is waiting
+//           for room in the data pipe. The state changes to kCompleted after
+//           all data is sent.
 // kCompleted: All data has been sent to the destination loader.
 // kAborted: Unexpected behavior happens. Watchers, pipes and the binding from
 //           the source loader to |this| are stopped. All incoming messages from
 //           the destination (through network::mojom::URLLoader) are ignored in
+//           this state.
 class SpeedReaderURLLoader : public network::mojom::URLLoaderClient,
                              public network::mojom::URLLoader {
  public:
@@ -59,6 +66,23 @@ class SpeedReaderURLLoader : public network::mojom::URLLoaderClient,
   SpeedReaderURLLoader(const SpeedReaderURLLoader&) = delete;
   SpeedReaderURLLoader& operator=(const SpeedReaderURLLoader&) = delete;
 
+  // Rewrites the body chunk by chunk on a background sequence.
+  class Distiller {
+   public:
+    virtual ~Distiller() = default;
+    // Returns false if the page can't be distilled. Output made available,
+    // which is often nothing, is appended to |output|.
+    virtual bool Write(const std::string& chunk, std::string* output) = 0;
+    // Like Write(), for the rest of the output.
+    virtual bool End(std::string* output) = 0;
+  };
+  using DistillerFactory =
+      base::RepeatingCallback<std::unique_ptr<Distiller>(const GURL& url)>;
+
+  // Makes loaders distill with |factory| instead of the whitelist's rewriter
+  // until it is reset with a null callback.
+  static void SetDistillerFactoryForTesting(DistillerFactory factory);
+
   // Start waiting for the body.
   void Start(
       mojo::PendingRemote<network::mojom::URLLoader> source_url_loader_remote,
@@ -109,14 +133,26 @@ class SpeedReaderURLLoader : public network::mojom::URLLoaderClient,
   void PauseReadingBodyFromNet() override;
   void ResumeReadingBodyFromNet() override;
 
+  struct DistillResult;
+
+  static DistillResult DistillChunk(Distiller* distiller,
+                                    const std::string& chunk);
+  static DistillResult EndDistilling(Distiller* distiller);
+
   void OnBodyReadable(MojoResult);
   void OnBodyWritable(MojoResult);
-  void MaybeLaunchSpeedreader();
 
-  // Gets either distilled or untouched body.
-  void CompleteLoading(std::string body);
+  void ReadMore();
+  void OnDistilled(bool end, DistillResult result);
+  // Switches to sending the untouched body.
+  void FallBackToOriginalBody();
+  // Sends the deferred response to the destination and creates the pipe the
+  // (distilled or untouched) body is written to.
+  void StartSending();
+  void AppendOutput(base::StringPiece output);
+  void UpdatePeakBufferedBytes();
+  void SendPendingOutput();
   void CompleteSending();
-  void SendReceivedBodyToClient();
 
   void Abort();
 
@@ -137,9 +173,25 @@ class SpeedReaderURLLoader : public network::mojom::URLLoaderClient,
   // Set if OnComplete() is called during distilling.
   base::Optional<network::URLLoaderCompletionStatus> complete_status_;
 
-  // Note that this could be replaced by a distilled version.
-  std::string buffered_body_;
-  size_t bytes_remaining_in_buffer_;
+  // Runs the rewriter, |distiller_| lives and dies there.
+  scoped_refptr<base::SequencedTaskRunner> distill_task_runner_;
+  std::unique_ptr<Distiller, base::OnTaskRunnerDeleter> distiller_;
+  // Set while a chunk is being distilled, reading is paused meanwhile.
+  bool distilling_ = false;
+  // Set once the untouched body is being sent instead of a distilled one.
+  bool fallback_ = false;
+  // Set once the source body has been read to the end.
+  bool body_read_ = false;
+  // Set once the rewriter has flushed all of its output.
+  bool distill_ended_ = false;
+
+  // The untouched body, only kept until the rewriter commits to an output.
+  std::string original_body_;
+  // Output that did not fit into the data pipe yet.
+  std::string pending_output_;
+  size_t pending_output_offset_ = 0;
+  size_t peak_buffered_bytes_ = 0;
+  base::TimeTicks body_start_time_;
 
   mojo::ScopedDataPipeConsumerHandle body_consumer_handle_;
   mojo::ScopedDataPipeProducerHandle body_producer_handle_;
@@ -0,0 +1,375 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/speedreader/speedreader_url_loader.h"
+
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/logging.h"
+#include "base/run_loop.h"
+#include "base/strings/string_util.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/test/task_environment.h"
+#include "base/threading/thread_restrictions.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "brave/components/speedreader/speedreader_throttle.h"
+#include "mojo/public/cpp/bindings/pending_receiver.h"
+#include "mojo/public/cpp/bindings/pending_remote.h"
+#include "mojo/public/cpp/bindings/remote.h"
+#include "mojo/public/cpp/system/data_pipe.h"
+#include "net/base/net_errors.h"
+#include "services/network/public/cpp/url_loader_completion_status.h"
+#include "services/network/public/mojom/url_loader.mojom.h"
+#include "services/network/public/mojom/url_response_head.mojom.h"
+#include "services/network/test/test_url_loader_client.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/blink/public/common/loader/url_loader_throttle.h"
+#include "url/gurl.h"
+
+namespace speedreader {
+
+namespace {
+
+// Matches the read size and send pipe capacity of SpeedReaderURLLoader.
+constexpr size_t kReadBufferSize = 32768;
+constexpr size_t kSendPipeCapacity = 4 * kReadBufferSize;
+
+constexpr char kDistilledPageStylePrefix[] =
+    "<style id=\"brave_speedreader_style\">";
+
+// Shared by the test and the distillers it makes, which run on a worker.
+struct FakeDistillerState {
+  // Write() fails from this chunk on, counting from 0.
+  size_t fail_write_at_chunk = std::numeric_limits<size_t>::max();
+  bool fail_end = false;
+  // Write() produces no output, End() flushes all of it.
+  bool hold_output = false;
+  // If set, Write() waits for this before doing anything.
+  base::WaitableEvent* write_blocker = nullptr;
+
+  std::atomic<size_t> written_chunks{0};
+  std::atomic<size_t> written_bytes{0};
+};
+
+// Distills a page by upper casing it.
+class FakeDistiller : public SpeedReaderURLLoader::Distiller {
+ public:
+  explicit FakeDistiller(FakeDistillerState* state) : state_(state) {}
+  ~FakeDistiller() override = default;
+
+  FakeDistiller(const FakeDistiller&) = delete;
+  FakeDistiller& operator=(const FakeDistiller&) = delete;
+
+  bool Write(const std::string& chunk, std::string* output) override {
+    if (state_->write_blocker) {
+      base::ScopedAllowBaseSyncPrimitivesForTesting allow_wait;
+      state_->write_blocker->Wait();
+    }
+    const size_t chunk_index = state_->written_chunks++;
+    state_->written_bytes += chunk.size();
+    if (chunk_index >= state_->fail_write_at_chunk)
+      return false;
+
+    const std::string distilled = base::ToUpperASCII(chunk);
+    if (state_->hold_output)
+      held_output_.append(distilled);
+    else
+      output->append(distilled);
+    return true;
+  }
+
+  bool End(std::string* output) override {
+    if (state_->fail_end)
+      return false;
+    output->append(held_output_);
+    return true;
+  }
+
+ private:
+  FakeDistillerState* state_;
+  std::string held_output_;
+};
+
+// Stands in for the URLLoaderThrottle machinery that owns the loaders.
+// Cargoculted from MimeSniffingThrottle tests.
+class MockDelegate : public blink::URLLoaderThrottle::Delegate {
+ public:
+  // blink::URLLoaderThrottle::Delegate:
+  void CancelWithError(int error_code,
+                       base::StringPiece custom_reason) override {
+    NOTIMPLEMENTED();
+  }
+
+  void Resume() override { is_resumed_ = true; }
+
+  void InterceptResponse(
+      mojo::PendingRemote<network::mojom::URLLoader> new_loader,
+      mojo::PendingReceiver<network::mojom::URLLoaderClient>
+          new_client_receiver,
+      mojo::PendingRemote<network::mojom::URLLoader>* original_loader,
+      mojo::PendingReceiver<network::mojom::URLLoaderClient>*
+          original_client_receiver) override {
+    is_intercepted_ = true;
+
+    destination_loader_remote_.Bind(std::move(new_loader));
+    ASSERT_TRUE(mojo::FusePipes(std::move(new_client_receiver),
+                                destination_loader_client_.CreateRemote()));
+    source_loader_receiver_ = original_loader->InitWithNewPipeAndPassReceiver();
+    *original_client_receiver =
+        source_loader_client_remote_.BindNewPipeAndPassReceiver();
+  }
+
+  // Sends all of |body| and closes the pipe it is sent through.
+  void LoadResponseBody(const std::string& body) {
+    MojoCreateDataPipeOptions options;
+    options.struct_size = sizeof(MojoCreateDataPipeOptions);
+    options.flags = MOJO_CREATE_DATA_PIPE_FLAG_NONE;
+    options.element_num_bytes = 1;
+    options.capacity_num_bytes = static_cast<uint32_t>(body.size());
+    mojo::ScopedDataPipeProducerHandle producer;
+    mojo::ScopedDataPipeConsumerHandle consumer;
+    ASSERT_EQ(MOJO_RESULT_OK,
+              mojo::CreateDataPipe(&options, &producer, &consumer));
+
+    source_loader_client_remote_->OnStartLoadingResponseBody(
+        std::move(consumer));
+
+    uint32_t num_bytes = static_cast<uint32_t>(body.size());
+    ASSERT_EQ(MOJO_RESULT_OK,
+              producer->WriteData(body.data(), &num_bytes,
+                                  MOJO_WRITE_DATA_FLAG_ALL_OR_NONE));
+    ASSERT_EQ(body.size(), num_bytes);
+  }
+
+  void CompleteResponse() {
+    source_loader_client_remote_->OnComplete(
+        network::URLLoaderCompletionStatus(net::OK));
+  }
+
+  // Appends what can be read from the destination body pipe right now.
+  void ReadAvailableResponseBody(std::string* body) {
+    mojo::DataPipeConsumerHandle consumer =
+        destination_loader_client_.response_body();
+    if (!consumer.is_valid())
+      return;
+    while (true) {
+      const void* buffer = nullptr;
+      uint32_t num_bytes = 0;
+      if (consumer.BeginReadData(&buffer, &num_bytes,
+                                 MOJO_READ_DATA_FLAG_NONE) != MOJO_RESULT_OK) {
+        return;
+      }
+      body->append(static_cast<const char*>(buffer), num_bytes);
+      consumer.EndReadData(num_bytes);
+    }
+  }
+
+  void ResetDestination() { destination_loader_remote_.reset(); }
+
+  bool is_intercepted() const { return is_intercepted_; }
+  bool is_resumed() const { return is_resumed_; }
+  network::TestURLLoaderClient* destination_loader_client() {
+    return &destination_loader_client_;
+  }
+
+ private:
+  bool is_intercepted_ = false;
+  bool is_resumed_ = false;
+
+  // A pair of a loader and a loader client for the destination of the
+  // response.
+  mojo::Remote<network::mojom::URLLoader> destination_loader_remote_;
+  network::TestURLLoaderClient destination_loader_client_;
+
+  // A pair of a loader and a loader client for the source of the response.
+  mojo::PendingReceiver<network::mojom::URLLoader> source_loader_receiver_;
+  mojo::Remote<network::mojom::URLLoaderClient> source_loader_client_remote_;
+};
+
+}  // namespace
+
+class SpeedReaderURLLoaderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    SpeedReaderURLLoader::SetDistillerFactoryForTesting(base::BindRepeating(
+        [](FakeDistillerState* state, const GURL& url)
+            -> std::unique_ptr<SpeedReaderURLLoader::Distiller> {
+          return std::make_unique<FakeDistiller>(state);
+        },
+        &distiller_state_));
+  }
+
+  void TearDown() override {
+    SpeedReaderURLLoader::SetDistillerFactoryForTesting(
+        SpeedReaderURLLoader::DistillerFactory());
+  }
+
+  // Makes the throttle create a loader for a page, which is intercepted by
+  // |delegate_|.
+  void StartLoader() {
+    throttle_ = std::make_unique<SpeedReaderThrottle>(
+        nullptr, base::ThreadTaskRunnerHandle::Get());
+    throttle_->set_delegate(&delegate_);
+
+    auto response_head = network::mojom::URLResponseHead::New();
+    bool defer = false;
+    throttle_->WillProcessResponse(GURL("https://example.com/article.html"),
+                                   response_head.get(), &defer);
+    EXPECT_TRUE(defer);
+    EXPECT_TRUE(delegate_.is_intercepted());
+  }
+
+  // Reads the destination body until nothing more arrives.
+  std::string ReadResponseBody() {
+    std::string body;
+    while (true) {
+      task_environment_.RunUntilIdle();
+      const size_t previous_size = body.size();
+      delegate_.ReadAvailableResponseBody(&body);
+      if (body.size() == previous_size)
+        return body;
+    }
+  }
+
+  // A body in lower case, so that distilled output can be told apart from
+  // it.
+  static std::string MakeBody(size_t size) {
+    std::string body;
+    while (body.size() < size)
+      body += "some article text ";
+    body.resize(size);
+    return body;
+  }
+
+  base::test::TaskEnvironment task_environment_;
+  FakeDistillerState distiller_state_;
+  MockDelegate delegate_;
+  std::unique_ptr<SpeedReaderThrottle> throttle_;
+};
+
+TEST_F(SpeedReaderURLLoaderTest, StreamsBodyInChunks) {
+  const std::string body = MakeBody(5 * kReadBufferSize + 100);
+  StartLoader();
+
+  delegate_.LoadResponseBody(body);
+  delegate_.CompleteResponse();
+  const std::string response_body = ReadResponseBody();
+
+  EXPECT_TRUE(delegate_.is_resumed());
+  EXPECT_LT(1UL, distiller_state_.written_chunks.load());
+  EXPECT_EQ(body.size(), distiller_state_.written_bytes.load());
+  EXPECT_TRUE(base::StartsWith(response_body, kDistilledPageStylePrefix,
+                               base::CompareCase::SENSITIVE));
+  EXPECT_TRUE(base::EndsWith(response_body, base::ToUpperASCII(body),
+                             base::CompareCase::SENSITIVE));
+  EXPECT_TRUE(delegate_.destination_loader_client()->has_received_completion());
+  EXPECT_EQ(net::OK,
+            delegate_.destination_loader_client()->completion_status()
+                .error_code);
+}
+
+TEST_F(SpeedReaderURLLoaderTest, StopsReadingWhileSendPipeIsFull) {
+  const std::string body = MakeBody(32 * kReadBufferSize);
+  StartLoader();
+
+  delegate_.LoadResponseBody(body);
+  delegate_.CompleteResponse();
+  task_environment_.RunUntilIdle();
+
+  // Nothing has been read from the destination yet, so reading stops once
+  // the pipe is full and one more chunk is waiting for room.
+  EXPECT_TRUE(delegate_.is_resumed());
+  EXPECT_GT(body.size(), distiller_state_.written_bytes.load());
+  EXPECT_GE(kSendPipeCapacity + 2 * kReadBufferSize,
+            distiller_state_.written_bytes.load());
+  EXPECT_FALSE(
+      delegate_.destination_loader_client()->has_received_completion());
+
+  const std::string response_body = ReadResponseBody();
+
+  EXPECT_EQ(body.size(), distiller_state_.written_bytes.load());
+  EXPECT_TRUE(base::EndsWith(response_body, base::ToUpperASCII(body),
+                             base::CompareCase::SENSITIVE));
+  EXPECT_TRUE(delegate_.destination_loader_client()->has_received_completion());
+}
+
+TEST_F(SpeedReaderURLLoaderTest, SendsOriginalBodyWhenWriteFailsFirst) {
+  distiller_state_.fail_write_at_chunk = 0;
+  const std::string body = MakeBody(3 * kReadBufferSize);
+  StartLoader();
+
+  delegate_.LoadResponseBody(body);
+  delegate_.CompleteResponse();
+  const std::string response_body = ReadResponseBody();
+
+  EXPECT_TRUE(delegate_.is_resumed());
+  EXPECT_EQ(body, response_body);
+  EXPECT_TRUE(delegate_.destination_loader_client()->has_received_completion());
+}
+
+TEST_F(SpeedReaderURLLoaderTest, SendsOriginalBodyWhenEndFailsFirst) {
+  distiller_state_.hold_output = true;
+  distiller_state_.fail_end = true;
+  const std::string body = MakeBody(3 * kReadBufferSize);
+  StartLoader();
+
+  delegate_.LoadResponseBody(body);
+  delegate_.CompleteResponse();
+  const std::string response_body = ReadResponseBody();
+
+  EXPECT_TRUE(delegate_.is_resumed());
+  EXPECT_EQ(body, response_body);
+  EXPECT_TRUE(delegate_.destination_loader_client()->has_received_completion());
+}
+
+TEST_F(SpeedReaderURLLoaderTest, AbortsWhenWriteFailsAfterOutput) {
+  distiller_state_.fail_write_at_chunk = 2;
+  const std::string body = MakeBody(5 * kReadBufferSize);
+  StartLoader();
+
+  delegate_.LoadResponseBody(body);
+  delegate_.CompleteResponse();
+  const std::string response_body = ReadResponseBody();
+
+  // Part of the distilled page was sent before distilling failed.
+  EXPECT_TRUE(delegate_.is_resumed());
+  EXPECT_TRUE(base::StartsWith(response_body, kDistilledPageStylePrefix,
+                               base::CompareCase::SENSITIVE));
+  EXPECT_TRUE(base::EndsWith(response_body,
+                             base::ToUpperASCII(body.substr(
+                                 0, 2 * kReadBufferSize)),
+                             base::CompareCase::SENSITIVE));
+  EXPECT_FALSE(
+      delegate_.destination_loader_client()->has_received_completion());
+  EXPECT_TRUE(
+      delegate_.destination_loader_client()->has_received_connection_error());
+}
+
+TEST_F(SpeedReaderURLLoaderTest, DestinationDisconnectsWhileDistilling) {
+  base::WaitableEvent write_blocker;
+  distiller_state_.write_blocker = &write_blocker;
+  const std::string body = MakeBody(3 * kReadBufferSize);
+  StartLoader();
+
+  // Only runs this thread, the first chunk stays in the distiller.
+  delegate_.LoadResponseBody(body);
+  base::RunLoop().RunUntilIdle();
+
+  delegate_.ResetDestination();
+  base::RunLoop().RunUntilIdle();
+
+  write_blocker.Signal();
+  task_environment_.RunUntilIdle();
+
+  EXPECT_FALSE(delegate_.is_resumed());
+  EXPECT_EQ(1UL, distiller_state_.written_chunks.load());
+}
+
+}  // namespace speedreader
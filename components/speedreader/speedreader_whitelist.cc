@@ -12,6 +12,7 @@
 #include "base/files/file_path.h"
 #include "base/task/post_task.h"
 #include "brave/components/speedreader/rust/ffi/speedreader.h"
+#include "brave/components/speedreader/speedreader_host_index.h"
 #include "brave/components/speedreader/speedreader_switches.h"
 #include "url/gurl.h"
 
@@ -50,10 +51,8 @@ SpeedreaderWhitelist::SpeedreaderWhitelist(Delegate* delegate)
 
     base::PostTaskAndReplyWithResult(
         FROM_HERE, {base::ThreadPool(), base::MayBlock()},
-        base::BindOnce(
-            &brave_component_updater::LoadDATFileData<speedreader::SpeedReader>,
-            whitelist_path),
-        base::BindOnce(&SpeedreaderWhitelist::OnGetDATFileData,
+        base::BindOnce(&SpeedreaderWhitelist::LoadWhitelist, whitelist_path),
+        base::BindOnce(&SpeedreaderWhitelist::OnLoadWhitelist,
                        weak_factory_.GetWeakPtr()));
   }
 }
@@ -65,14 +64,17 @@ void SpeedreaderWhitelist::OnComponentReady(const std::string& component_id,
                                             const std::string& manifest) {
   base::PostTaskAndReplyWithResult(
       FROM_HERE, {base::ThreadPool(), base::MayBlock()},
-      base::BindOnce(
-          &brave_component_updater::LoadDATFileData<speedreader::SpeedReader>,
-          install_dir.Append(kDatFileVersion).Append(kDatFileName)),
-      base::BindOnce(&SpeedreaderWhitelist::OnGetDATFileData,
+      base::BindOnce(&SpeedreaderWhitelist::LoadWhitelist,
+                     install_dir.Append(kDatFileVersion).Append(kDatFileName)),
+      base::BindOnce(&SpeedreaderWhitelist::OnLoadWhitelist,
                      weak_factory_.GetWeakPtr()));
 }
 
 bool SpeedreaderWhitelist::IsWhitelisted(const GURL& url) {
+  // Most navigations are to hosts no rule is anchored to, turn those down
+  // without calling into the FFI.
+  if (host_index_ && !host_index_->MayMatch(url))
+    return false;
   return speedreader_->IsReadableURL(url.spec());
 }
 
@@ -80,8 +82,35 @@ std::unique_ptr<Rewriter> SpeedreaderWhitelist::MakeRewriter(const GURL& url) {
   return speedreader_->MakeRewriter(url.spec());
 }
 
-void SpeedreaderWhitelist::OnGetDATFileData(GetDATFileDataResult result) {
+std::unique_ptr<Rewriter> SpeedreaderWhitelist::MakeRewriter(
+    const GURL& url,
+    void (*output_sink)(const char*, size_t, void*),
+    void* output_sink_user_data) {
+  return speedreader_->MakeRewriter(url.spec(), RewriterType::RewriterUnknown,
+                                    output_sink, output_sink_user_data);
+}
+
+// static
+SpeedreaderWhitelist::LoadWhitelistResult SpeedreaderWhitelist::LoadWhitelist(
+    const base::FilePath& path) {
+  auto dat_file_data =
+      brave_component_updater::LoadDATFileData<speedreader::SpeedReader>(path);
+  std::unique_ptr<SpeedreaderHostIndex> host_index;
+  if (dat_file_data.first) {
+    const brave_component_updater::DATFileDataBuffer& buffer =
+        dat_file_data.second;
+    host_index = SpeedreaderHostIndex::Create(base::StringPiece(
+        reinterpret_cast<const char*>(buffer.data()), buffer.size()));
+    if (!host_index)
+      VLOG(2) << "Speedreader whitelist can't be indexed by host";
+  }
+  return LoadWhitelistResult(std::move(dat_file_data.first),
+                             std::move(host_index));
+}
+
+void SpeedreaderWhitelist::OnLoadWhitelist(LoadWhitelistResult result) {
   speedreader_ = std::move(result.first);
+  host_index_ = std::move(result.second);
 }
 
 }  // namespace speedreader
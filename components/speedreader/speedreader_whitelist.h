@@ -8,6 +8,7 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "base/memory/weak_ptr.h"
 #include "brave/components/brave_component_updater/browser/brave_component.h"
@@ -15,6 +16,7 @@
 
 namespace speedreader {
 class SpeedReader;
+class SpeedreaderHostIndex;
 class Rewriter;
 }  // namespace speedreader
 
@@ -32,6 +34,12 @@ class SpeedreaderWhitelist : public brave_component_updater::BraveComponent {
 
   bool IsWhitelisted(const GURL& url);
   std::unique_ptr<Rewriter> MakeRewriter(const GURL& url);
+  // Makes a streaming rewriter that hands every chunk of output to
+  // |output_sink| as soon as it is available.
+  std::unique_ptr<Rewriter> MakeRewriter(
+      const GURL& url,
+      void (*output_sink)(const char*, size_t, void*),
+      void* output_sink_user_data);
 
  private:
   // brave_component_updater::BraveComponent:
@@ -39,12 +47,16 @@ class SpeedreaderWhitelist : public brave_component_updater::BraveComponent {
                         const base::FilePath& install_dir,
                         const std::string& manifest) override;
 
-  using GetDATFileDataResult =
-      brave_component_updater::LoadDATFileDataResult<speedreader::SpeedReader>;
+  using LoadWhitelistResult =
+      std::pair<std::unique_ptr<speedreader::SpeedReader>,
+                std::unique_ptr<speedreader::SpeedreaderHostIndex>>;
 
-  void OnGetDATFileData(GetDATFileDataResult result);
+  static LoadWhitelistResult LoadWhitelist(const base::FilePath& path);
+  void OnLoadWhitelist(LoadWhitelistResult result);
 
   std::unique_ptr<speedreader::SpeedReader> speedreader_;
+  // Not set until a whitelist is loaded, or if it can't be indexed.
+  std::unique_ptr<speedreader::SpeedreaderHostIndex> host_index_;
   base::WeakPtrFactory<SpeedreaderWhitelist> weak_factory_{this};
 };
 